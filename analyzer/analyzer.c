@@ -109,6 +109,15 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_params)
   SUSCAN_PACK(float, self->psd_update_int);
   SUSCAN_PACK(freq,  self->min_freq);
   SUSCAN_PACK(freq,  self->max_freq);
+  SUSCAN_PACK(uint,  self->panorama_bins);
+  SUSCAN_PACK(freq,  self->psd_span_min);
+  SUSCAN_PACK(freq,  self->psd_span_max);
+  SUSCAN_PACK(int,   self->psd_aggregation);
+  SUSCAN_PACK(uint,  self->psd_averaging);
+  SUSCAN_PACK(float, self->stats_interval);
+  SUSCAN_PACK(float, self->stats_threshold);
+  SUSCAN_PACK(float, self->stats_percentile);
+  SUSCAN_PACK(float, self->corr_update_rate);
 
   SUSCAN_PACK_BOILERPLATE_END;
 }
@@ -134,6 +143,18 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_params)
   SUSCAN_UNPACK(float,  self->psd_update_int);
   SUSCAN_UNPACK(freq,   self->min_freq);
   SUSCAN_UNPACK(freq,   self->max_freq);
+  SUSCAN_UNPACK(uint64, self->panorama_bins);
+  SUSCAN_UNPACK(freq,   self->psd_span_min);
+  SUSCAN_UNPACK(freq,   self->psd_span_max);
+
+  SUSCAN_UNPACK(int32,  int32);
+  self->psd_aggregation = int32;
+
+  SUSCAN_UNPACK(uint64, self->psd_averaging);
+  SUSCAN_UNPACK(float,  self->stats_interval);
+  SUSCAN_UNPACK(float,  self->stats_threshold);
+  SUSCAN_UNPACK(float,  self->stats_percentile);
+  SUSCAN_UNPACK(float,  self->corr_update_rate);
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
@@ -508,6 +529,27 @@ suscan_analyzer_register_baseband_filter(
     SUSCAN_ANALYZER_BBFILT_PRIO_DEFAULT);
 }
 
+SUBOOL
+suscan_analyzer_register_async_baseband_filter(
+    suscan_analyzer_t *self,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata,
+    unsigned int max_lag)
+{
+  if (self->iface->register_async_baseband_filter == NULL) {
+    SU_ERROR("This type of analyzer object does not support asynchronous baseband filtering\n");
+    return SU_FALSE;
+  }
+
+  CHECK_PERMISSION(self, SUSCAN_ANALYZER_PERM_SET_BB_FILTER);
+
+  return (self->iface->register_async_baseband_filter) (
+    self->impl,
+    func,
+    privdata,
+    max_lag);
+}
+
 /* Worker-specific methods */
 SUBOOL
 suscan_analyzer_set_sweep_stratrgy(
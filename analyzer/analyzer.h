@@ -48,6 +48,10 @@ extern "C" {
 /* Default priorities */
 #define SUSCAN_ANALYZER_BBFILT_PRIO_DEFAULT   0x7fffffffffffffffll
 
+/* Asynchronous baseband filters */
+#define SUSCAN_ANALYZER_ASYNC_BBFILT_DEFAULT_MAX_LAG 4
+#define SUSCAN_ANALYZER_ASYNC_BBFILT_DROP_REPORT     1000
+
 /* Entirely empirical */
 #define SUSCAN_ANALYZER_SLOW_RATE             44100
 #define SUSCAN_ANALYZER_SLOW_READ_SIZE        32
@@ -69,6 +73,19 @@ enum suscan_analyzer_mode {
   SUSCAN_ANALYZER_MODE_WIDE_SPECTRUM
 };
 
+/*!
+ * \brief PSD bin aggregation
+ *
+ * Describes how the bins of a fine PSD are merged to derive a coarser one:
+ * either by averaging them (suitable for noise floor estimation) or by
+ * keeping the strongest one (so that narrowband signals are not diluted).
+ * \author Gonzalo José Carracedo Carballal
+ */
+enum suscan_analyzer_psd_aggregation {
+  SUSCAN_ANALYZER_PSD_AGGREGATION_MEAN,
+  SUSCAN_ANALYZER_PSD_AGGREGATION_MAX
+};
+
 /*!
  * \brief Analyzer parameters
  *
@@ -80,8 +97,17 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_params) {
   struct sigutils_channel_detector_params detector_params; /*!< Channel detector parameters */
   SUFLOAT  channel_update_int; /*!< Channel info update interval (seconds) */
   SUFLOAT  psd_update_int;     /*!< Spectrum update interval (seconds) */
+  SUSCOUNT psd_averaging;      /*!< FFTs averaged per spectrum update (0: all of them) */
   SUFREQ   min_freq; /*!< Minimum sweep frequency (only in wide spectrum mode) */
   SUFREQ   max_freq; /*!< Maximum sweep frequency (only in wide spectrum mode) */
+  SUSCOUNT panorama_bins; /*!< Stitched sweep resolution (wide spectrum mode, 0: per-hop PSDs) */
+  SUFREQ   psd_span_min; /*!< Lower edge of the PSD view, relative to fc (remote analyzers only) */
+  SUFREQ   psd_span_max; /*!< Upper edge of the PSD view, relative to fc (whole band if not above psd_span_min) */
+  enum suscan_analyzer_psd_aggregation psd_aggregation; /*!< How coarser PSD views are derived */
+  SUFLOAT  stats_interval;   /*!< Spectral statistics report interval (seconds, 0: disabled) */
+  SUFLOAT  stats_threshold;  /*!< Spectral occupancy threshold (dB) */
+  SUFLOAT  stats_percentile; /*!< Percentile tracked by the spectral statistics (0 to 1) */
+  SUFLOAT  corr_update_rate; /*!< Frequency correction model updates per second (0: default) */
 };
 
 #define suscan_analyzer_params_INITIALIZER {                               \
@@ -89,8 +115,17 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_params) {
   sigutils_channel_detector_params_INITIALIZER, /* detector_params */       \
   SU_ADDSFX(0.1),                               /* channel_update_int */    \
   SU_ADDSFX(0.04),                              /* psd_update_int */        \
+  8,                                            /* psd_averaging */         \
   0,                                            /* min_freq */              \
   0,                                            /* max_freq */              \
+  0,                                            /* panorama_bins */         \
+  0,                                            /* psd_span_min */          \
+  0,                                            /* psd_span_max */          \
+  SUSCAN_ANALYZER_PSD_AGGREGATION_MEAN,         /* psd_aggregation */       \
+  0,                                            /* stats_interval */        \
+  SU_ADDSFX(-60.),                              /* stats_threshold */       \
+  SU_ADDSFX(0.9),                               /* stats_percentile */      \
+  SU_ADDSFX(10.),                               /* corr_update_rate */      \
 }
 
 /*!
@@ -196,6 +231,11 @@ struct suscan_analyzer_interface {
     suscan_analyzer_baseband_filter_func_t func,
     void *privdata,
     int64_t priority);
+  SUBOOL   (*register_async_baseband_filter) (
+    void *,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata,
+    unsigned int max_lag);
   
   struct suscan_source_info *(*get_source_info_pointer) (const void *);
   SUBOOL   (*commit_source_info) (void *);
@@ -746,6 +786,32 @@ SUBOOL suscan_analyzer_register_baseband_filter_with_prio(
     void *privdata,
     int64_t prio);
 
+/*!
+ * Registers an asynchronous baseband filter given by a processing function
+ * and a pointer to private data. Unlike regular baseband filters, 
+ * asynchronous filters are not run by the source thread: each of them
+ * receives a reference to a copy of the samples through a dedicated queue
+ * of max_lag buffers and a worker thread. If the filter falls behind more
+ * than max_lag buffers, new buffers are dropped (and accounted) instead of
+ * stalling acquisition. Dropped buffers can be detected by the filter as
+ * gaps in the consumed parameter.
+ * 
+ * Asynchronous filters must treat the samples as read-only, as they are
+ * shared with other filters. Their return value is only used to disable the
+ * filter in case of failure.
+ * \param analyzer pointer to the analyzer object
+ * \param func pointer to the baseband filter function
+ * \param privdata pointer to its private data
+ * \param max_lag maximum number of queued buffers, or 0 for the default
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_register_async_baseband_filter(
+    suscan_analyzer_t *analyzer,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata,
+    unsigned int max_lag);
+
 
 /************************ Client interface methods ****************************/
 /*
@@ -1022,6 +1088,39 @@ SUBOOL suscan_analyzer_set_inspector_watermark_async(
     SUSCOUNT watermark,
     uint32_t req_id);
 
+/*!
+ * For channel analyzers, set how often the parameter estimators of an
+ * inspector are run, and on how many samples (asynchronous).
+ * \param analyzer pointer to the analyzer object
+ * \param handle inspector handle
+ * \param interval seconds between estimations, or 0 to run estimators
+ *        only on request
+ * \param window samples per estimation, or 0 for the default
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_set_inspector_estimator_schedule_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    SUFLOAT  interval,
+    SUSCOUNT window,
+    uint32_t req_id);
+
+/*!
+ * For channel analyzers, run the parameter estimators of an inspector on
+ * the next window of samples, regardless of their schedule (asynchronous).
+ * \param analyzer pointer to the analyzer object
+ * \param handle inspector handle
+ * \param req_id arbitrary request identifier used to match responses
+ * \return SU_TRUE for success or SU_FALSE on failure
+ * \author Gonzalo José Carracedo Carballal
+ */
+SUBOOL suscan_analyzer_request_inspector_estimates_async(
+    suscan_analyzer_t *analyzer,
+    SUHANDLE handle,
+    uint32_t req_id);
+
 /*!
  * For channel analyzer, enable or disable a channel parameter estimator
  * associated to an inspector (asynchronous).
@@ -22,6 +22,7 @@
 #define SU_LOG_DOMAIN "estimator"
 
 #include "estimator.h"
+#include "src/fftplan.h"
 
 PTR_LIST_CONST(struct suscan_estimator_class, estimator_class);
 SUPRIVATE SUBOOL estimators_init = SU_FALSE;
@@ -44,10 +45,19 @@ suscan_estimator_class_register(const struct suscan_estimator_class *class)
   SU_TRYCATCH(class->name  != NULL, return SU_FALSE);
   SU_TRYCATCH(class->desc  != NULL, return SU_FALSE);
   SU_TRYCATCH(class->field != NULL, return SU_FALSE);
-  SU_TRYCATCH(class->ctor  != NULL, return SU_FALSE);
-  SU_TRYCATCH(class->dtor  != NULL, return SU_FALSE);
   SU_TRYCATCH(class->read  != NULL, return SU_FALSE);
-  SU_TRYCATCH(class->feed  != NULL, return SU_FALSE);
+
+  if (class->view_of != NULL) {
+    SU_TRYCATCH(
+        suscan_estimator_class_lookup(class->view_of) != NULL,
+        return SU_FALSE);
+  } else {
+    SU_TRYCATCH(class->ctor  != NULL, return SU_FALSE);
+    SU_TRYCATCH(class->dtor  != NULL, return SU_FALSE);
+    SU_TRYCATCH(
+        class->feed != NULL || class->feed_spectrum != NULL,
+        return SU_FALSE);
+  }
 
   SU_TRYCATCH(
       suscan_estimator_class_lookup(class->name) == NULL,
@@ -65,6 +75,7 @@ suscan_estimator_new(const struct suscan_estimator_class *class, SUSCOUNT fs)
 {
   suscan_estimator_t *new = NULL;
 
+  SU_TRYCATCH(class->view_of == NULL, goto fail);
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_estimator_t)), goto fail);
 
   new->classptr = class;
@@ -80,6 +91,25 @@ fail:
   return NULL;
 }
 
+suscan_estimator_t *
+suscan_estimator_new_view(
+    const struct suscan_estimator_class *class,
+    suscan_estimator_t *owner)
+{
+  suscan_estimator_t *new = NULL;
+
+  SU_TRYCATCH(class->view_of != NULL, return NULL);
+  SU_TRYCATCH(strcmp(class->view_of, owner->classptr->name) == 0, return NULL);
+
+  SU_TRYCATCH(new = calloc(1, sizeof(suscan_estimator_t)), return NULL);
+
+  new->classptr = class;
+  new->owner    = owner;
+  new->privdata = owner->privdata;
+
+  return new;
+}
+
 SUBOOL
 suscan_estimator_feed(
     suscan_estimator_t *estimator,
@@ -89,21 +119,221 @@ suscan_estimator_feed(
   return (estimator->classptr->feed) (estimator->privdata, samples, size);
 }
 
+/*
+ * Feeds samples to all time-domain estimators that are enabled, or that
+ * have an enabled view. Each of them is fed exactly once.
+ */
+SUBOOL
+suscan_estimator_feed_list(
+    suscan_estimator_t **estimator_list,
+    unsigned int estimator_count,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size)
+{
+  suscan_estimator_t *source;
+  unsigned int i;
+
+  for (i = 0; i < estimator_count; ++i)
+    estimator_list[i]->fed = SU_FALSE;
+
+  for (i = 0; i < estimator_count; ++i) {
+    if (!suscan_estimator_is_enabled(estimator_list[i])
+        || suscan_estimator_is_spectral(estimator_list[i]))
+      continue;
+
+    source = suscan_estimator_get_source(estimator_list[i]);
+    if (!source->fed) {
+      SU_TRYCATCH(suscan_estimator_feed(source, samples, size), return SU_FALSE);
+      source->fed = SU_TRUE;
+    }
+  }
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_estimator_feed_spectrum(
+    suscan_estimator_t *estimator,
+    const SUCOMPLEX *spectrum,
+    SUSCOUNT size)
+{
+  return (estimator->classptr->feed_spectrum) (
+      estimator->privdata,
+      spectrum,
+      size);
+}
+
 SUBOOL
 suscan_estimator_read(const suscan_estimator_t *estimator, SUFLOAT *out)
 {
   return (estimator->classptr->read) (estimator->privdata, out);
 }
 
+/*
+ * Reads the estimator and caches the result along with the current
+ * time. Returns SU_FALSE (keeping the previous estimate) if the
+ * estimator has nothing new to say.
+ */
+SUBOOL
+suscan_estimator_update(suscan_estimator_t *estimator)
+{
+  SUFLOAT value;
+
+  if (!suscan_estimator_read(estimator, &value))
+    return SU_FALSE;
+
+  estimator->value = value;
+  estimator->valid = SU_TRUE;
+  gettimeofday(&estimator->timestamp, NULL);
+
+  return SU_TRUE;
+}
+
 void
 suscan_estimator_destroy(suscan_estimator_t *estimator)
 {
-  if (estimator != NULL)
+  if (estimator != NULL && estimator->owner == NULL)
     (estimator->classptr->dtor) (estimator->privdata);
 
   free(estimator);
 }
 
+/*********************** Shared estimator front end **************************/
+suscan_estimator_frontend_t *
+suscan_estimator_frontend_new(SUSCOUNT block_size)
+{
+  suscan_estimator_frontend_t *new = NULL;
+  SUBOOL locked = SU_FALSE;
+
+  SU_TRYCATCH(block_size > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_estimator_frontend_t);
+
+  new->block_size = block_size;
+
+  SU_ALLOCATE_MANY_FAIL(new->block, block_size, SUCOMPLEX);
+  SU_TRYCATCH(
+      new->spectrum = SU_FFTW(_malloc)(block_size * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      new->plan = SU_FFTW(_plan_dft_1d)(
+          block_size,
+          (SU_FFTW(_complex) *) new->spectrum,
+          (SU_FFTW(_complex) *) new->spectrum,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  return new;
+
+fail:
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_estimator_frontend_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE SUBOOL
+suscan_estimator_frontend_process_block(
+    suscan_estimator_frontend_t *self,
+    suscan_estimator_t **estimator_list,
+    unsigned int estimator_count)
+{
+  suscan_estimator_t *source;
+  SUSCOUNT size = self->block_size;
+  SUBOOL computed = SU_FALSE;
+  unsigned int i;
+
+  for (i = 0; i < estimator_count; ++i)
+    estimator_list[i]->fed = SU_FALSE;
+
+  for (i = 0; i < estimator_count; ++i) {
+    if (!suscan_estimator_is_enabled(estimator_list[i])
+        || !suscan_estimator_is_spectral(estimator_list[i]))
+      continue;
+
+    source = suscan_estimator_get_source(estimator_list[i]);
+    if (source->fed)
+      continue;
+
+    /* Computed only once, and only if someone needs it */
+    if (!computed) {
+      memcpy(self->spectrum, self->block, size * sizeof(SUCOMPLEX));
+
+      SU_FFTW(_execute)(self->plan);
+      computed = SU_TRUE;
+    }
+
+    SU_TRYCATCH(
+        suscan_estimator_feed_spectrum(source, self->spectrum, size),
+        return SU_FALSE);
+    source->fed = SU_TRUE;
+  }
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_estimator_frontend_feed(
+    suscan_estimator_frontend_t *self,
+    suscan_estimator_t **estimator_list,
+    unsigned int estimator_count,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size)
+{
+  SUSCOUNT chunk;
+
+  while (size > 0) {
+    chunk = SU_MIN(size, self->block_size - self->fill);
+
+    memcpy(self->block + self->fill, samples, chunk * sizeof(SUCOMPLEX));
+    self->fill += chunk;
+
+    if (self->fill == self->block_size) {
+      SU_TRYCATCH(
+          suscan_estimator_frontend_process_block(
+              self,
+              estimator_list,
+              estimator_count),
+          return SU_FALSE);
+      self->fill = 0;
+    }
+
+    samples += chunk;
+    size    -= chunk;
+  }
+
+  return SU_TRUE;
+}
+
+void
+suscan_estimator_frontend_destroy(suscan_estimator_frontend_t *self)
+{
+  if (self->plan != NULL) {
+    (void) suscan_fft_planner_lock();
+    SU_FFTW(_destroy_plan)(self->plan);
+    suscan_fft_planner_unlock();
+  }
+
+  if (self->spectrum != NULL)
+    SU_FFTW(_free)(self->spectrum);
+
+  if (self->block != NULL)
+    free(self->block);
+
+  free(self);
+}
+
 SUBOOL
 suscan_estimators_initialized(void)
 {
@@ -115,6 +345,7 @@ suscan_init_estimators(void)
 {
   SU_TRYCATCH(suscan_estimator_fac_register(), return SU_FALSE);
   SU_TRYCATCH(suscan_estimator_nonlinear_register(), return SU_FALSE);
+  SU_TRYCATCH(suscan_estimator_fam_register(), return SU_FALSE);
 
   estimators_init = SU_TRUE;
 
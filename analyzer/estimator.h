@@ -25,6 +25,7 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include <sigutils/sigutils.h>
+#include <sys/time.h>
 
 #define SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ 1024
 
@@ -35,17 +36,37 @@ struct suscan_estimator_class {
 
   void * (*ctor) (SUSCOUNT fs);
 
+  /* Time-domain estimators: fed with inspector samples */
   SUBOOL (*feed) (void *privdata, const SUCOMPLEX *samples, SUSCOUNT size);
 
+  /* Spectral estimators: fed with the shared spectrum of every block */
+  SUBOOL (*feed_spectrum) (
+      void *privdata,
+      const SUCOMPLEX *spectrum,
+      SUSCOUNT size);
+
   SUBOOL (*read) (const void *privdata, SUFLOAT *out);
 
   void (*dtor) (void *privdata);
+
+  /*
+   * Views: estimators with no state of their own, reading a different
+   * parameter from an estimator of class view_of. These only define read.
+   */
+  const char *view_of;
 };
 
 struct suscan_estimator {
   const struct suscan_estimator_class *classptr;
+  struct suscan_estimator *owner; /* Views only */
   void *privdata;
   SUBOOL enabled;
+  SUBOOL fed; /* Already fed in this round */
+
+  /* Last estimate, kept until the next estimation window completes */
+  SUBOOL         valid;
+  SUFLOAT        value;
+  struct timeval timestamp;
 };
 
 typedef struct suscan_estimator suscan_estimator_t;
@@ -65,6 +86,47 @@ suscan_estimator_set_enabled(suscan_estimator_t *estimator, SUBOOL state)
   estimator->enabled = state;
 }
 
+/* Returns the cached estimate and the time it was computed, if any */
+SUINLINE SUBOOL
+suscan_estimator_get_cached(
+    const suscan_estimator_t *estimator,
+    SUFLOAT *value,
+    struct timeval *timestamp)
+{
+  if (!estimator->valid)
+    return SU_FALSE;
+
+  if (value != NULL)
+    *value = estimator->value;
+
+  if (timestamp != NULL)
+    *timestamp = estimator->timestamp;
+
+  return SU_TRUE;
+}
+
+/* Estimator that actually gets fed samples on behalf of this one */
+SUINLINE suscan_estimator_t *
+suscan_estimator_get_source(suscan_estimator_t *estimator)
+{
+  return estimator->owner != NULL ? estimator->owner : estimator;
+}
+
+SUINLINE SUBOOL
+suscan_estimator_is_view(const suscan_estimator_t *estimator)
+{
+  return estimator->owner != NULL;
+}
+
+SUINLINE SUBOOL
+suscan_estimator_is_spectral(const suscan_estimator_t *estimator)
+{
+  if (estimator->owner != NULL)
+    estimator = estimator->owner;
+
+  return estimator->classptr->feed_spectrum != NULL;
+}
+
 SUBOOL suscan_estimator_class_register(
     const struct suscan_estimator_class *classdef);
 
@@ -72,20 +134,76 @@ suscan_estimator_t *suscan_estimator_new(
     const struct suscan_estimator_class *classdef,
     SUSCOUNT fs);
 
+suscan_estimator_t *suscan_estimator_new_view(
+    const struct suscan_estimator_class *classdef,
+    suscan_estimator_t *owner);
+
 SUBOOL suscan_estimator_feed(
     suscan_estimator_t *estimator,
     const SUCOMPLEX *samples,
     SUSCOUNT size);
 
+SUBOOL suscan_estimator_feed_list(
+    suscan_estimator_t **estimator_list,
+    unsigned int estimator_count,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size);
+
+SUBOOL suscan_estimator_feed_spectrum(
+    suscan_estimator_t *estimator,
+    const SUCOMPLEX *spectrum,
+    SUSCOUNT size);
+
 SUBOOL suscan_estimator_read(
     const suscan_estimator_t *estimator,
     SUFLOAT *out);
 
+SUBOOL suscan_estimator_update(suscan_estimator_t *estimator);
+
 void suscan_estimator_destroy(suscan_estimator_t *estimator);
 
+/*********************** Shared estimator front end **************************/
+/*
+ * Cuts inspector samples in blocks and computes the spectrum of each
+ * block once, for all the enabled spectral estimators of an inspector.
+ * The spectrum is the plain (not zero-padded) FFT of the block, hence
+ * correlations derived from it are circular.
+ */
+struct suscan_estimator_frontend {
+  SUSCOUNT   block_size;
+  SUSCOUNT   fill;
+
+  SUCOMPLEX *block;
+  SUCOMPLEX *spectrum;   /* block_size */
+
+  SU_FFTW(_plan) plan;
+};
+
+typedef struct suscan_estimator_frontend suscan_estimator_frontend_t;
+
+SUINLINE SUSCOUNT
+suscan_estimator_frontend_get_spectrum_size(
+    const suscan_estimator_frontend_t *self)
+{
+  return self->block_size;
+}
+
+suscan_estimator_frontend_t *suscan_estimator_frontend_new(
+    SUSCOUNT block_size);
+
+SUBOOL suscan_estimator_frontend_feed(
+    suscan_estimator_frontend_t *self,
+    suscan_estimator_t **estimator_list,
+    unsigned int estimator_count,
+    const SUCOMPLEX *samples,
+    SUSCOUNT size);
+
+void suscan_estimator_frontend_destroy(suscan_estimator_frontend_t *self);
+
 /******************** Builtin channel estimators *****************************/
 SUBOOL suscan_estimator_fac_register(void);
 SUBOOL suscan_estimator_nonlinear_register(void);
+SUBOOL suscan_estimator_fam_register(void);
 
 SUBOOL suscan_init_estimators(void);
 
@@ -21,33 +21,164 @@
 
 #define SU_LOG_DOMAIN "fac-estimator"
 
-#include <sigutils/detect.h>
-#include "source.h"
 #include "estimator.h"
+#include "src/fftplan.h"
+
+/*
+ * FAC (fast autocorrelation) baud estimator. The autocorrelation of a
+ * linearly modulated signal decays to zero in about one symbol period.
+ * It is obtained from the shared block spectrum as the inverse FFT of its
+ * squared magnitude (one FFT of the block size), and averaged over blocks.
+ * This correlation is circular: of the N products summed at lag k, only
+ * N - k are correlated, the remaining k wrap around the block and average
+ * out. Each lag is rescaled by N / (N - k) so that the resulting taper
+ * does not pull the level crossings (and therefore the baud estimate)
+ * towards lag 0. Lags beyond N / 2 are just the mirror of the first half.
+ */
+
+#define SUSCAN_ESTIMATOR_FAC_ALPHA .25
+#define SUSCAN_ESTIMATOR_FAC_UPPER .75 /* Relative to lag 0 */
+#define SUSCAN_ESTIMATOR_FAC_LOWER .25
+
+struct suscan_estimator_fac {
+  SUFLOAT    fs;
+  SUSCOUNT   size;   /* Spectrum size */
+  SUCOMPLEX *buf;    /* Power spectrum, then autocorrelation */
+  SUFLOAT   *acorr;  /* Averaged, unbiased |R|, size / 2 lags */
+  SUBOOL     primed;
+  SUFLOAT    baud;
+
+  SU_FFTW(_plan) plan;
+};
+
+SUPRIVATE void
+suscan_estimator_fac_destroy(struct suscan_estimator_fac *self)
+{
+  if (self->plan != NULL) {
+    (void) suscan_fft_planner_lock();
+    SU_FFTW(_destroy_plan)(self->plan);
+    suscan_fft_planner_unlock();
+  }
+
+  if (self->buf != NULL)
+    SU_FFTW(_free)(self->buf);
+
+  if (self->acorr != NULL)
+    free(self->acorr);
+
+  free(self);
+}
 
 SUPRIVATE void *
 suscan_estimator_fac_ctor(SUSCOUNT fs)
 {
-  struct sigutils_channel_detector_params cd_params =
-      sigutils_channel_detector_params_INITIALIZER;
+  struct suscan_estimator_fac *new = NULL;
+  SUBOOL locked = SU_FALSE;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_estimator_fac);
+
+  new->fs   = fs;
+  new->size = SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ;
+
+  SU_ALLOCATE_MANY_FAIL(new->acorr, new->size / 2, SUFLOAT);
+  SU_TRYCATCH(
+      new->buf = SU_FFTW(_malloc)(new->size * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      new->plan = SU_FFTW(_plan_dft_1d)(
+          new->size,
+          (SU_FFTW(_complex) *) new->buf,
+          (SU_FFTW(_complex) *) new->buf,
+          FFTW_BACKWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  return new;
+
+fail:
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_estimator_fac_destroy(new);
+
+  return NULL;
+}
+
+/* First lag at which the averaged autocorrelation falls below level */
+SUPRIVATE SUFLOAT
+suscan_estimator_fac_crossing(
+    const struct suscan_estimator_fac *self,
+    SUFLOAT level)
+{
+  const SUFLOAT *r = self->acorr;
+  SUSCOUNT i, lags = self->size / 2;
+
+  for (i = 1; i < lags; ++i)
+    if (r[i] < level)
+      return i - (level - r[i]) / (r[i - 1] - r[i]);
+
+  return 0;
+}
+
+/*
+ * Below the noise floor, the position of the minimum is meaningless.
+ * Instead, we extrapolate the decay between the 3/4 and 1/4 levels down
+ * to zero. This is exact for rectangular pulses (triangular correlation)
+ * and within a few percent for raised cosine pulses.
+ */
+SUPRIVATE SUFLOAT
+suscan_estimator_fac_find_baud(const struct suscan_estimator_fac *self)
+{
+  SUFLOAT r0 = self->acorr[0];
+  SUFLOAT upper, lower, period;
 
-  cd_params.samp_rate = fs;
-  cd_params.window_size = SUSCAN_SOURCE_DEFAULT_BUFSIZ;
-  cd_params.tune = SU_FALSE; /* Estimators expect baseband signals */
-  cd_params.mode = SU_CHANNEL_DETECTOR_MODE_AUTOCORRELATION;
+  if (r0 <= 0)
+    return 0;
 
-  return su_channel_detector_new(&cd_params);
+  upper = suscan_estimator_fac_crossing(self, SUSCAN_ESTIMATOR_FAC_UPPER * r0);
+  lower = suscan_estimator_fac_crossing(self, SUSCAN_ESTIMATOR_FAC_LOWER * r0);
+
+  if (upper <= 0 || lower <= upper)
+    return 0;
+
+  period = lower + (lower - upper) * SUSCAN_ESTIMATOR_FAC_LOWER 
+    / (SUSCAN_ESTIMATOR_FAC_UPPER - SUSCAN_ESTIMATOR_FAC_LOWER);
+
+  return self->fs / period;
 }
 
 SUPRIVATE SUBOOL
-suscan_estimator_fac_feed(void *private, const SUCOMPLEX *x, SUSCOUNT size)
+suscan_estimator_fac_feed_spectrum(
+    void *private,
+    const SUCOMPLEX *spectrum,
+    SUSCOUNT size)
 {
-  SU_TRYCATCH(
-      su_channel_detector_feed_bulk(
-          (su_channel_detector_t *) private,
-          x,
-          size) == size,
-      return SU_FALSE);
+  struct suscan_estimator_fac *self = (struct suscan_estimator_fac *) private;
+  SUSCOUNT i, lags = self->size / 2;
+  SUFLOAT alpha = self->primed ? SUSCAN_ESTIMATOR_FAC_ALPHA : 1;
+
+  SU_TRYCATCH(size == self->size, return SU_FALSE);
+
+  for (i = 0; i < size; ++i)
+    self->buf[i] = SU_C_REAL(spectrum[i]) * SU_C_REAL(spectrum[i])
+      + SU_C_IMAG(spectrum[i]) * SU_C_IMAG(spectrum[i]);
+
+  SU_FFTW(_execute)(self->plan);
+
+  for (i = 0; i < lags; ++i)
+    self->acorr[i] += alpha * (
+      SU_C_ABS(self->buf[i]) * size / (SUFLOAT) (size - i) - self->acorr[i]);
+
+  self->primed = SU_TRUE;
+  self->baud   = suscan_estimator_fac_find_baud(self);
 
   return SU_TRUE;
 }
@@ -55,7 +186,10 @@ suscan_estimator_fac_feed(void *private, const SUCOMPLEX *x, SUSCOUNT size)
 SUPRIVATE SUBOOL
 suscan_estimator_fac_read(const void *private, SUFLOAT *out)
 {
-  *out = su_channel_detector_get_baud((const su_channel_detector_t *) private);
+  const struct suscan_estimator_fac *self =
+    (const struct suscan_estimator_fac *) private;
+
+  *out = self->baud;
 
   return SU_TRUE;
 }
@@ -63,7 +197,7 @@ suscan_estimator_fac_read(const void *private, SUFLOAT *out)
 SUPRIVATE void
 suscan_estimator_fac_dtor(void *private)
 {
-  su_channel_detector_destroy((su_channel_detector_t *) private);
+  suscan_estimator_fac_destroy((struct suscan_estimator_fac *) private);
 }
 
 SUBOOL
@@ -74,7 +208,7 @@ suscan_estimator_fac_register(void)
       .desc  = "FAC baud estimator",
       .field = "clock.baud",
       .ctor  = suscan_estimator_fac_ctor,
-      .feed  = suscan_estimator_fac_feed,
+      .feed_spectrum = suscan_estimator_fac_feed_spectrum,
       .read  = suscan_estimator_fac_read,
       .dtor  = suscan_estimator_fac_dtor
   };
@@ -0,0 +1,520 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <string.h>
+
+#define SU_LOG_DOMAIN "fam-estimator"
+
+#include "estimator.h"
+#include "src/fftplan.h"
+
+/*
+ * Cyclostationary feature detector, based on the FFT accumulation method
+ * (FAM). The signal is channelized with short, overlapping FFTs, and the
+ * products of every pair of channels are Fourier-transformed along time
+ * with a single batched plan. This yields the spectral coherence of the
+ * signal for all cycle frequencies at once, for both the ordinary and the
+ * conjugate correlation. From it we get:
+ *
+ *   - The symbol rate, as the strongest ordinary cycle frequency.
+ *   - The carrier offset, as half the strongest conjugate cycle frequency
+ *     or, if there is none, as the centroid of the spectrum.
+ *   - The modulation family, as the order of the Costas loop needed to
+ *     remove the carrier: 2 for non-circular (BPSK-like) signals, 4 for
+ *     circular linear modulations, 0 if no feature stands out.
+ *
+ * The baud estimator owns the analysis. The offset and order estimators
+ * are views of it, so enabling all three costs the same as enabling one.
+ */
+
+#define SUSCAN_ESTIMATOR_FAM_CHANNELS  32  /* Channelizer size */
+#define SUSCAN_ESTIMATOR_FAM_HOP       (SUSCAN_ESTIMATOR_FAM_CHANNELS / 4)
+#define SUSCAN_ESTIMATOR_FAM_FRAMES    128 /* Channelizer frames per block */
+#define SUSCAN_ESTIMATOR_FAM_ALPHA     .25
+#define SUSCAN_ESTIMATOR_FAM_GUARD     4   /* Cycle bins ignored around 0 */
+#define SUSCAN_ESTIMATOR_FAM_THRESHOLD 2.  /* Feature to mean coherence */
+
+/* Cycle frequency bins per channel spacing, and half of it */
+#define SUSCAN_ESTIMATOR_FAM_RATIO                              \
+  (SUSCAN_ESTIMATOR_FAM_FRAMES * SUSCAN_ESTIMATOR_FAM_HOP       \
+   / SUSCAN_ESTIMATOR_FAM_CHANNELS)
+#define SUSCAN_ESTIMATOR_FAM_Q (SUSCAN_ESTIMATOR_FAM_RATIO / 2)
+
+#define SUSCAN_ESTIMATOR_FAM_PAIRS                              \
+  (SUSCAN_ESTIMATOR_FAM_CHANNELS * (SUSCAN_ESTIMATOR_FAM_CHANNELS + 1) / 2)
+
+/* Ordinary profile: [0, fs). Conjugate profile: [-fs, fs) */
+#define SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE                       \
+  (SUSCAN_ESTIMATOR_FAM_CHANNELS * SUSCAN_ESTIMATOR_FAM_RATIO   \
+   + SUSCAN_ESTIMATOR_FAM_Q + 1)
+#define SUSCAN_ESTIMATOR_FAM_CONJ_CENTER                        \
+  (SUSCAN_ESTIMATOR_FAM_CHANNELS * SUSCAN_ESTIMATOR_FAM_RATIO   \
+   + SUSCAN_ESTIMATOR_FAM_Q)
+#define SUSCAN_ESTIMATOR_FAM_CONJ_SIZE                          \
+  (2 * SUSCAN_ESTIMATOR_FAM_CONJ_CENTER + 1)
+
+struct suscan_estimator_fam {
+  SUFLOAT   fs;
+
+  /* Channelizer */
+  SUFLOAT   window[SUSCAN_ESTIMATOR_FAM_CHANNELS];
+  SUCOMPLEX twiddle[SUSCAN_ESTIMATOR_FAM_CHANNELS];
+  SUCOMPLEX hist[SUSCAN_ESTIMATOR_FAM_CHANNELS];
+  SUSCOUNT  fill;
+  SUCOMPLEX *frame;
+  SU_FFTW(_plan) frame_plan;
+
+  /* Channel products, ordinary and conjugate, one row per pair */
+  SUSCOUNT  count;
+  SUFLOAT   power[SUSCAN_ESTIMATOR_FAM_CHANNELS];
+  SUCOMPLEX *products;
+  SU_FFTW(_plan) product_plan;
+
+  /* Averaged results */
+  SUBOOL    primed;
+  SUFLOAT   psd[SUSCAN_ESTIMATOR_FAM_CHANNELS];
+  SUFLOAT   ordinary[SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE];
+  SUFLOAT   conjugate[SUSCAN_ESTIMATOR_FAM_CONJ_SIZE];
+  SUFLOAT   block_ordinary[SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE];
+  SUFLOAT   block_conjugate[SUSCAN_ESTIMATOR_FAM_CONJ_SIZE];
+
+  SUFLOAT   baud;
+  SUFLOAT   offset;
+  SUFLOAT   order;
+};
+
+SUPRIVATE void
+suscan_estimator_fam_destroy(struct suscan_estimator_fam *self)
+{
+  if (self->frame_plan != NULL || self->product_plan != NULL) {
+    (void) suscan_fft_planner_lock();
+    if (self->frame_plan != NULL)
+      SU_FFTW(_destroy_plan)(self->frame_plan);
+    if (self->product_plan != NULL)
+      SU_FFTW(_destroy_plan)(self->product_plan);
+    suscan_fft_planner_unlock();
+  }
+
+  if (self->frame != NULL)
+    SU_FFTW(_free)(self->frame);
+
+  if (self->products != NULL)
+    SU_FFTW(_free)(self->products);
+
+  free(self);
+}
+
+SUPRIVATE void *
+suscan_estimator_fam_ctor(SUSCOUNT fs)
+{
+  struct suscan_estimator_fam *new = NULL;
+  int n = SUSCAN_ESTIMATOR_FAM_FRAMES;
+  unsigned int i;
+  SUBOOL locked = SU_FALSE;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_estimator_fam);
+
+  new->fs = fs;
+
+  for (i = 0; i < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++i) {
+    new->window[i] = .5
+      - .5 * SU_COS(2 * PI * i / SUSCAN_ESTIMATOR_FAM_CHANNELS);
+    new->twiddle[i] = SU_C_EXP(
+        -I * 2 * PI * (SUFLOAT) i / SUSCAN_ESTIMATOR_FAM_CHANNELS);
+  }
+
+  SU_TRYCATCH(
+      new->frame = SU_FFTW(_malloc)(
+          SUSCAN_ESTIMATOR_FAM_CHANNELS * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(
+      new->products = SU_FFTW(_malloc)(
+          2 * SUSCAN_ESTIMATOR_FAM_PAIRS
+          * SUSCAN_ESTIMATOR_FAM_FRAMES
+          * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      new->frame_plan = SU_FFTW(_plan_dft_1d)(
+          SUSCAN_ESTIMATOR_FAM_CHANNELS,
+          (SU_FFTW(_complex) *) new->frame,
+          (SU_FFTW(_complex) *) new->frame,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  /* All pair products are transformed at once */
+  SU_TRYCATCH(
+      new->product_plan = SU_FFTW(_plan_many_dft)(
+          1,
+          &n,
+          2 * SUSCAN_ESTIMATOR_FAM_PAIRS,
+          (SU_FFTW(_complex) *) new->products,
+          NULL,
+          1,
+          SUSCAN_ESTIMATOR_FAM_FRAMES,
+          (SU_FFTW(_complex) *) new->products,
+          NULL,
+          1,
+          SUSCAN_ESTIMATOR_FAM_FRAMES,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  return new;
+
+fail:
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_estimator_fam_destroy(new);
+
+  return NULL;
+}
+
+/* Signed channel index, i.e. channel frequency in channel spacings */
+SUINLINE int
+suscan_estimator_fam_channel_freq(unsigned int m)
+{
+  return m < SUSCAN_ESTIMATOR_FAM_CHANNELS / 2
+    ? (int) m
+    : (int) m - SUSCAN_ESTIMATOR_FAM_CHANNELS;
+}
+
+/*
+ * Channelizes the sample history and appends the products of this frame
+ * to the product rows. Channel outputs are phase-corrected to absolute
+ * time, as if the channelizer were a bank of demodulators.
+ */
+SUPRIVATE void
+suscan_estimator_fam_process_frame(struct suscan_estimator_fam *self)
+{
+  const SUCOMPLEX *X = self->frame;
+  SUCOMPLEX *row = self->products + self->count;
+  SUSCOUNT stride = SUSCAN_ESTIMATOR_FAM_FRAMES;
+  SUSCOUNT conj = SUSCAN_ESTIMATOR_FAM_PAIRS * stride;
+  unsigned int m1, m2, phase;
+
+  for (m1 = 0; m1 < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m1)
+    self->frame[m1] = self->window[m1] * self->hist[m1];
+
+  SU_FFTW(_execute)(self->frame_plan);
+
+  phase = self->count * SUSCAN_ESTIMATOR_FAM_HOP;
+  for (m1 = 0; m1 < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m1) {
+    self->frame[m1] *=
+      self->twiddle[(m1 * phase) % SUSCAN_ESTIMATOR_FAM_CHANNELS];
+    self->power[m1] += SU_C_REAL(X[m1] * SU_C_CONJ(X[m1]));
+  }
+
+  for (m1 = 0; m1 < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m1)
+    for (m2 = 0; m2 <= m1; ++m2) {
+      row[0]    = X[m1] * SU_C_CONJ(X[m2]);
+      row[conj] = X[m1] * X[m2];
+      row += stride;
+    }
+
+  ++self->count;
+}
+
+/* Parabolic interpolation of a profile peak */
+SUPRIVATE SUFLOAT
+suscan_estimator_fam_refine(const SUFLOAT *profile, SUSCOUNT i, SUSCOUNT size)
+{
+  SUFLOAT den;
+
+  if (i == 0 || i + 1 >= size)
+    return i;
+
+  den = profile[i - 1] - 2 * profile[i] + profile[i + 1];
+  if (den >= 0)
+    return i;
+
+  return i + .5 * (profile[i - 1] - profile[i + 1]) / den;
+}
+
+/* Strongest bin of a profile range, if it stands out of the mean */
+SUPRIVATE SUBOOL
+suscan_estimator_fam_find_feature(
+    const SUFLOAT *profile,
+    SUSCOUNT start,
+    SUSCOUNT end,
+    SUSCOUNT size,
+    SUFLOAT *where)
+{
+  SUSCOUNT i, best = start;
+  SUFLOAT mean = 0;
+
+  for (i = start; i < end; ++i) {
+    mean += profile[i];
+    if (profile[i] > profile[best])
+      best = i;
+  }
+
+  mean /= end - start;
+
+  if (mean <= 0 || profile[best] < SUSCAN_ESTIMATOR_FAM_THRESHOLD * mean)
+    return SU_FALSE;
+
+  *where = suscan_estimator_fam_refine(profile, best, size);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_estimator_fam_update(struct suscan_estimator_fam *self)
+{
+  SUFLOAT dalpha = self->fs / (SUSCAN_ESTIMATOR_FAM_FRAMES
+                               * SUSCAN_ESTIMATOR_FAM_HOP);
+  SUFLOAT where, floor = 0, num = 0, den = 0;
+  SUBOOL ordinary, conjugate;
+  unsigned int m;
+
+  /* Ordinary features between the guard and fs / 2 */
+  ordinary = suscan_estimator_fam_find_feature(
+      self->ordinary,
+      SUSCAN_ESTIMATOR_FAM_GUARD,
+      SUSCAN_ESTIMATOR_FAM_CHANNELS * SUSCAN_ESTIMATOR_FAM_RATIO / 2,
+      SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE,
+      &where);
+
+  self->baud = ordinary ? where * dalpha : 0;
+
+  conjugate = suscan_estimator_fam_find_feature(
+      self->conjugate,
+      0,
+      SUSCAN_ESTIMATOR_FAM_CONJ_SIZE,
+      SUSCAN_ESTIMATOR_FAM_CONJ_SIZE,
+      &where);
+
+  if (conjugate) {
+    self->offset = .5 * (where - SUSCAN_ESTIMATOR_FAM_CONJ_CENTER) * dalpha;
+    self->order  = 2;
+  } else {
+    /* Centroid of the spectrum, above the noise floor */
+    for (m = 0; m < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m)
+      if (m == 0 || self->psd[m] < floor)
+        floor = self->psd[m];
+
+    for (m = 0; m < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m) {
+      num += suscan_estimator_fam_channel_freq(m) * (self->psd[m] - floor);
+      den += self->psd[m] - floor;
+    }
+
+    self->offset = den > 0
+      ? num / den * self->fs / SUSCAN_ESTIMATOR_FAM_CHANNELS
+      : 0;
+    self->order  = ordinary ? 4 : 0;
+  }
+}
+
+/*
+ * Transforms the product rows and keeps, for every cycle frequency, the
+ * strongest spectral coherence found among all channel pairs. Only the
+ * central bins of each row are kept, as the rest overlap with the rows
+ * of neighboring pairs.
+ */
+SUPRIVATE void
+suscan_estimator_fam_process_block(struct suscan_estimator_fam *self)
+{
+  const SUCOMPLEX *row = self->products;
+  SUSCOUNT stride = SUSCAN_ESTIMATOR_FAM_FRAMES;
+  SUSCOUNT conj = SUSCAN_ESTIMATOR_FAM_PAIRS * stride;
+  SUFLOAT alpha = self->primed ? SUSCAN_ESTIMATOR_FAM_ALPHA : 1;
+  SUFLOAT norm, c;
+  unsigned int m1, m2, i;
+  int q, a, f1, f2;
+
+  SU_FFTW(_execute)(self->product_plan);
+
+  memset(self->block_ordinary, 0, sizeof(self->block_ordinary));
+  memset(self->block_conjugate, 0, sizeof(self->block_conjugate));
+
+  for (m1 = 0; m1 < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++m1)
+    for (m2 = 0; m2 <= m1; ++m2) {
+      f1 = suscan_estimator_fam_channel_freq(m1);
+      f2 = suscan_estimator_fam_channel_freq(m2);
+
+      if ((norm = self->power[m1] * self->power[m2]) > 0) {
+        norm = 1. / SU_SQRT(norm);
+
+        for (q = -SUSCAN_ESTIMATOR_FAM_Q; q <= SUSCAN_ESTIMATOR_FAM_Q; ++q) {
+          i = (q + SUSCAN_ESTIMATOR_FAM_FRAMES) % SUSCAN_ESTIMATOR_FAM_FRAMES;
+
+          /* Ordinary coherence is symmetric in the cycle frequency */
+          a = abs((f1 - f2) * SUSCAN_ESTIMATOR_FAM_RATIO + q);
+          c = SU_C_ABS(row[i]) * norm;
+          if (a < SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE
+              && c > self->block_ordinary[a])
+            self->block_ordinary[a] = c;
+
+          a = SUSCAN_ESTIMATOR_FAM_CONJ_CENTER
+            + (f1 + f2) * SUSCAN_ESTIMATOR_FAM_RATIO + q;
+          c = SU_C_ABS(row[conj + i]) * norm;
+          if (a >= 0
+              && a < SUSCAN_ESTIMATOR_FAM_CONJ_SIZE
+              && c > self->block_conjugate[a])
+            self->block_conjugate[a] = c;
+        }
+      }
+
+      row += stride;
+    }
+
+  for (i = 0; i < SUSCAN_ESTIMATOR_FAM_PROFILE_SIZE; ++i)
+    self->ordinary[i] += alpha * (self->block_ordinary[i] - self->ordinary[i]);
+
+  for (i = 0; i < SUSCAN_ESTIMATOR_FAM_CONJ_SIZE; ++i)
+    self->conjugate[i] +=
+      alpha * (self->block_conjugate[i] - self->conjugate[i]);
+
+  for (i = 0; i < SUSCAN_ESTIMATOR_FAM_CHANNELS; ++i) {
+    self->psd[i] += alpha * (self->power[i] - self->psd[i]);
+    self->power[i] = 0;
+  }
+
+  self->primed = SU_TRUE;
+  self->count  = 0;
+
+  suscan_estimator_fam_update(self);
+}
+
+SUPRIVATE SUBOOL
+suscan_estimator_fam_feed(void *private, const SUCOMPLEX *x, SUSCOUNT size)
+{
+  struct suscan_estimator_fam *self = (struct suscan_estimator_fam *) private;
+  SUSCOUNT chunk;
+
+  while (size > 0) {
+    chunk = SU_MIN(size, SUSCAN_ESTIMATOR_FAM_CHANNELS - self->fill);
+    memcpy(self->hist + self->fill, x, chunk * sizeof(SUCOMPLEX));
+    self->fill += chunk;
+
+    if (self->fill == SUSCAN_ESTIMATOR_FAM_CHANNELS) {
+      suscan_estimator_fam_process_frame(self);
+
+      if (self->count == SUSCAN_ESTIMATOR_FAM_FRAMES)
+        suscan_estimator_fam_process_block(self);
+
+      memmove(
+          self->hist,
+          self->hist + SUSCAN_ESTIMATOR_FAM_HOP,
+          (SUSCAN_ESTIMATOR_FAM_CHANNELS - SUSCAN_ESTIMATOR_FAM_HOP)
+          * sizeof(SUCOMPLEX));
+      self->fill -= SUSCAN_ESTIMATOR_FAM_HOP;
+    }
+
+    x    += chunk;
+    size -= chunk;
+  }
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_estimator_fam_read_baud(const void *private, SUFLOAT *out)
+{
+  const struct suscan_estimator_fam *self =
+    (const struct suscan_estimator_fam *) private;
+
+  if (!self->primed)
+    return SU_FALSE;
+
+  *out = self->baud;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_estimator_fam_read_offset(const void *private, SUFLOAT *out)
+{
+  const struct suscan_estimator_fam *self =
+    (const struct suscan_estimator_fam *) private;
+
+  if (!self->primed)
+    return SU_FALSE;
+
+  *out = self->offset;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_estimator_fam_read_order(const void *private, SUFLOAT *out)
+{
+  const struct suscan_estimator_fam *self =
+    (const struct suscan_estimator_fam *) private;
+
+  if (!self->primed)
+    return SU_FALSE;
+
+  *out = self->order;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_estimator_fam_dtor(void *private)
+{
+  suscan_estimator_fam_destroy((struct suscan_estimator_fam *) private);
+}
+
+SUBOOL
+suscan_estimator_fam_register(void)
+{
+  static struct suscan_estimator_class baud_class = {
+      .name  = "baud-fam",
+      .desc  = "Cyclostationary (FAM) baud estimator",
+      .field = "clock.baud",
+      .ctor  = suscan_estimator_fam_ctor,
+      .feed  = suscan_estimator_fam_feed,
+      .read  = suscan_estimator_fam_read_baud,
+      .dtor  = suscan_estimator_fam_dtor
+  };
+
+  static struct suscan_estimator_class offset_class = {
+      .name    = "offset-fam",
+      .desc    = "Cyclostationary (FAM) carrier offset estimator",
+      .field   = "afc.offset",
+      .view_of = "baud-fam",
+      .read    = suscan_estimator_fam_read_offset
+  };
+
+  static struct suscan_estimator_class order_class = {
+      .name    = "order-fam",
+      .desc    = "Cyclostationary (FAM) modulation family estimator",
+      .field   = "afc.costas-order",
+      .view_of = "baud-fam",
+      .read    = suscan_estimator_fam_read_order
+  };
+
+  SU_TRYCATCH(suscan_estimator_class_register(&baud_class), return SU_FALSE);
+  SU_TRYCATCH(suscan_estimator_class_register(&offset_class), return SU_FALSE);
+  SU_TRYCATCH(suscan_estimator_class_register(&order_class), return SU_FALSE);
+
+  return SU_TRUE;
+}
@@ -21,22 +21,144 @@
 
 #define SU_LOG_DOMAIN "nonlinear-estimator"
 
-#include <sigutils/detect.h>
-#include "source.h"
 #include "estimator.h"
+#include "src/fftplan.h"
+
+/*
+ * Non-linear baud estimator. The squared magnitude of the differentiated
+ * signal has a spectral line at the baud rate. Samples are differentiated
+ * and squared in the time domain, in blocks of SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ
+ * samples, and the power spectrum of each block (one FFT) is averaged over
+ * blocks. The baud rate is the strongest line away from DC.
+ */
+
+#define SUSCAN_ESTIMATOR_NONLINEAR_ALPHA .25
+#define SUSCAN_ESTIMATOR_NONLINEAR_GUARD 2   /* Bins ignored around DC */
+
+struct suscan_estimator_nonlinear {
+  SUFLOAT    fs;
+  SUSCOUNT   size;   /* Block size */
+  SUSCOUNT   fill;   /* Samples in the current block */
+  SUCOMPLEX  prev;   /* Last sample of the previous block */
+  SUCOMPLEX *buf;    /* Squared differences, then their spectrum */
+  SUFLOAT   *psd;    /* Averaged line spectrum, size / 2 bins */
+  SUBOOL     primed;
+  SUFLOAT    baud;
+
+  SU_FFTW(_plan) plan;
+};
+
+SUPRIVATE void
+suscan_estimator_nonlinear_destroy(struct suscan_estimator_nonlinear *self)
+{
+  if (self->plan != NULL) {
+    (void) suscan_fft_planner_lock();
+    SU_FFTW(_destroy_plan)(self->plan);
+    suscan_fft_planner_unlock();
+  }
+
+  if (self->buf != NULL)
+    SU_FFTW(_free)(self->buf);
+
+  if (self->psd != NULL)
+    free(self->psd);
+
+  free(self);
+}
 
 SUPRIVATE void *
 suscan_estimator_nonlinear_ctor(SUSCOUNT fs)
 {
-  struct sigutils_channel_detector_params cd_params =
-      sigutils_channel_detector_params_INITIALIZER;
+  struct suscan_estimator_nonlinear *new = NULL;
+  SUBOOL locked = SU_FALSE;
 
-  cd_params.samp_rate = fs;
-  cd_params.window_size = SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ;
-  cd_params.tune = SU_FALSE; /* Estimators expect baseband signals */
-  cd_params.mode = SU_CHANNEL_DETECTOR_MODE_NONLINEAR_DIFF;
+  SU_ALLOCATE_FAIL(new, struct suscan_estimator_nonlinear);
 
-  return su_channel_detector_new(&cd_params);
+  new->fs   = fs;
+  new->size = SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ;
+
+  SU_ALLOCATE_MANY_FAIL(new->psd, new->size / 2, SUFLOAT);
+  SU_TRYCATCH(
+      new->buf = SU_FFTW(_malloc)(new->size * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      new->plan = SU_FFTW(_plan_dft_1d)(
+          new->size,
+          (SU_FFTW(_complex) *) new->buf,
+          (SU_FFTW(_complex) *) new->buf,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  return new;
+
+fail:
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_estimator_nonlinear_destroy(new);
+
+  return NULL;
+}
+
+/* Strongest line away from DC, refined by parabolic interpolation */
+SUPRIVATE SUFLOAT
+suscan_estimator_nonlinear_find_baud(
+    const struct suscan_estimator_nonlinear *self)
+{
+  const SUFLOAT *p = self->psd;
+  SUSCOUNT i, max = 0, bins = self->size / 2;
+  SUFLOAT den, delta = 0;
+
+  for (i = SUSCAN_ESTIMATOR_NONLINEAR_GUARD; i < bins - 1; ++i)
+    if (max == 0 || p[i] > p[max])
+      max = i;
+
+  if (max == 0 || p[max] <= 0)
+    return 0;
+
+  den = p[max - 1] - 2 * p[max] + p[max + 1];
+  if (den < 0)
+    delta = .5 * (p[max - 1] - p[max + 1]) / den;
+
+  return self->fs * (max + delta) / self->size;
+}
+
+SUPRIVATE void
+suscan_estimator_nonlinear_process_block(
+    struct suscan_estimator_nonlinear *self)
+{
+  SUSCOUNT i, half = self->size / 2;
+  SUFLOAT alpha = self->primed ? SUSCAN_ESTIMATOR_NONLINEAR_ALPHA : 1;
+  SUFLOAT mean = 0;
+
+  for (i = 0; i < self->size; ++i)
+    mean += SU_C_REAL(self->buf[i]);
+
+  mean /= self->size;
+
+  for (i = 0; i < self->size; ++i)
+    self->buf[i] -= mean;
+
+  SU_FFTW(_execute)(self->plan);
+
+  /* Real input: the positive half of the spectrum is enough */
+  for (i = 0; i < half; ++i)
+    self->psd[i] += alpha * (
+      SU_C_REAL(self->buf[i]) * SU_C_REAL(self->buf[i])
+      + SU_C_IMAG(self->buf[i]) * SU_C_IMAG(self->buf[i])
+      - self->psd[i]);
+
+  self->primed = SU_TRUE;
+  self->baud   = suscan_estimator_nonlinear_find_baud(self);
 }
 
 SUPRIVATE SUBOOL
@@ -45,18 +167,22 @@ suscan_estimator_nonlinear_feed(
     const SUCOMPLEX *x,
     SUSCOUNT size)
 {
-  SUSCOUNT got;
-
-  while (size > 0) {
-    SU_TRYCATCH(
-        (got = su_channel_detector_feed_bulk(
-            (su_channel_detector_t *) private,
-            x,
-            size)) == size,
-        return SU_FALSE);
-
-    size -= got;
-    x += got;
+  struct suscan_estimator_nonlinear *self =
+    (struct suscan_estimator_nonlinear *) private;
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    diff       = x[i] - self->prev;
+    self->prev = x[i];
+
+    self->buf[self->fill] =
+      SU_C_REAL(diff) * SU_C_REAL(diff) + SU_C_IMAG(diff) * SU_C_IMAG(diff);
+
+    if (++self->fill == self->size) {
+      suscan_estimator_nonlinear_process_block(self);
+      self->fill = 0;
+    }
   }
 
   return SU_TRUE;
@@ -65,7 +191,13 @@ suscan_estimator_nonlinear_feed(
 SUPRIVATE SUBOOL
 suscan_estimator_nonlinear_read(const void *private, SUFLOAT *out)
 {
-  *out = su_channel_detector_get_baud((const su_channel_detector_t *) private);
+  const struct suscan_estimator_nonlinear *self =
+    (const struct suscan_estimator_nonlinear *) private;
+
+  if (!self->primed)
+    return SU_FALSE;
+
+  *out = self->baud;
 
   return SU_TRUE;
 }
@@ -73,7 +205,8 @@ suscan_estimator_nonlinear_read(const void *private, SUFLOAT *out)
 SUPRIVATE void
 suscan_estimator_nonlinear_dtor(void *private)
 {
-  su_channel_detector_destroy((su_channel_detector_t *) private);
+  suscan_estimator_nonlinear_destroy(
+    (struct suscan_estimator_nonlinear *) private);
 }
 
 SUBOOL
@@ -0,0 +1,224 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SU_LOG_DOMAIN "hopplan"
+
+#include <sigutils/sigutils.h>
+#include "hopplan.h"
+
+/* SplitMix64. Small, fast, and good enough to shuffle a sweep */
+SUINLINE uint64_t
+suscan_hopplan_rand(suscan_hopplan_t *self)
+{
+  uint64_t z = (self->rng += 0x9e3779b97f4a7c15ull);
+
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+
+  return z ^ (z >> 31);
+}
+
+/* Uniform in [0, 1) */
+SUINLINE SUFLOAT
+suscan_hopplan_uniform(suscan_hopplan_t *self)
+{
+  return (suscan_hopplan_rand(self) >> 11) * (1. / 9007199254740992.);
+}
+
+SUINLINE SUBOOL
+suscan_hopplan_is_randomized(const suscan_hopplan_t *self)
+{
+  return self->params.strategy == SUSCAN_ANALYZER_SWEEP_STRATEGY_STOCHASTIC
+    || self->params.partitioning
+      == SUSCAN_ANALYZER_SPECTRUM_PARTITIONING_CONTINUOUS;
+}
+
+uint64_t
+suscan_hopplan_default_seed(void)
+{
+  const char *env = getenv(SUSCAN_HOPPLAN_SEED_ENV);
+
+  if (env != NULL && *env != '\0')
+    return strtoull(env, NULL, 0);
+
+  return SUSCAN_HOPPLAN_DEFAULT_SEED;
+}
+
+/* Hop step and number of hops per pass */
+SUPRIVATE unsigned int
+suscan_hopplan_get_layout(const suscan_hopplan_t *self, SUFREQ *step)
+{
+  SUFREQ bw = self->params.max_freq - self->params.min_freq;
+  SUFREQ n;
+
+  /* Narrower than one hop: stay in the center */
+  if (bw < 1) {
+    *step = 0;
+    return 1;
+  }
+
+  *step = self->fs * self->params.rel_bw;
+  if (*step < 1)
+    *step = 1;
+
+  n = SU_FLOOR(bw / *step) + 1;
+
+  /* Make sure the upper edge gets visited too */
+  if (self->params.min_freq + (n - 1) * *step
+      < self->params.max_freq - .5 * *step)
+    ++n;
+
+  if (n > SUSCAN_HOPPLAN_MAX_HOPS) {
+    n = SUSCAN_HOPPLAN_MAX_HOPS;
+    *step = bw / (n - 1);
+  }
+
+  return n;
+}
+
+/*
+ * Lays out the frequencies of one pass. Settle times stay attached to the
+ * position in the list, except for shuffles, where they follow the hop.
+ */
+SUPRIVATE void
+suscan_hopplan_layout(suscan_hopplan_t *self)
+{
+  SUFREQ min = self->params.min_freq;
+  SUFREQ max = self->params.max_freq;
+  SUFREQ step;
+  struct suscan_hop tmp;
+  unsigned int i, j;
+  SUBOOL continuous;
+
+  (void) suscan_hopplan_get_layout(self, &step);
+
+  if (self->hop_count == 1 && step == 0) {
+    self->hop_list[0].freq = .5 * (min + max);
+    return;
+  }
+
+  continuous = self->params.partitioning
+    == SUSCAN_ANALYZER_SPECTRUM_PARTITIONING_CONTINUOUS;
+
+  if (self->params.strategy == SUSCAN_ANALYZER_SWEEP_STRATEGY_STOCHASTIC) {
+    if (continuous) {
+      /* Anywhere in the range */
+      for (i = 0; i < self->hop_count; ++i)
+        self->hop_list[i].freq = min + suscan_hopplan_uniform(self) * (max - min);
+    } else {
+      /* Fixed partitions, visited in random order (Fisher-Yates) */
+      if (self->pass == 0)
+        for (i = 0; i < self->hop_count; ++i)
+          self->hop_list[i].freq = SU_MIN(min + i * step, max);
+
+      for (i = self->hop_count - 1; i > 0; --i) {
+        j = suscan_hopplan_rand(self) % (i + 1);
+        tmp = self->hop_list[i];
+        self->hop_list[i] = self->hop_list[j];
+        self->hop_list[j] = tmp;
+      }
+    }
+  } else {
+    /* Monotonic. Continuous plans get jittered steps */
+    for (i = 0; i < self->hop_count; ++i) {
+      self->hop_list[i].freq = SU_MIN(min + i * step, max);
+      if (continuous)
+        self->hop_list[i].freq -=
+          SU_FLOOR(step * SUSCAN_HOPPLAN_JITTER * suscan_hopplan_uniform(self));
+
+      if (self->hop_list[i].freq < min)
+        self->hop_list[i].freq = min;
+    }
+  }
+}
+
+suscan_hopplan_t *
+suscan_hopplan_new(
+    const struct suscan_analyzer_sweep_params *params,
+    SUFREQ fs,
+    uint64_t seed)
+{
+  suscan_hopplan_t *new = NULL;
+  SUFREQ step;
+
+  SU_TRYCATCH(params->max_freq >= params->min_freq, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_hopplan_t);
+
+  new->params = *params;
+  new->fs     = fs;
+  new->rng    = seed;
+
+  new->hop_count = suscan_hopplan_get_layout(new, &step);
+  SU_ALLOCATE_MANY_FAIL(new->hop_list, new->hop_count, struct suscan_hop);
+
+  suscan_hopplan_layout(new);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_hopplan_destroy(new);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_hopplan_matches(
+    const suscan_hopplan_t *self,
+    const struct suscan_analyzer_sweep_params *params,
+    SUFREQ fs)
+{
+  return self->fs == fs
+    && self->params.strategy     == params->strategy
+    && self->params.partitioning == params->partitioning
+    && self->params.min_freq     == params->min_freq
+    && self->params.max_freq     == params->max_freq
+    && self->params.rel_bw       == params->rel_bw;
+}
+
+/*
+ * Returns the next hop of the plan. Hops are returned writable so that
+ * the caller can fill in their settle time while calibrating.
+ */
+struct suscan_hop *
+suscan_hopplan_next(suscan_hopplan_t *self)
+{
+  if (self->next == self->hop_count) {
+    self->next = 0;
+    ++self->pass;
+
+    if (suscan_hopplan_is_randomized(self))
+      suscan_hopplan_layout(self);
+  }
+
+  return self->hop_list + self->next++;
+}
+
+void
+suscan_hopplan_destroy(suscan_hopplan_t *self)
+{
+  if (self->hop_list != NULL)
+    free(self->hop_list);
+
+  free(self);
+}
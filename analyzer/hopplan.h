@@ -0,0 +1,92 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _HOPPLAN_H
+#define _HOPPLAN_H
+
+#include <sigutils/sigutils.h>
+#include <analyzer/analyzer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_HOPPLAN_MAX_HOPS     1048576
+#define SUSCAN_HOPPLAN_JITTER       .2      /* Of the step, continuous plans */
+#define SUSCAN_HOPPLAN_DEFAULT_SEED 0x5355534341ull
+#define SUSCAN_HOPPLAN_SEED_ENV     "SUSCAN_SWEEP_SEED"
+
+struct suscan_hop {
+  SUFREQ   freq;
+  SUSCOUNT settle; /* Samples to discard after retuning */
+};
+
+/*
+ * A hop plan is the sequence of center frequencies visited by a wide
+ * sweep, computed once per sweep configuration. Randomized plans draw
+ * from their own PRNG, so that the same seed always gives the same sweep.
+ * Settle times are measured during the first pass over the plan and
+ * reused afterwards.
+ */
+struct suscan_hopplan {
+  struct suscan_analyzer_sweep_params params;
+  SUFREQ   fs;
+  uint64_t rng;
+
+  struct suscan_hop *hop_list;
+  unsigned int hop_count;
+  unsigned int next;
+  SUSCOUNT     pass;  /* Completed passes */
+};
+
+typedef struct suscan_hopplan suscan_hopplan_t;
+
+SUINLINE SUBOOL
+suscan_hopplan_is_calibrated(const suscan_hopplan_t *self)
+{
+  return self->pass > 0;
+}
+
+SUINLINE unsigned int
+suscan_hopplan_get_hop_count(const suscan_hopplan_t *self)
+{
+  return self->hop_count;
+}
+
+uint64_t suscan_hopplan_default_seed(void);
+
+suscan_hopplan_t *suscan_hopplan_new(
+    const struct suscan_analyzer_sweep_params *params,
+    SUFREQ fs,
+    uint64_t seed);
+
+SUBOOL suscan_hopplan_matches(
+    const suscan_hopplan_t *self,
+    const struct suscan_analyzer_sweep_params *params,
+    SUFREQ fs);
+
+struct suscan_hop *suscan_hopplan_next(suscan_hopplan_t *self);
+
+void suscan_hopplan_destroy(suscan_hopplan_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _HOPPLAN_H */
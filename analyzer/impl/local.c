@@ -79,6 +79,218 @@ suscan_analyzer_baseband_filter_destroy(
   free(filter);
 }
 
+/******************** Asynchronous baseband filter API ***********************/
+SUPRIVATE void
+suscan_local_analyzer_async_bbfilt_destroy(
+    struct suscan_local_analyzer_async_bbfilt *self)
+{
+  struct suscan_local_analyzer_bbfilt_job *job;
+
+  if (self->worker != NULL)
+    if (!suscan_analyzer_halt_worker(self->worker)) {
+      SU_ERROR("Baseband filter worker destruction failed, memory leak ahead\n");
+      return;
+    }
+
+  /* Return the references that were never delivered */
+  while (self->pending > 0) {
+    job = self->queue + self->tail;
+    if (!suscan_sample_buffer_pool_give(
+      suscan_sample_buffer_parent(job->buffer),
+      job->buffer))
+      SU_ERROR("Failed to give buffer!\n");
+    self->tail = (self->tail + 1) % self->max_lag;
+    --self->pending;
+  }
+
+  if (self->dropped > 0)
+    SU_INFO(
+      "Asynchronous baseband filter: %lld buffers delivered, "
+      "%lld dropped (%lld samples)\n",
+      self->delivered,
+      self->dropped,
+      self->dropped_samples);
+
+  if (self->queue != NULL)
+    free(self->queue);
+
+  if (self->mq_init)
+    suscan_mq_finalize(&self->mq_out);
+
+  if (self->mutex_init)
+    pthread_mutex_destroy(&self->mutex);
+
+  free(self);
+}
+
+SUPRIVATE struct suscan_local_analyzer_async_bbfilt *
+suscan_local_analyzer_async_bbfilt_new(
+    suscan_local_analyzer_t *owner,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata,
+    unsigned int max_lag)
+{
+  struct suscan_local_analyzer_async_bbfilt *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_local_analyzer_async_bbfilt);
+
+  if (max_lag == 0)
+    max_lag = SUSCAN_ANALYZER_ASYNC_BBFILT_DEFAULT_MAX_LAG;
+
+  new->owner            = owner;
+  new->filter.func      = func;
+  new->filter.privdata  = privdata;
+  new->max_lag          = max_lag;
+
+  SU_ALLOCATE_MANY_FAIL(
+    new->queue,
+    max_lag,
+    struct suscan_local_analyzer_bbfilt_job);
+
+  SU_TRYZ_FAIL(pthread_mutex_init(&new->mutex, NULL));
+  new->mutex_init = SU_TRUE;
+
+  SU_TRY_FAIL(suscan_mq_init(&new->mq_out));
+  new->mq_init = SU_TRUE;
+
+  SU_TRY_FAIL(
+    new->worker = suscan_worker_new_ex(
+      "bbfilt-worker",
+      &new->mq_out,
+      new));
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_local_analyzer_async_bbfilt_destroy(new);
+
+  return NULL;
+}
+
+/*
+ * The worker callback drains the whole queue. This way, jobs whose wake-up
+ * message could not be pushed are still processed in the next run.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_async_bbfilt_wk_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  struct suscan_local_analyzer_async_bbfilt *self =
+    (struct suscan_local_analyzer_async_bbfilt *) wk_private;
+  struct suscan_local_analyzer_bbfilt_job *job;
+  SUBOOL have_job;
+  SUBOOL failed;
+
+  for (;;) {
+    SU_TRYZ(pthread_mutex_lock(&self->mutex));
+    have_job = self->pending > 0;
+    failed   = self->failed;
+    job = self->queue + self->tail;
+    (void) pthread_mutex_unlock(&self->mutex);
+
+    if (!have_job)
+      break;
+
+    /*
+     * The tail slot is only released by us, so it is safe to access
+     * it without the lock.
+     */
+    if (!failed) {
+      if (!(self->filter.func) (
+        self->filter.privdata,
+        self->owner->parent,
+        suscan_sample_buffer_data(job->buffer),
+        job->length,
+        job->consumed)) {
+        SU_ERROR("Asynchronous baseband filter failed, disabling\n");
+        failed = SU_TRUE;
+      }
+    }
+
+    if (!suscan_sample_buffer_pool_give(
+      suscan_sample_buffer_parent(job->buffer),
+      job->buffer))
+      SU_ERROR("Failed to give buffer!\n");
+
+    SU_TRYZ(pthread_mutex_lock(&self->mutex));
+    self->tail = (self->tail + 1) % self->max_lag;
+    self->failed = failed;
+    --self->pending;
+    ++self->delivered;
+    (void) pthread_mutex_unlock(&self->mutex);
+  }
+
+done:
+  return SU_FALSE;
+}
+
+void
+suscan_local_analyzer_async_bbfilt_drop(
+    struct suscan_local_analyzer_async_bbfilt *self,
+    SUSCOUNT length)
+{
+  if (self->dropped++ % SUSCAN_ANALYZER_ASYNC_BBFILT_DROP_REPORT == 0)
+    SU_WARNING(
+      "Asynchronous baseband filter is too slow (%lld buffers dropped)\n",
+      self->dropped);
+
+  self->dropped_samples += length;
+}
+
+/*
+ * Takes ownership of one reference of the buffer if there is room for it
+ * in the queue. Otherwise, the buffer is accounted as dropped and the
+ * caller keeps the reference.
+ */
+SUBOOL
+suscan_local_analyzer_async_bbfilt_push(
+    struct suscan_local_analyzer_async_bbfilt *self,
+    suscan_sample_buffer_t *buffer,
+    SUSCOUNT length,
+    SUSCOUNT consumed)
+{
+  struct suscan_local_analyzer_bbfilt_job *job;
+  SUBOOL failed;
+  SUBOOL queued = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->mutex));
+
+  failed = self->failed;
+
+  if (!failed && self->pending < self->max_lag) {
+    job = self->queue + self->head;
+
+    job->buffer   = buffer;
+    job->length   = length;
+    job->consumed = consumed;
+
+    self->head = (self->head + 1) % self->max_lag;
+    ++self->pending;
+    queued = SU_TRUE;
+  }
+
+  (void) pthread_mutex_unlock(&self->mutex);
+
+  if (failed)
+    return SU_FALSE;
+
+  if (queued) {
+    if (!suscan_worker_push(
+      self->worker,
+      suscan_local_analyzer_async_bbfilt_wk_cb,
+      NULL))
+      SU_ERROR("Failed to wake up baseband filter worker\n");
+  } else {
+    suscan_local_analyzer_async_bbfilt_drop(self, length);
+  }
+
+done:
+  return queued;
+}
+
 /************************ Local analyzer thread ******************************/
 SUPRIVATE void
 suscan_local_analyzer_ack_halt(suscan_local_analyzer_t *self)
@@ -283,6 +495,10 @@ suscan_analyzer_thread(void *data)
           SU_TRY(suscan_local_analyzer_slow_set_replay(self, replay->replay));
           break;
         
+        case SUSCAN_LOCAL_ANALYZER_MESSAGE_TYPE_REPLAN:
+          suscan_local_analyzer_adapt_tuner_window(self, NULL);
+          break;
+
         /* Forward these messages to output */
         case SUSCAN_ANALYZER_MESSAGE_TYPE_EOS:
         case SUSCAN_ANALYZER_MESSAGE_TYPE_CHANNEL:
@@ -333,6 +549,9 @@ suscan_analyzer_thread(void *data)
 
             /* vvvvvvvvvvvvvvv Source parameters update start vvvvvvvvvvvvv */
 
+            /* The sweep worker may still be using the detector */
+            SU_TRY(suscan_local_analyzer_drain_sweep(self));
+
             /* Attempt to update detector parameters */
             new_det_params = self->detector->params; /* Not all parameters are allowed */
 
@@ -352,6 +571,7 @@ suscan_analyzer_thread(void *data)
             }
 
             self->parent->params.detector_params = new_det_params;
+            self->parent->params.panorama_bins = new_params->panorama_bins;
 
             SU_TRY(suscan_local_analyzer_notify_params(self));
 
@@ -452,6 +672,13 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   /* Periodic updates */
   new->interval_channels = parent->params.channel_update_int;
   new->interval_psd      = parent->params.psd_update_int;
+  new->psd_averaging     = parent->params.psd_averaging;
+
+  new->stats_params.interval   = parent->params.stats_interval;
+  new->stats_params.threshold  = parent->params.stats_threshold;
+  new->stats_params.percentile = parent->params.stats_percentile;
+  new->stats_params_req         = new->stats_params;
+
   new->last_psd          = suscan_gettime_coarse();
   new->last_channels     = suscan_gettime_coarse();
 
@@ -459,6 +686,9 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   (void) pthread_mutex_init(&new->loop_mutex, NULL); /* Always succeeds */
   new->loop_init = SU_TRUE;
 
+  (void) pthread_mutex_init(&new->psd_stats_mutex, NULL);
+  new->psd_stats_init = SU_TRUE;
+
   /* Create source worker */
   if ((new->source_wk = suscan_worker_new_ex(
     "source-worker", 
@@ -484,16 +714,7 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
   new->gain_req_mutex_init = SU_TRUE;
 
   /* Create spectral tuner, with suitable read size */
-  if (new->source_info.effective_samp_rate >= 10000000)
-    st_params.window_size = 131072;
-  else if (new->source_info.effective_samp_rate >= 5000000)
-    st_params.window_size = 65536;
-  else if (new->source_info.effective_samp_rate >= 1600000)
-    st_params.window_size = 16384;
-  else if (new->source_info.effective_samp_rate >= 250000)
-    st_params.window_size = 4096;
-  else
-    st_params.window_size = 2048;
+  st_params.window_size = suscan_local_analyzer_initial_tuner_window(new);
 
   /* Initialize buffer pools */
   bp_params.alloc_size     = st_params.window_size;
@@ -549,6 +770,12 @@ suscan_local_analyzer_ctor(suscan_analyzer_t *parent, va_list ap)
     SU_TRY_FAIL(suscan_local_analyzer_register_factory());
 
   SU_MAKE_FAIL(new->insp_factory, suscan_inspector_factory, "local-analyzer", new);
+
+  if (parent->params.corr_update_rate > 0)
+    SU_TRY_FAIL(
+      suscan_inspector_factory_set_correction_rate(
+        new->insp_factory,
+        parent->params.corr_update_rate));
   
   SU_CONSTRUCT_FAIL(suscan_inspector_request_manager, &new->insp_reqmgr);
 
@@ -619,6 +846,7 @@ SUPRIVATE void
 suscan_local_analyzer_dtor(void *ptr)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  unsigned int i;
 
   /* Prevent source from entering in timeout loops */
   if (self->source != NULL)
@@ -639,12 +867,37 @@ suscan_local_analyzer_dtor(void *ptr)
       return;
     }
 
+  /* PSD messages read the channelizer timings under the pipeline mutex */
+  if (self->psd_worker != NULL) {
+    if (!suscan_analyzer_halt_worker(self->psd_worker)) {
+      SU_ERROR("Failed to destroy PSD worker.\n");
+
+      /* Mark smoothPSD and statistics objects as released */
+      self->smooth_psd = NULL;
+      self->spectstats = NULL;
+    }
+  }
+
+  /* Channelizer stage of the pipelined mode, fed by the source worker */
+  suscan_local_analyzer_destroy_pipeline(self);
+
+  /* Same for the FFT stage of the wide sweep */
+  suscan_local_analyzer_destroy_sweep(self);
+
   if (self->slow_wk != NULL)
     if (!suscan_analyzer_halt_worker(self->slow_wk)) {
       SU_ERROR("Slow worker destruction failed, memory leak ahead\n");
       return;
     }
 
+  /* No more buffers will be queued, stop asynchronous baseband filters */
+  for (i = 0; i < self->async_bbfilt_count; ++i)
+    if (self->async_bbfilt_list[i] != NULL)
+      suscan_local_analyzer_async_bbfilt_destroy(self->async_bbfilt_list[i]);
+
+  if (self->async_bbfilt_list != NULL)
+    free(self->async_bbfilt_list);
+
   /* Stop capture source, now that workers using it have stopped */
   if (self->source != NULL && suscan_source_is_capturing(self->source))
     suscan_source_stop_capture(self->source);
@@ -656,21 +909,18 @@ suscan_local_analyzer_dtor(void *ptr)
   if (self->detector != NULL)
     su_channel_detector_destroy(self->detector);
 
-  if (self->psd_worker != NULL) {
-    if (!suscan_analyzer_halt_worker(self->psd_worker)) {
-      SU_ERROR("Failed to destroy PSD worker.\n");
-
-      /* Mark smoothPSD object as released */
-      self->smooth_psd = NULL;
-    }
-  }
-
   if (self->smooth_psd != NULL)
     su_smoothpsd_destroy(self->smooth_psd);
 
+  if (self->spectstats != NULL)
+    suscan_spectstats_destroy(self->spectstats);
+
   if (self->loop_init)
     pthread_mutex_destroy(&self->loop_mutex);
 
+  if (self->psd_stats_init)
+    pthread_mutex_destroy(&self->psd_stats_mutex);
+
   /* Deinitialize request manager */
   suscan_inspector_request_manager_finalize(&self->insp_reqmgr);
 
@@ -714,9 +964,15 @@ suscan_local_analyzer_dtor(void *ptr)
   /* Consume any pending messages */
   suscan_analyzer_consume_mq(&self->mq_in);
 
+  /* Pools left behind by tuner re-plans */
+  suscan_local_analyzer_destroy_retired_pools(self, SU_TRUE);
+
   /* Finalize buffers */
   if (self->bufpool != NULL)
     suscan_sample_buffer_pool_destroy(self->bufpool);
+
+  if (self->async_bbfilt_pool != NULL)
+    suscan_sample_buffer_pool_destroy(self->async_bbfilt_pool);
   
   /* Finalize queue */
   suscan_mq_finalize(&self->mq_in);
@@ -1061,6 +1317,49 @@ fail:
   return SU_FALSE;
 }
 
+SUPRIVATE SUBOOL
+suscan_local_analyzer_register_async_baseband_filter(
+    void *ptr,
+    suscan_analyzer_baseband_filter_func_t func,
+    void *privdata,
+    unsigned int max_lag)
+{
+  struct suscan_local_analyzer_async_bbfilt *new = NULL;
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) ptr;
+  SUBOOL mutex_acquired = SU_FALSE;
+
+  SU_TRYCATCH(
+      self->parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL,
+      goto fail);
+
+  SU_TRY_FAIL(
+    new = suscan_local_analyzer_async_bbfilt_new(
+      self,
+      func,
+      privdata,
+      max_lag));
+
+  /* The source worker walks this list on every read */
+  SU_TRY_FAIL(suscan_local_analyzer_lock_loop(self));
+  mutex_acquired = SU_TRUE;
+
+  SU_TRYC_FAIL(PTR_LIST_APPEND_CHECK(self->async_bbfilt, new));
+  self->async_bbfilt_lag += new->max_lag;
+
+  suscan_local_analyzer_unlock_loop(self);
+
+  return SU_TRUE;
+
+fail:
+  if (mutex_acquired)
+    suscan_local_analyzer_unlock_loop(self);
+
+  if (new != NULL)
+    suscan_local_analyzer_async_bbfilt_destroy(new);
+
+  return SU_FALSE;
+}
+
 /* Fast methods */
 SUPRIVATE SUBOOL
 suscan_local_analyzer_set_inspector_frequency(
@@ -1141,6 +1440,7 @@ suscan_local_analyzer_get_interface(void)
     SET_CALLBACK(set_history_size);
     SET_CALLBACK(replay);
     SET_CALLBACK(register_baseband_filter);
+    SET_CALLBACK(register_async_baseband_filter);
     SET_CALLBACK(get_measured_samp_rate);
     SET_CALLBACK(get_source_info_pointer);
     SET_CALLBACK(commit_source_info);
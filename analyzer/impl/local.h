@@ -21,20 +21,100 @@
 #define _SUSCAN_ANALYZER_IMPL_LOCAL_H
 
 #include <analyzer/analyzer.h>
+#include <analyzer/msg.h>
 #include <sigutils/smoothpsd.h>
 #include <analyzer/inspector/factory.h>
 #include <analyzer/inspector/overridable.h>
 #include <analyzer/pool.h>
+#include <analyzer/psdsched.h>
+#include <analyzer/spectstats.h>
 
 #include <rbtree.h>
 
 #define SUSCAN_LOCAL_ANALYZER_MIN_RADIO_FREQ -3e11
 #define SUSCAN_LOCAL_ANALYZER_MAX_RADIO_FREQ +3e11
 
+/* Adaptive spectral tuner window */
+#define SUSCAN_LOCAL_ANALYZER_TUNER_WINDOW_ENV    "SUSCAN_TUNER_WINDOW"
+#define SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW    1024
+#define SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW    262144
+#define SUSCAN_LOCAL_ANALYZER_TUNER_MIN_CHAN_BINS 32
+#define SUSCAN_LOCAL_ANALYZER_TUNER_MAX_CHAN_BINS 4096
+#define SUSCAN_LOCAL_ANALYZER_TUNER_CPU_LOW       .25
+#define SUSCAN_LOCAL_ANALYZER_TUNER_CPU_HIGH      .75
+
+/* Internal message: re-plan the tuner window after closing a channel */
+#define SUSCAN_LOCAL_ANALYZER_MESSAGE_TYPE_REPLAN 0x8000001
+
+/* Pipelined circular channelizer */
+#define SUSCAN_LOCAL_ANALYZER_PIPELINE_MIN_RATE   10000000
+#define SUSCAN_LOCAL_ANALYZER_PIPELINE_BUFFERS    2
+#define SUSCAN_LOCAL_ANALYZER_TIMING_ALPHA        .05
+
+/* Pipelined wide sweep */
+#define SUSCAN_LOCAL_ANALYZER_SWEEP_BUFFERS       2
+#define SUSCAN_LOCAL_ANALYZER_SWEEP_RATE_ALPHA    .25
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
 
+struct suscan_local_analyzer;
+
+/*
+ * Asynchronous baseband filters: the source worker copies the samples
+ * once into a buffer of a pool of their own, and places references to it
+ * in the bounded ring of each filter, consumed by a dedicated worker.
+ * Lagging filters never hold buffers of the channelizer pool.
+ */
+struct suscan_local_analyzer_bbfilt_job {
+  suscan_sample_buffer_t *buffer;
+  SUSCOUNT length;
+  SUSCOUNT consumed;
+};
+
+struct suscan_local_analyzer_async_bbfilt {
+  struct suscan_local_analyzer *owner;
+  struct suscan_analyzer_baseband_filter filter;
+
+  suscan_worker_t *worker;
+  struct suscan_mq mq_out;
+  SUBOOL           mq_init;
+
+  pthread_mutex_t  mutex;
+  SUBOOL           mutex_init;
+
+  struct suscan_local_analyzer_bbfilt_job *queue;
+  unsigned int     max_lag;
+  unsigned int     head;
+  unsigned int     tail;
+  unsigned int     pending;
+
+  /* Statistics */
+  SUSCOUNT         delivered;
+  SUSCOUNT         dropped;
+  SUSCOUNT         dropped_samples;
+  SUBOOL           failed; /* Under mutex */
+};
+
+/*
+ * Wide sweep captures: the source worker fills one with the samples of
+ * the current hop, hands it to the sweep worker and hops right away.
+ */
+struct suscan_local_analyzer_sweep_job {
+  SUCOMPLEX     *samples;
+  SUSCOUNT       alloc;     /* Allocated samples */
+  SUSCOUNT       fill;      /* Samples captured so far */
+  SUSCOUNT       length;    /* Samples handed to the sweep worker */
+  SUFREQ         fc;        /* Center frequency of the capture */
+  SUFREQ         min_freq;  /* Sweep span at capture time */
+  SUFREQ         max_freq;
+  SUFLOAT        rel_bw;
+  SUSCOUNT       panorama_bins; /* 0: send the PSD of the hop as is */
+  struct timeval timestamp; /* Source time of the capture */
+  SUBOOL         busy;      /* Owned by the sweep worker */
+};
+
 #define SULIMPL(analyzer) ((suscan_local_analyzer_t *) ((analyzer)->impl))
 #define SUSCAN_LOCAL_ANALYZER_AS_ANALYZER(local) ((local)->parent)
 
@@ -54,7 +134,8 @@ struct suscan_local_analyzer {
   SUBOOL   iq_rev;
   
   /* Periodic updates */
-  struct sigutils_smoothpsd_params sp_params;
+  struct sigutils_smoothpsd_params sp_params; /* As requested */
+  SUSCOUNT psd_averaging;
   SUFLOAT  interval_channels;
   SUFLOAT  interval_psd;
   SUSCOUNT det_count;
@@ -116,6 +197,21 @@ struct suscan_local_analyzer {
   suscan_sample_buffer_pool_t *bufpool; /* Sample buffer pool */
   su_channel_detector_t *detector; /* Channel detector */
   su_smoothpsd_t  *smooth_psd;
+  suscan_psd_sched_t psd_sched; /* Protected by loop_mutex */
+
+  /* Counters of psd_sched, published for PSD messages */
+  pthread_mutex_t psd_stats_mutex;
+  SUBOOL psd_stats_init;
+  struct suscan_analyzer_psd_sched_stats psd_stats;
+
+  /* Spectral statistics, owned by the PSD worker */
+  suscan_spectstats_t *spectstats;
+  struct suscan_spectstats_params stats_params;
+  struct timeval stats_last;
+
+  /* Protected by hotconf_mutex */
+  struct suscan_spectstats_params stats_params_req;
+  SUBOOL stats_params_pending;
   suscan_worker_t *psd_worker;
   suscan_worker_t *source_wk; /* Used by one source only */
   suscan_worker_t *slow_wk; /* Worker for slow operations */
@@ -123,6 +219,9 @@ struct suscan_local_analyzer {
   SUSCOUNT   read_size;
 
   rbtree_t *bbfilt_tree;
+  PTR_LIST(struct suscan_local_analyzer_async_bbfilt, async_bbfilt);
+  unsigned int                 async_bbfilt_lag; /* Sum of max_lag */
+  suscan_sample_buffer_pool_t *async_bbfilt_pool;
 
   /* Spectral tuner */
   su_specttuner_t        *stuner;
@@ -131,15 +230,66 @@ struct suscan_local_analyzer {
   suscan_sample_buffer_t *circbuf;
   SUBOOL                  circularity;
   SUBOOL                  circ_state;
+  SUBOOL                  stuner_auto; /* Adapt window to channels */
+
+  /* Pipelined channelizer (circular mode, fast sources) */
+  SUBOOL                  pipelined;
+  suscan_worker_t        *pipe_wk;
+  struct suscan_mq        pipe_mq;
+  SUBOOL                  pipe_mq_init;
+  pthread_mutex_t         pipe_mutex;
+  pthread_cond_t          pipe_cond;
+  SUBOOL                  pipe_mutex_init;
+  SUBOOL                  pipe_cond_init;
+  SUBOOL                  pipe_busy;
+  SUBOOL                  pipe_failed;
+  suscan_sample_buffer_t *pipe_buf[SUSCAN_LOCAL_ANALYZER_PIPELINE_BUFFERS];
+  unsigned int            pipe_ndx;
+  SUBOOL                  pipe_job_state;
+  const SUCOMPLEX        *pipe_last_data;   /* Last half read */
+  SUSCOUNT                pipe_last_offset;
+  SUSCOUNT                pipe_last_size;
+  struct suscan_analyzer_channelizer_timings timings; /* Under pipe_mutex */
+
+  /* Circular pools replaced by a tuner re-plan, still referenced */
+  PTR_LIST(suscan_sample_buffer_pool_t, retired_pool);
 
   /* Wide sweep parameters */
   SUBOOL sweep_params_requested;
   struct suscan_analyzer_sweep_params current_sweep_params;
   struct suscan_analyzer_sweep_params pending_sweep_params;
   SUFREQ   curr_freq;
-  SUSCOUNT part_ndx;
-  SUSCOUNT fft_samples; /* Number of FFT frames */
-  SUSCOUNT hop_samples;
+  SUSCOUNT fft_samples; /* Samples since last hop */
+  SUSCOUNT hop_samples; /* Settle samples of the current hop */
+  uint64_t hop_seed;
+  struct suscan_hopplan *hopplan;
+
+  /* Pipelined wide sweep */
+  suscan_worker_t        *sweep_wk;
+  struct suscan_mq        sweep_mq;
+  SUBOOL                  sweep_mq_init;
+  pthread_mutex_t         sweep_mutex;
+  pthread_cond_t          sweep_cond;
+  SUBOOL                  sweep_mutex_init;
+  SUBOOL                  sweep_cond_init;
+  SUBOOL                  sweep_failed;
+  struct suscan_local_analyzer_sweep_job
+                          sweep_job[SUSCAN_LOCAL_ANALYZER_SWEEP_BUFFERS];
+  unsigned int            sweep_ndx;
+  SUFREQ                  sweep_span;         /* Swept since last measure */
+  uint64_t                sweep_last_measure;
+  SUFLOAT                 sweep_rate;         /* Hz/s, under sweep_mutex */
+  struct suscan_panorama *panorama;           /* Sweep worker only */
+  uint64_t                panorama_last;      /* Last panorama update */
+
+  /* Offline sweeps (non real time sources): hops are recording segments */
+  SUBOOL                  sweep_offline;
+  struct suscan_source_segment whole_recording; /* If there are no segments */
+  const struct suscan_source_segment *segment_list;
+  unsigned int            segment_count;
+  unsigned int            segment_ndx;        /* Next segment to sweep */
+  SUSCOUNT                segment_left;       /* Samples left to read */
+  SUSCOUNT                segment_settle;     /* Samples to skip first */
 
   suscan_inspector_factory_t         *insp_factory;
   suscan_inspector_request_manager_t  insp_reqmgr;
@@ -159,6 +309,44 @@ typedef struct suscan_local_analyzer suscan_local_analyzer_t;
 /* Internal */
 SUBOOL suscan_local_analyzer_register_factory(void);
 
+/* Internal */
+SUSCOUNT suscan_local_analyzer_initial_tuner_window(
+  suscan_local_analyzer_t *self);
+
+/* Internal */
+void suscan_local_analyzer_adapt_tuner_window(
+  suscan_local_analyzer_t *self,
+  const struct sigutils_channel *chan_info);
+
+/* Internal */
+SUBOOL suscan_local_analyzer_drain_pipeline(suscan_local_analyzer_t *self);
+
+/* Internal */
+void suscan_local_analyzer_destroy_pipeline(suscan_local_analyzer_t *self);
+
+/* Internal */
+SUBOOL suscan_local_analyzer_drain_sweep(suscan_local_analyzer_t *self);
+
+/* Internal */
+void suscan_local_analyzer_destroy_sweep(suscan_local_analyzer_t *self);
+
+/* Internal */
+void suscan_local_analyzer_destroy_retired_pools(
+  suscan_local_analyzer_t *self,
+  SUBOOL force);
+
+/* Internal */
+SUBOOL suscan_local_analyzer_async_bbfilt_push(
+  struct suscan_local_analyzer_async_bbfilt *self,
+  suscan_sample_buffer_t *buffer,
+  SUSCOUNT length,
+  SUSCOUNT consumed);
+
+/* Internal */
+void suscan_local_analyzer_async_bbfilt_drop(
+  struct suscan_local_analyzer_async_bbfilt *self,
+  SUSCOUNT length);
+
 /* Internal */
 SUBOOL suscan_local_analyzer_is_real_time_ex(const suscan_local_analyzer_t *self);
 
@@ -631,6 +631,7 @@ suscan_analyzer_remote_call_deliver_message(
 {
   uint32_t type = 0;
   struct suscan_analyzer_psd_msg *psd_msg;
+  struct suscan_analyzer_panorama_msg *panorama_msg;
   struct suscan_source_info *as_source_info;
   uint64_t old_permissions = analyzer->source_info.permissions;
 
@@ -665,6 +666,11 @@ suscan_analyzer_remote_call_deliver_message(
       psd_msg = priv;
       analyzer->source_info.source_time = psd_msg->timestamp;
       break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA:
+      panorama_msg = priv;
+      analyzer->source_info.source_time = panorama_msg->timestamp;
+      break;
   }
   
   SU_TRYCATCH(
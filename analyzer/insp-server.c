@@ -353,11 +353,15 @@ DEF_MSGCB(ESTIMATOR)
   if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
     goto done;
   
-  if (msg->estimator_id < insp->estimator_count)
+  if (msg->estimator_id < insp->estimator_count) {
     suscan_estimator_set_enabled(
       insp->estimator_list[msg->estimator_id],
       msg->enabled);
-  else
+
+    /* Enabling an estimator also asks for a fresh estimate */
+    if (msg->enabled)
+      suscan_inspector_request_estimates(insp);
+  } else
     msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_OBJECT;
   
 done:
@@ -367,6 +371,44 @@ done:
   return SU_TRUE;
 }
 
+DEF_MSGCB(SET_ESTIMATOR_SCHEDULE)
+{
+  suscan_inspector_t *insp = NULL;
+
+  if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
+    goto done;
+
+  if (msg->estimator_interval < 0)
+    msg->kind = SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_ARGUMENT;
+  else
+    suscan_inspector_set_estimator_schedule(
+      insp,
+      msg->estimator_interval,
+      msg->estimator_window);
+
+done:
+  if (insp != NULL)
+    suscan_local_analyzer_return_inspector(self, insp);
+
+  return SU_TRUE;
+}
+
+DEF_MSGCB(REQUEST_ESTIMATES)
+{
+  suscan_inspector_t *insp = NULL;
+
+  if ((insp = suscan_local_analyzer_insp_from_msg(self, msg)) == NULL)
+    goto done;
+
+  suscan_inspector_request_estimates(insp);
+
+done:
+  if (insp != NULL)
+    suscan_local_analyzer_return_inspector(self, insp);
+
+  return SU_TRUE;
+}
+
 DEF_MSGCB(SPECTRUM)
 {
   suscan_inspector_t *insp = NULL;
@@ -711,6 +753,8 @@ suscan_insp_server_init(void)
   INIT_MSGCB(OPEN);
   INIT_MSGCB(SET_ID);
   INIT_MSGCB(ESTIMATOR);
+  INIT_MSGCB(SET_ESTIMATOR_SCHEDULE);
+  INIT_MSGCB(REQUEST_ESTIMATES);
   INIT_MSGCB(SPECTRUM);
   INIT_MSGCB(GET_CONFIG);
   INIT_MSGCB(SET_CONFIG);
@@ -22,6 +22,7 @@
 #include "factory.h"
 
 #include <sigutils/sigutils.h>
+#include <sigutils/util/compat-time.h>
 
 PTR_LIST(
   const struct suscan_inspector_factory_class,
@@ -65,11 +66,144 @@ suscan_inspector_factory_cleanup_unsafe(suscan_inspector_factory_t *self)
     }
 }
 
+/************************ Frequency correction service ***********************/
+SUPRIVATE void
+suscan_inspector_factory_update_correction_models(
+  suscan_inspector_factory_t *self,
+  SUFLOAT horizon)
+{
+  unsigned int i;
+  suscan_inspector_t *insp;
+
+  if (pthread_mutex_lock(&self->inspector_list_mutex) != 0)
+    return;
+
+  for (i = 0; i < self->inspector_count; ++i) {
+    insp = self->inspector_list[i];
+    if (insp != NULL && insp->state == SUSCAN_ASYNC_STATE_RUNNING)
+      if (!suscan_inspector_update_correction(insp, horizon))
+        SU_WARNING("Failed to update frequency correction of inspector\n");
+  }
+
+  (void) pthread_mutex_unlock(&self->inspector_list_mutex);
+}
+
+SUPRIVATE void *
+suscan_inspector_factory_correction_thread(void *data)
+{
+  suscan_inspector_factory_t *self = (suscan_inspector_factory_t *) data;
+  struct timespec deadline;
+  SUFLOAT period;
+
+  (void) pthread_mutex_lock(&self->corr_mutex);
+
+  while (!self->corr_halt) {
+    period = 1. / self->corr_rate;
+    (void) pthread_mutex_unlock(&self->corr_mutex);
+
+    suscan_inspector_factory_update_correction_models(self, period);
+
+    (void) pthread_mutex_lock(&self->corr_mutex);
+
+    if (!self->corr_halt) {
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_sec  += (time_t) period;
+      deadline.tv_nsec += (period - (time_t) period) * 1e9;
+      if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_nsec -= 1000000000;
+        ++deadline.tv_sec;
+      }
+
+      (void) pthread_cond_timedwait(
+        &self->corr_cond,
+        &self->corr_mutex,
+        &deadline);
+    }
+  }
+
+  (void) pthread_mutex_unlock(&self->corr_mutex);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_inspector_factory_wake_correction_service(
+  suscan_inspector_factory_t *self)
+{
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->corr_mutex));
+  mutex_acquired = SU_TRUE;
+
+  if (!self->corr_running) {
+    SU_TRYZ(
+      pthread_create(
+        &self->corr_thread,
+        NULL,
+        suscan_inspector_factory_correction_thread,
+        self));
+    self->corr_running = SU_TRUE;
+  } else {
+    pthread_cond_signal(&self->corr_cond);
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->corr_mutex);
+
+  return ok;
+}
+
+SUBOOL
+suscan_inspector_factory_set_correction_rate(
+  suscan_inspector_factory_t *self,
+  SUFLOAT rate)
+{
+  SUBOOL ok = SU_FALSE;
+
+  if (rate <= 0) {
+    SU_ERROR("Invalid frequency correction rate %g\n", rate);
+    goto done;
+  }
+
+  SU_TRYZ(pthread_mutex_lock(&self->corr_mutex));
+  self->corr_rate = rate;
+  pthread_cond_signal(&self->corr_cond);
+  (void) pthread_mutex_unlock(&self->corr_mutex);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void
+suscan_inspector_factory_stop_correction_service(
+  suscan_inspector_factory_t *self)
+{
+  if (!self->corr_running)
+    return;
+
+  (void) pthread_mutex_lock(&self->corr_mutex);
+  self->corr_halt = SU_TRUE;
+  pthread_cond_signal(&self->corr_cond);
+  (void) pthread_mutex_unlock(&self->corr_mutex);
+
+  pthread_join(self->corr_thread, NULL);
+  self->corr_running = SU_FALSE;
+}
+
 void
 suscan_inspector_factory_destroy(suscan_inspector_factory_t *self)
 {
   unsigned int i;
 
+  /* No inspector can be touched by the service from now on */
+  suscan_inspector_factory_stop_correction_service(self);
+
   suscan_inspector_factory_cleanup_unsafe(self);
 
   for (i = 0; i < self->inspector_count; ++i)
@@ -100,6 +234,12 @@ suscan_inspector_factory_destroy(suscan_inspector_factory_t *self)
   if (self->inspector_list_init)
     pthread_mutex_destroy(&self->inspector_list_mutex);
 
+  if (self->corr_cond_init)
+    pthread_cond_destroy(&self->corr_cond);
+
+  if (self->corr_mutex_init)
+    pthread_mutex_destroy(&self->corr_mutex);
+
   free(self);
 }
 
@@ -142,7 +282,18 @@ suscan_inspector_factory_new(const char *name, ...)
 
   new->inspector_list_init = SU_TRUE;
 
-  SU_MAKE(new->sched, suscan_inspsched, new->mq_ctl);
+  SU_TRYZ(pthread_mutex_init(&new->corr_mutex, NULL));
+  new->corr_mutex_init = SU_TRUE;
+
+  SU_TRYZ(pthread_cond_init(&new->corr_cond, NULL));
+  new->corr_cond_init = SU_TRUE;
+
+  new->corr_rate = SUSCAN_INSPECTOR_FACTORY_CORRECTION_RATE_DEFAULT;
+
+  SU_TRY(
+    new->sched = suscan_inspsched_new_ex(
+      new->mq_ctl,
+      new->iface->batched));
 
   ok = SU_TRUE;
 
@@ -170,14 +321,21 @@ suscan_inspector_factory_update_frequency_corrections(
   suscan_inspector_factory_get_time(self, &source_time);
   freq = suscan_inspector_factory_get_inspector_freq(self, insp);
 
-  if (suscan_inspector_get_correction(insp, &source_time, freq, &delta_f))
+  /* 
+   * Correctors are evaluated by the correction service. Here we just tell
+   * it where we are, and interpolate its latest model. Nothing in here
+   * waits for the corrector.
+   */
+  (void) suscan_inspector_post_correction_request(insp, &source_time, freq);
+
+  if (suscan_inspector_get_interpolated_correction(
+    insp,
+    &source_time,
+    &delta_f))
     suscan_inspector_factory_set_inspector_freq_correction(
       self, 
       insp,
       delta_f);
-
-  /* Deliver pending report */
-  (void) suscan_inspector_deliver_report(insp, &source_time, freq);
 }
 
 /*
@@ -209,10 +367,33 @@ suscan_inspector_factory_feed(
   /* Step 1: update frequency corrections for this inspector */
   suscan_inspector_factory_update_frequency_corrections(self, insp);
 
-  /* Step 2: allocate task info and queue task */
+  /* 
+   * Step 2: direct-feed inspectors (e.g. power meters) do so little work
+   * per sample that queuing a task costs more than running their sampler
+   * here, in the channelizer thread. Estimators and spectrum sources are
+   * a different story, and are left to the workers as an analysis task,
+   * queued only when there is something to analyze. Channel data stays
+   * valid until the next sync, so both halves can share it.
+   */
+  if (insp->iface->direct_feed) {
+    if (!suscan_inspector_sampler_loop(insp, data, size)) {
+      insp->state = SUSCAN_ASYNC_STATE_HALTING;
+      ok = SU_TRUE;
+      goto done;
+    }
+
+    if (!suscan_inspector_wants_analysis(insp)) {
+      ok = SU_TRUE;
+      goto done;
+    }
+  }
+
+  /* Step 3: allocate task info and queue task */
   SU_TRY(info = suscan_inspsched_acquire_task_info(self->sched, insp));
 
-  info->type         = SUSCAN_INSPECTOR_TASK_INFO_TYPE_SAMPLES;
+  info->type         = insp->iface->direct_feed
+    ? SUSCAN_INSPECTOR_TASK_INFO_TYPE_ANALYSIS
+    : SUSCAN_INSPECTOR_TASK_INFO_TYPE_SAMPLES;
   info->samples.data = data;
   info->samples.size = size;
   info->inspector    = insp;
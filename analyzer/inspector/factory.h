@@ -32,6 +32,9 @@ extern "C" {
 
 #define SUSCAN_INSPECTOR_FACTORY_TRUE_BW_SIGNAL "insp.true_bw"
 
+/* Frequency correction updates per second (correction service) */
+#define SUSCAN_INSPECTOR_FACTORY_CORRECTION_RATE_DEFAULT 10.
+
 struct suscan_inspector_factory;
 
 /* TODO: Use hashtables */
@@ -76,6 +79,12 @@ struct suscan_inspector_factory_class {
   /* Set underlying tuner frequency (optional) */
   SUBOOL (*set_tuner_freq) (void *, SUFREQ);
 
+  /* 
+   * Run inspectors in the thread that feeds them, deferring their tasks
+   * to the next sync (intended for nested tuners).
+   */
+  SUBOOL batched;
+
   void (*dtor)(void *);
 };
 
@@ -100,6 +109,16 @@ struct suscan_inspector_factory {
   SUBOOL              inspector_list_init;
   
   suscan_inspsched_t *sched;   /* Inspector scheduler */
+
+  /* Frequency correction service, started on demand */
+  pthread_t           corr_thread;
+  pthread_mutex_t     corr_mutex;
+  pthread_cond_t      corr_cond;
+  SUBOOL              corr_mutex_init;
+  SUBOOL              corr_cond_init;
+  SUBOOL              corr_running;
+  SUBOOL              corr_halt;
+  SUFLOAT             corr_rate;
 };
 
 typedef struct suscan_inspector_factory suscan_inspector_factory_t;
@@ -236,6 +255,15 @@ SUBOOL suscan_inspector_factory_notify_freq(
 
 SUBOOL suscan_inspector_factory_force_sync(suscan_inspector_factory_t *self);
 
+/* Updates per second of the frequency correction models */
+SUBOOL suscan_inspector_factory_set_correction_rate(
+  suscan_inspector_factory_t *self,
+  SUFLOAT rate);
+
+/* Start (if needed) and trigger an update of the correction service */
+SUBOOL suscan_inspector_factory_wake_correction_service(
+  suscan_inspector_factory_t *self);
+
 SUBOOL suscan_inspector_factory_halt_inspector(
   suscan_inspector_factory_t *self,
   suscan_inspector_t *insp);
@@ -0,0 +1,197 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "fastconv"
+
+#include <string.h>
+#include <sigutils/sigutils.h>
+
+#include "fastconv.h"
+#include "src/fftplan.h"
+
+void
+suscan_fastconv_reset(suscan_fastconv_t *self)
+{
+  if (self->taps > 1)
+    memset(self->hist, 0, (self->taps - 1) * sizeof(SUCOMPLEX));
+}
+
+suscan_fastconv_t *
+suscan_fastconv_new(const SUFLOAT *h, SUSCOUNT taps, SUSCOUNT max_block)
+{
+  suscan_fastconv_t *new = NULL;
+  SU_FFTW(_plan) plan = NULL;
+  SUSCOUNT i;
+  SUBOOL locked = SU_FALSE;
+
+  SU_TRYCATCH(taps > 0, goto fail);
+  SU_TRYCATCH(max_block > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_fastconv_t);
+
+  new->taps = taps;
+  new->size = 1;
+  while (new->size < taps + max_block - 1)
+    new->size <<= 1;
+
+  new->max_block = new->size - taps + 1;
+
+  SU_ALLOCATE_MANY_FAIL(new->hist, taps, SUCOMPLEX);
+  SU_ALLOCATE_MANY_FAIL(new->resp, new->size, SUCOMPLEX);
+  SU_TRYCATCH(
+      new->buf = SU_FFTW(_malloc)(new->size * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      plan = SU_FFTW(_plan_dft_1d)(
+          new->size,
+          (SU_FFTW(_complex) *) new->resp,
+          (SU_FFTW(_complex) *) new->resp,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  SU_TRYCATCH(
+      new->fwd = SU_FFTW(_plan_dft_1d)(
+          new->size,
+          (SU_FFTW(_complex) *) new->buf,
+          (SU_FFTW(_complex) *) new->buf,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  SU_TRYCATCH(
+      new->inv = SU_FFTW(_plan_dft_1d)(
+          new->size,
+          (SU_FFTW(_complex) *) new->buf,
+          (SU_FFTW(_complex) *) new->buf,
+          FFTW_BACKWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  /* Frequency response of the zero-padded taps, normalized for the IFFT */
+  for (i = 0; i < taps; ++i)
+    new->resp[i] = h[i];
+
+  SU_FFTW(_execute)(plan);
+
+  for (i = 0; i < new->size; ++i)
+    new->resp[i] /= new->size;
+
+  SU_FFTW(_destroy_plan)(plan);
+  plan = NULL;
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  suscan_fastconv_reset(new);
+
+  return new;
+
+fail:
+  if (plan != NULL)
+    SU_FFTW(_destroy_plan)(plan);
+
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_fastconv_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_fastconv_feed_block(
+    suscan_fastconv_t *self,
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUSCOUNT hlen = self->taps - 1;
+
+  /* Previous M - 1 samples, then the block, zero-padded */
+  memcpy(self->buf, self->hist, hlen * sizeof(SUCOMPLEX));
+  memcpy(self->buf + hlen, x, len * sizeof(SUCOMPLEX));
+  memset(
+      self->buf + hlen + len,
+      0,
+      (self->size - hlen - len) * sizeof(SUCOMPLEX));
+
+  memcpy(self->hist, self->buf + len, hlen * sizeof(SUCOMPLEX));
+
+  SU_FFTW(_execute)(self->fwd);
+
+  for (i = 0; i < self->size; ++i)
+    self->buf[i] *= self->resp[i];
+
+  SU_FFTW(_execute)(self->inv);
+
+  /* The first M - 1 outputs are wrapped around, discard them */
+  memcpy(y, self->buf + hlen, len * sizeof(SUCOMPLEX));
+}
+
+void
+suscan_fastconv_feed(
+    suscan_fastconv_t *self,
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT chunk;
+
+  while (len > 0) {
+    chunk = SU_MIN(len, self->max_block);
+
+    suscan_fastconv_feed_block(self, x, y, chunk);
+
+    x   += chunk;
+    y   += chunk;
+    len -= chunk;
+  }
+}
+
+void
+suscan_fastconv_destroy(suscan_fastconv_t *self)
+{
+  (void) suscan_fft_planner_lock();
+
+  if (self->fwd != NULL)
+    SU_FFTW(_destroy_plan)(self->fwd);
+
+  if (self->inv != NULL)
+    SU_FFTW(_destroy_plan)(self->inv);
+
+  suscan_fft_planner_unlock();
+
+  if (self->buf != NULL)
+    SU_FFTW(_free)(self->buf);
+
+  if (self->resp != NULL)
+    free(self->resp);
+
+  if (self->hist != NULL)
+    free(self->hist);
+
+  free(self);
+}
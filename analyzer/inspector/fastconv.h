@@ -0,0 +1,77 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _INSPECTOR_FASTCONV_H
+#define _INSPECTOR_FASTCONV_H
+
+#include <sigutils/sigutils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * FIR filter evaluated with FFTs (overlap-save). Blocks of up to
+ * max_block samples are filtered with one forward and one inverse FFT,
+ * with no added latency: the output is that of the direct-form filter
+ * with the same taps, within floating point tolerance. Worth it for
+ * long filters only.
+ */
+struct suscan_fastconv {
+  SUSCOUNT taps;      /* Filter length (M) */
+  SUSCOUNT size;      /* FFT size (N) */
+  SUSCOUNT max_block; /* N - M + 1 */
+
+  SUCOMPLEX *hist;    /* Last M - 1 input samples */
+  SUCOMPLEX *resp;    /* Frequency response, scaled by 1 / N */
+  SUCOMPLEX *buf;     /* FFT buffer (in place) */
+
+  SU_FFTW(_plan) fwd;
+  SU_FFTW(_plan) inv;
+};
+
+typedef struct suscan_fastconv suscan_fastconv_t;
+
+SUINLINE SUSCOUNT
+suscan_fastconv_get_taps(const suscan_fastconv_t *self)
+{
+  return self->taps;
+}
+
+suscan_fastconv_t *suscan_fastconv_new(
+    const SUFLOAT *h,
+    SUSCOUNT taps,
+    SUSCOUNT max_block);
+
+void suscan_fastconv_reset(suscan_fastconv_t *self);
+
+/* Filter len samples of x into y. In-place operation (x == y) is allowed */
+void suscan_fastconv_feed(
+    suscan_fastconv_t *self,
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len);
+
+void suscan_fastconv_destroy(suscan_fastconv_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _INSPECTOR_FASTCONV_H */
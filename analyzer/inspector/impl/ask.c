@@ -38,6 +38,9 @@
 #define SUSCAN_ASK_INSPECTOR_DEFAULT_EQ_MU     1e-3
 #define SUSCAN_ASK_INSPECTOR_DEFAULT_EQ_LENGTH 20
 #define SUSCAN_ASK_INSPECTOR_MAX_MF_SPAN       1024
+#define SUSCAN_ASK_INSPECTOR_BLOCK_SIZE        1024
+#define SUSCAN_ASK_INSPECTOR_ENVELOPE_AGC_SYMS 32
+#define SUSCAN_ASK_INSPECTOR_ENVELOPE_PLL_DECIM 16
 
 /*
  * Spike durations measured in symbol times
@@ -73,6 +76,21 @@ struct suscan_ask_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
   SUCOMPLEX           phase;      /* Local oscillator phase */
   SUCOMPLEX           last;       /* Last sample processed */
+
+  /* Envelope integrate-and-dump */
+  SUFLOAT             env_acc;    /* Envelope accumulated in this symbol */
+  SUSCOUNT            env_count;  /* Samples accumulated in this symbol */
+  SUFLOAT             env_phase;  /* Samples since last symbol boundary */
+  SUFLOAT             env_level;  /* Average symbol level (for AGC) */
+  SUFLOAT             env_alpha;  /* Single pole IIR coef for env_level */
+
+  /* Envelope carrier tracking, on the decimated carrier */
+  su_pll_t            env_pll;    /* PLL at fs / ENVELOPE_PLL_DECIM */
+  SUCOMPLEX           env_ref;    /* Carrier derotation for this chunk */
+  SUCOMPLEX           env_carrier;       /* Carrier accumulated ... */
+  SUSCOUNT            env_carrier_count; /* ... over this many samples */
+
+  SUCOMPLEX           block[SUSCAN_ASK_INSPECTOR_BLOCK_SIZE];
 };
 
 SUSCOUNT
@@ -124,6 +142,10 @@ suscan_ask_inspector_destroy(struct suscan_ask_inspector *insp)
 
   su_sampler_finalize(&insp->sampler);
 
+  su_pll_finalize(&insp->pll);
+
+  su_pll_finalize(&insp->env_pll);
+
   free(insp);
 }
 
@@ -168,9 +190,19 @@ suscan_ask_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
           SU_ABS2NORM_FREQ(sinfo->equiv_fs, new->cur_params.ask.cutoff)),
       goto fail);
 
+  SU_TRYCATCH(
+      su_pll_init(
+          &new->env_pll,
+          0,
+          SU_ABS2NORM_FREQ(
+            sinfo->equiv_fs / SUSCAN_ASK_INSPECTOR_ENVELOPE_PLL_DECIM,
+            new->cur_params.ask.cutoff)),
+      goto fail);
+
   /* Initialize local oscillator */
   su_ncqo_init(&new->lo, 0);
-  new->phase = 1.;
+  new->phase   = 1.;
+  new->env_ref = 1.;
 
   /* Initialize AGC */
   tau = 1. / bw; /* Samples per symbol */
@@ -187,6 +219,8 @@ suscan_ask_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
 
   SU_TRYCATCH(su_agc_init(&new->agc, &agc_params), goto fail);
 
+  new->env_alpha = SU_SPLPF_ALPHA(SUSCAN_ASK_INSPECTOR_ENVELOPE_AGC_SYMS);
+
   /* Initialize matched filter, with T = tau */
   SU_TRYCATCH(
       su_iir_rrc_init(
@@ -274,6 +308,7 @@ suscan_ask_inspector_commit_config(void *private)
   SUFLOAT actual_baud;
   SUFLOAT sym_period;
   su_pll_t new_pll;
+  su_pll_t new_env_pll;
   su_iir_filt_t mf = su_iir_filt_INITIALIZER;
   struct suscan_ask_inspector *insp = (struct suscan_ask_inspector *) private;
 
@@ -300,6 +335,17 @@ suscan_ask_inspector_commit_config(void *private)
     insp->pll = new_pll;
   }
 
+  if (pll_changed && su_pll_init(
+      &new_env_pll,
+      0,
+      SU_ABS2NORM_FREQ(
+        fs / SUSCAN_ASK_INSPECTOR_ENVELOPE_PLL_DECIM,
+        insp->cur_params.ask.cutoff))) {
+    su_pll_finalize(&insp->env_pll);
+    insp->env_pll = new_env_pll;
+    insp->env_ref = 1.;
+  }
+
   /* Update local oscillator */
   su_ncqo_set_freq(
       &insp->lo,
@@ -314,6 +360,11 @@ suscan_ask_inspector_commit_config(void *private)
   insp->cd.alpha = insp->cur_params.br.br_alpha;
   insp->cd.beta = insp->cur_params.br.br_beta;
 
+  /* Restart envelope integration at the requested symbol phase */
+  insp->env_acc   = 0;
+  insp->env_count = 0;
+  insp->env_phase = insp->cur_params.br.sym_phase * sym_period;
+
   /* Update matched filter */
   if (mf_changed && sym_period > 0) {
     if (!su_iir_rrc_init(
@@ -329,6 +380,185 @@ suscan_ask_inspector_commit_config(void *private)
   }
 }
 
+/************************* Envelope detection fast path **********************/
+/*
+ * OOK and most ASK channels only need the envelope. Its magnitude does not
+ * depend on the carrier phase, so mixing, PLL tracking and per-sample gain
+ * control are skipped altogether: the envelope is integrated over each
+ * symbol and dumped at the baud rate, and gain is applied to symbols.
+ * With automatic baudrate control, the envelope feeds the clock detector
+ * instead.
+ *
+ * If the PLL is enabled, the envelope is detected coherently: the carrier
+ * is averaged over chunks of ENVELOPE_PLL_DECIM samples and tracked by a
+ * PLL running at that decimated rate, and the envelope is the in-phase
+ * component of the derotated carrier. This avoids the noise bias of the
+ * magnitude at low SNR, for one PLL step per chunk.
+ */
+SUPRIVATE void
+suscan_ask_inspector_envelope_block(
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUFLOAT re, im;
+
+  for (i = 0; i < len; ++i) {
+    re   = SU_C_REAL(x[i]);
+    im   = SU_C_IMAG(x[i]);
+    y[i] = SU_SQRT(re * re + im * im);
+  }
+}
+
+SUPRIVATE void
+suscan_ask_inspector_coherent_envelope_block(
+    struct suscan_ask_inspector *self,
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX z;
+  SUBOOL mix = self->cur_params.ask.offset != 0;
+
+  for (i = 0; i < len; ++i) {
+    z = mix ? x[i] * SU_C_CONJ(su_ncqo_read(&self->lo)) : x[i];
+
+    y[i] = SU_C_REAL(z * self->env_ref);
+    self->env_carrier += z;
+
+    /* The PLL predicts the carrier phase of the next chunk */
+    if (++self->env_carrier_count == SUSCAN_ASK_INSPECTOR_ENVELOPE_PLL_DECIM) {
+      (void) su_pll_track(
+          &self->env_pll,
+          self->env_carrier / SUSCAN_ASK_INSPECTOR_ENVELOPE_PLL_DECIM);
+      self->env_ref           = SU_C_CONJ(su_ncqo_get(&self->env_pll.ncqo));
+      self->env_carrier       = 0;
+      self->env_carrier_count = 0;
+    }
+  }
+}
+
+SUINLINE void
+suscan_ask_inspector_push_symbol(
+    struct suscan_ask_inspector *self,
+    suscan_inspector_t *insp,
+    SUFLOAT symbol)
+{
+  switch (self->cur_params.gc.gc_ctrl) {
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
+      symbol *= 2 * self->cur_params.gc.gc_gain;
+      break;
+
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
+      /* Keep the average symbol level around 1/2 */
+      SU_SPLPF_FEED(self->env_level, symbol, self->env_alpha);
+      if (self->env_level > 0)
+        symbol *= .5 / self->env_level;
+      break;
+  }
+
+  suscan_inspector_push_sample(insp, symbol * .75 * self->phase);
+}
+
+/* Boxcar integrate-and-dump at the symbol rate */
+SUPRIVATE void
+suscan_ask_inspector_dump_block(
+    struct suscan_ask_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUFLOAT period = su_sampler_get_period(&self->sampler);
+
+  /* Baudrate not set: nothing to sample */
+  if (period < 1)
+    return;
+
+  for (i = 0; i < len; ++i) {
+    self->env_acc += SU_C_REAL(y[i]);
+    ++self->env_count;
+
+    if (++self->env_phase >= period) {
+      self->env_phase -= period;
+      suscan_ask_inspector_push_symbol(
+          self,
+          insp,
+          self->env_acc / self->env_count);
+      self->env_acc   = 0;
+      self->env_count = 0;
+    }
+  }
+}
+
+SUPRIVATE void
+suscan_ask_inspector_clock_block(
+    struct suscan_ask_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX output;
+
+  for (i = 0; i < len; ++i) {
+    su_clock_detector_feed(&self->cd, y[i]);
+    if (su_clock_detector_read(&self->cd, &output, 1) == 1)
+      suscan_ask_inspector_push_symbol(self, insp, SU_C_REAL(output));
+  }
+}
+
+SUPRIVATE SUSDIFF
+suscan_ask_inspector_feed_envelope(
+    struct suscan_ask_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SUSCOUNT i = 0;
+  SUSCOUNT len;
+  SUBOOL manual =
+    self->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
+    len = suscan_inspector_get_block_len(
+        insp,
+        manual ? su_sampler_get_period(&self->sampler) : 1,
+        count - i,
+        SUSCAN_ASK_INSPECTOR_BLOCK_SIZE);
+
+    if (self->cur_params.ask.uses_pll)
+      suscan_ask_inspector_coherent_envelope_block(
+          self,
+          x + i,
+          self->block,
+          len);
+    else
+      suscan_ask_inspector_envelope_block(x + i, self->block, len);
+
+    /* Save for subcarrier inspection */
+    (void) suscan_inspector_feed_sc_stuner(insp, self->block, len);
+
+    if (manual) {
+      suscan_ask_inspector_dump_block(self, insp, self->block, len);
+    } else {
+      if (self->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+        su_iir_filt_feed_bulk(&self->mf, self->block, self->block, len);
+
+      suscan_ask_inspector_clock_block(self, insp, self->block, len);
+    }
+
+    i += len;
+
+    if (suscan_inspector_get_output_length(insp) >= insp->sample_msg_watermark)
+      break;
+  }
+
+  return i;
+}
+
 SUSDIFF
 suscan_ask_inspector_feed(
     void *private,
@@ -346,6 +576,9 @@ suscan_ask_inspector_feed(
   struct suscan_ask_inspector *ask_insp =
       (struct suscan_ask_inspector *) private;
 
+  if (ask_insp->cur_params.ask.channel == SUSCAN_INSPECTOR_ASK_CHANNEL_ENVELOPE)
+    return suscan_ask_inspector_feed_envelope(ask_insp, insp, x, count);
+
   last = ask_insp->last;
 
   for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
@@ -34,6 +34,10 @@
 
 #include <string.h>
 
+#ifdef HAVE_VOLK
+#  include <volk/volk.h>
+#endif /* HAVE_VOLK */
+
 #define SUSCAN_AUDIO_INSPECTOR_SAMPLE_RATE 44100
 
 struct suscan_audio_inspector_params {
@@ -62,6 +66,8 @@ struct suscan_audio_inspector_params {
 #define SUSCAN_AUDIO_AM_CARRIER_AVERAGING_SECONDS .2
 #define SUSCAN_AUDIO_RAW_GAIN                     1e3
 #define SUSCAN_AUDIO_SQUELCH_AVG_SECONDS          1e-2
+#define SUSCAN_AUDIO_INSPECTOR_BLOCK_SIZE         1024
+#define SUSCAN_AUDIO_INSPECTOR_MIN_RESAMPLER_DEC  8
 
 struct suscan_audio_inspector {
   struct suscan_inspector_sampling_info samp_info;
@@ -77,6 +83,7 @@ struct suscan_audio_inspector {
   su_pll_t pll;           /* Carrier tracking PLL */
   su_ncqo_t lo;           /* Oscillator */
   su_sampler_t sampler;   /* Fixed rate sampler */
+  suscan_resampler_t *resampler; /* Replaces filt + sampler if not NULL */
 
   SUFLOAT beta;           /* Coefficient for single pole IIR filter */
   SUCOMPLEX last;         /* Last processed sample (for quad demod) */
@@ -88,6 +95,15 @@ struct suscan_audio_inspector {
   SUFLOAT am_power_carr;  /* Measure of AM power carrier */
 
   SUFLOAT ssb_power_chan; /* Measure of SSB power */
+
+  /* Scratch buffer for block demodulation */
+  SUCOMPLEX block[SUSCAN_AUDIO_INSPECTOR_BLOCK_SIZE];
+
+#ifdef HAVE_VOLK
+  /* Scratch buffers for the vector FM discriminator */
+  SUCOMPLEX fm_delayed[SUSCAN_AUDIO_INSPECTOR_BLOCK_SIZE];
+  SUFLOAT   fm_phase[SUSCAN_AUDIO_INSPECTOR_BLOCK_SIZE];
+#endif /* HAVE_VOLK */
 };
 
 SUPRIVATE void
@@ -119,6 +135,9 @@ suscan_audio_inspector_destroy(struct suscan_audio_inspector *insp)
 
   su_sampler_finalize(&insp->sampler);
 
+  if (insp->resampler != NULL)
+    suscan_resampler_destroy(insp->resampler);
+
   free(insp);
 }
 
@@ -283,6 +302,38 @@ suscan_audio_inspector_needs_agc_update(
   return SU_FALSE;
 }
 
+/*
+ * At high decimations, running the SSB brickwall filter at the channel
+ * rate just to discard most of its output is a waste. A polyphase
+ * resampler takes over filtering and sampling there, computing only the
+ * samples we send. Its cost per input sample is about
+ * SUSCAN_RESAMPLER_TAPS_PER_OUTPUT taps, well below the brickwall length
+ * but above the FM and AM Butterworth filters, which are kept.
+ */
+SUPRIVATE void
+suscan_audio_inspector_update_resampler(struct suscan_audio_inspector *self)
+{
+  suscan_resampler_t *resampler = NULL;
+  SUFLOAT fs = self->samp_info.equiv_fs;
+  SUFLOAT rate = self->req_params.audio.sample_rate;
+
+  if ((self->req_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_USB
+        || self->req_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB)
+      && rate > 0
+      && fs >= SUSCAN_AUDIO_INSPECTOR_MIN_RESAMPLER_DEC * rate) {
+    resampler = suscan_resampler_new(
+        rate / fs,
+        SU_ABS2NORM_FREQ(fs, self->req_params.audio.cutoff));
+    if (resampler == NULL)
+      SU_WARNING("Cannot create audio resampler, falling back to sampler\n");
+  }
+
+  if (self->resampler != NULL)
+    suscan_resampler_destroy(self->resampler);
+
+  self->resampler = resampler;
+}
+
 /* Called inside inspector mutex */
 void
 suscan_audio_inspector_commit_config(void *private)
@@ -368,150 +419,338 @@ suscan_audio_inspector_commit_config(void *private)
         SU_ABS2NORM_BAUD(fs, self->req_params.audio.sample_rate));
   }
 
+  suscan_audio_inspector_update_resampler(self);
+
   self->cur_params = self->req_params;
 }
 
-SUSDIFF
-suscan_audio_inspector_feed(
-    void *private,
-    suscan_inspector_t *insp,
+/************************* Block demodulation kernels ************************/
+/*
+ * The feed callback used to branch on the demodulator, the squelch and the
+ * gain control settings once per sample. These kernels run a single stage
+ * over a whole block instead, leaving inner loops with no mode checks in
+ * them. Stages are chained in self->block, in place.
+ */
+
+/* Sanitize input, apply SSB squelch and gain control */
+SUPRIVATE void
+suscan_audio_inspector_condition_block(
+    struct suscan_audio_inspector *self,
+    const suscan_inspector_t *insp,
     const SUCOMPLEX *x,
-    SUSCOUNT count)
+    SUCOMPLEX *y,
+    SUSCOUNT len)
 {
-  SUCOMPLEX last, det_x, output = 0;
   SUSCOUNT i;
-  SUCOMPLEX lo;
-  SUCOMPLEX ylp;
-  struct suscan_audio_inspector *self =
-      (struct suscan_audio_inspector *) private;
-  SUBOOL raw = self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW;
+  SUFLOAT bw_ratio;
+  SUFLOAT gain;
+  SUCOMPLEX det_x;
 
-  if (self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED)
-    return count;
+  for (i = 0; i < len; ++i)
+    y[i] = SU_C_VALID(x[i]) ? x[i] : 0;
 
-  last = self->last;
+  if (self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW)
+    return;
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    det_x = SU_C_VALID(x[i]) ? x[i] : 0;
+  if (self->cur_params.audio.squelch
+      && (self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB
+        || self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_USB)) {
+    bw_ratio = suscan_inspector_get_equiv_fs(insp)
+      / suscan_inspector_get_equiv_bw(insp);
 
-    if (!raw
-        && self->cur_params.audio.squelch
-        && (self->cur_params.audio.demod
-              == SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB
-            || self->cur_params.audio.demod
-                == SUSCAN_INSPECTOR_AUDIO_DEMOD_USB)) {
+    for (i = 0; i < len; ++i) {
+      det_x = y[i];
       SU_SPLPF_FEED(
           self->ssb_power_chan,
           SU_C_REAL(det_x * SU_C_CONJ(det_x)),
           self->sql_alpha);
 
-      if (self->ssb_power_chan
-          * suscan_inspector_get_equiv_fs(insp)
-            / suscan_inspector_get_equiv_bw(insp)
-            < self->cur_params.audio.squelch_level)
-        det_x = 0;
+      if (self->ssb_power_chan * bw_ratio
+          < self->cur_params.audio.squelch_level)
+        y[i] = 0;
     }
+  }
+
+  switch (self->cur_params.gc.gc_ctrl) {
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
+      gain = 2 * self->cur_params.gc.gc_gain;
+      for (i = 0; i < len; ++i)
+        y[i] *= gain;
+      break;
+
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
+      for (i = 0; i < len; ++i)
+        y[i] = 2 * su_agc_feed(&self->agc, y[i]);
+      break;
+  }
+}
 
-    if (!raw) {
-      /* Perform gain control */
-      switch (self->cur_params.gc.gc_ctrl) {
-        case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-          det_x = 2 * self->cur_params.gc.gc_gain * det_x;
-          break;
-
-        case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-          det_x  = 2 * su_agc_feed(&self->agc, det_x);
-          break;
-      }
+#ifdef HAVE_VOLK
+/*
+ * Quadrature discriminator. The block is delayed by one sample with a
+ * single copy, so that both the conjugate product and the argument can
+ * run as VOLK kernels.
+ */
+SUPRIVATE void
+suscan_audio_inspector_discriminate_fm(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  if (len == 0)
+    return;
+
+  self->fm_delayed[0] = self->last;
+  memcpy(self->fm_delayed + 1, y, (len - 1) * sizeof(SUCOMPLEX));
+  self->last = y[len - 1];
+
+  volk_32fc_x2_multiply_conjugate_32fc(
+      self->fm_delayed,
+      y,
+      self->fm_delayed,
+      len);
+  volk_32fc_s32f_atan2_32f(self->fm_phase, self->fm_delayed, M_PI, len);
+
+  for (i = 0; i < len; ++i)
+    y[i] = self->fm_phase[i];
+}
+#else
+SUPRIVATE void
+suscan_audio_inspector_discriminate_fm(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX last = self->last;
+  SUCOMPLEX det_x;
+
+  for (i = 0; i < len; ++i) {
+    det_x = y[i];
+    y[i]  = SU_C_ARG(det_x * SU_C_CONJ(last)) / M_PI;
+    last  = det_x;
+  }
+
+  self->last = last;
+}
+#endif /* HAVE_VOLK */
+
+SUPRIVATE void
+suscan_audio_inspector_demod_fm(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX output, ylp;
+
+  suscan_audio_inspector_discriminate_fm(self, y, len);
+
+  /*
+   * FM squelch compares the output in lower frequencies
+   * with the output of the full channel.
+   */
+  if (self->cur_params.audio.squelch) {
+    for (i = 0; i < len; ++i) {
+      output = y[i];
+      ylp = su_iir_filt_feed(&self->fm_lpf, output);
+
+      SU_SPLPF_FEED(
+          self->fm_power_low,
+          SU_C_REAL(ylp * SU_C_CONJ(ylp)),
+          self->sql_alpha);
+
+      SU_SPLPF_FEED(
+          self->fm_power_chan,
+          SU_C_REAL(output * SU_C_CONJ(output)),
+          self->sql_alpha);
+
+      if (!sufreleq(self->fm_power_chan, self->fm_power_low, 1e-1))
+        y[i] = 0;
     }
+  }
+}
 
-    switch (self->cur_params.audio.demod) {
-      case SUSCAN_INSPECTOR_AUDIO_DEMOD_FM:
-        output = SU_C_ARG(det_x * SU_C_CONJ(last)) / M_PI;
-        last   = det_x;
+SUPRIVATE void
+suscan_audio_inspector_demod_am(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX last = self->last;
+  SUCOMPLEX output;
 
-        /*
-         * FM squelch compares the output in lower frequencies
-         * with the output of the full channel.
-         */
-        if (self->cur_params.audio.squelch) {
-          ylp = su_iir_filt_feed(&self->fm_lpf, output);
+  if (self->cur_params.audio.squelch) {
+    for (i = 0; i < len; ++i) {
+      /* Synchronous detection */
+      output = su_pll_track(&self->pll, y[i]);
+
+      /* Carrier removal */
+      SU_SPLPF_FEED(last, output, self->beta);
+      SU_SPLPF_FEED(
+          self->am_power_carr,
+          SU_C_REAL(last * SU_C_CONJ(last)),
+          self->sql_alpha);
+
+      if (self->am_power_carr < self->cur_params.audio.squelch_level)
+        y[i] = 0;
+      else
+        y[i] = SUSCAN_AUDIO_AM_ATTENUATION * (output - last);
+    }
+  } else {
+    for (i = 0; i < len; ++i) {
+      output = su_pll_track(&self->pll, y[i]);
+      SU_SPLPF_FEED(last, output, self->beta);
+      y[i] = SUSCAN_AUDIO_AM_ATTENUATION * (output - last);
+    }
+  }
+
+  self->last = last;
+}
+
+SUPRIVATE void
+suscan_audio_inspector_demod_usb(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    y[i] *= su_ncqo_read(&self->lo);
+}
+
+SUPRIVATE void
+suscan_audio_inspector_demod_lsb(
+    struct suscan_audio_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    y[i] *= SU_C_CONJ(su_ncqo_read(&self->lo));
+}
+
+SUPRIVATE void
+suscan_audio_inspector_demod_raw(SUCOMPLEX *y, SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i)
+    y[i] *= SUSCAN_AUDIO_RAW_GAIN;
+}
 
-          SU_SPLPF_FEED(
-              self->fm_power_low,
-              SU_C_REAL(ylp * SU_C_CONJ(ylp)),
-              self->sql_alpha);
+/*
+ * Volume, audio filter and decimation down to the audio rate. Blocks are
+ * sized with suscan_inspector_get_block_len, so running out of room in the
+ * sampler buffer here means lost audio and is reported as an error.
+ */
+SUPRIVATE SUBOOL
+suscan_audio_inspector_output_block(
+    struct suscan_audio_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUFLOAT volume = self->cur_params.audio.volume;
+  SUCOMPLEX output;
+
+  if (self->resampler != NULL) {
+    for (i = 0; i < len; ++i)
+      self->block[i] = .75 * volume * y[i];
+
+    SU_TRYCATCH(
+        suscan_inspector_push_resampled(
+          insp,
+          self->resampler,
+          self->block,
+          len) == len,
+        return SU_FALSE);
+
+    return SU_TRUE;
+  }
 
-          SU_SPLPF_FEED(
-              self->fm_power_chan,
-              SU_C_REAL(output * SU_C_CONJ(output)),
-              self->sql_alpha);
+  for (i = 0; i < len; ++i) {
+    output = su_iir_filt_feed(&self->filt, volume * y[i]);
 
-          if (!sufreleq(self->fm_power_chan, self->fm_power_low, 1e-1))
-            output = 0;
-        }
+    if (su_sampler_feed(&self->sampler, &output))
+      SU_TRYCATCH(
+          suscan_inspector_push_sample(insp, output * .75),
+          return SU_FALSE);
+  }
 
+  return SU_TRUE;
+}
+
+SUSDIFF
+suscan_audio_inspector_feed(
+    void *private,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SUSCOUNT i = 0;
+  SUSCOUNT len;
+  SUSCOUNT length;
+  struct suscan_audio_inspector *self =
+      (struct suscan_audio_inspector *) private;
+
+  if (self->cur_params.audio.demod == SUSCAN_INSPECTOR_AUDIO_DEMOD_DISABLED)
+    return count;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
+    len = suscan_inspector_get_block_len(
+        insp,
+        self->resampler != NULL
+          ? suscan_resampler_get_period(self->resampler)
+          : su_sampler_get_period(&self->sampler),
+        count - i,
+        SUSCAN_AUDIO_INSPECTOR_BLOCK_SIZE);
+
+    suscan_audio_inspector_condition_block(self, insp, x + i, self->block, len);
+
+    switch (self->cur_params.audio.demod) {
+      case SUSCAN_INSPECTOR_AUDIO_DEMOD_FM:
+        suscan_audio_inspector_demod_fm(self, self->block, len);
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_AM:
-        /* Synchronous detection */
-        output  = su_pll_track(&self->pll, det_x);
-
-        /* Carrier removal */
-        SU_SPLPF_FEED(last, output, self->beta);
-
-        if (self->cur_params.audio.squelch) {
-          SU_SPLPF_FEED(
-              self->am_power_carr,
-              SU_C_REAL(last * SU_C_CONJ(last)),
-              self->sql_alpha);
-
-          if (self->am_power_carr < self->cur_params.audio.squelch_level)
-            output = 0;
-          else
-            output -= last;
-        } else {
-          output -= last;
-        }
-
-        /* Volume attenuation */
-        output *= SUSCAN_AUDIO_AM_ATTENUATION;
+        suscan_audio_inspector_demod_am(self, self->block, len);
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_USB:
-        lo = su_ncqo_read(&self->lo);
-        output  = det_x * lo;
+        suscan_audio_inspector_demod_usb(self, self->block, len);
         break;
 
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_LSB:
-        lo = su_ncqo_read(&self->lo);
-        output = det_x * SU_C_CONJ(lo);
+        suscan_audio_inspector_demod_lsb(self, self->block, len);
         break;
 
       /* Pass thru */
       case SUSCAN_INSPECTOR_AUDIO_DEMOD_RAW:
-        output = SUSCAN_AUDIO_RAW_GAIN * det_x;
+        suscan_audio_inspector_demod_raw(self->block, len);
+        break;
 
       default:
         break;
     }
 
-    output *= self->cur_params.audio.volume;
+    SU_TRYCATCH(
+        suscan_audio_inspector_output_block(self, insp, self->block, len),
+        return -1);
 
-    output = su_iir_filt_feed(&self->filt, output);
+    i += len;
 
-    if (su_sampler_feed(&self->sampler, &output)) {
-      suscan_inspector_push_sample(insp, output * .75);
-      if (suscan_inspector_get_output_length(insp) == insp->sample_msg_watermark) {
-        ++i; /* Important! We have consumed this sample too! */
-        break;
-      }
-    }
+    length = suscan_inspector_get_output_length(insp);
+    if (length > 0 && length >= insp->sample_msg_watermark)
+      break;
   }
 
-
-  self->last = last;
-
   return i;
 }
 
@@ -0,0 +1,368 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "bank-inspector"
+
+#include <sigutils/sigutils.h>
+
+#include <analyzer/version.h>
+
+#include "inspector/interface.h"
+#include "inspector/params.h"
+#include "inspector/inspector.h"
+#include "inspector/pfb.h"
+
+#include <string.h>
+#include <inttypes.h>
+
+/*
+ * The channel bank inspector monitors many identical, evenly spaced
+ * narrowband channels inside its own (wide) channel. Instead of opening
+ * one inspector per channel, a polyphase filter bank splits the inspector
+ * channel in M = fs / spacing channels, of which the N closest to the
+ * center are kept. Outputs are multiplexed in frames of N samples (one
+ * per channel, lowest frequency first), at a rate of fs / M frames per
+ * second. Frames are never split across sample batches.
+ */
+
+#define SUSCAN_BANK_INSPECTOR_TAPS_PER_BRANCH 8
+
+struct suscan_bank_inspector_params {
+  SUSCOUNT channels;
+  SUFLOAT  spacing;  /* In Hz */
+};
+
+struct suscan_bank_inspector {
+  struct suscan_inspector_sampling_info samp_info;
+  struct suscan_bank_inspector_params req_params;
+  struct suscan_bank_inspector_params cur_params;
+
+  suscan_inspector_t *insp;
+  suscan_pfb_t       *pfb;
+
+  /* Channel state, one entry per channel */
+  SUSCOUNT  channels;
+  SUSCOUNT *bin;      /* Filter bank output of each channel */
+  SUFLOAT   spacing;  /* Actual channel spacing, in Hz */
+};
+
+SUPRIVATE void
+suscan_bank_inspector_params_initialize(
+    struct suscan_bank_inspector_params *params,
+    const struct suscan_inspector_sampling_info *sinfo)
+{
+  memset(params, 0, sizeof(struct suscan_bank_inspector_params));
+
+  params->channels = 1;
+  params->spacing  = sinfo->equiv_fs;
+}
+
+SUPRIVATE void
+suscan_bank_inspector_destroy(struct suscan_bank_inspector *self)
+{
+  if (self->pfb != NULL)
+    suscan_pfb_destroy(self->pfb);
+
+  if (self->bin != NULL)
+    free(self->bin);
+
+  free(self);
+}
+
+SUPRIVATE struct suscan_bank_inspector *
+suscan_bank_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
+{
+  struct suscan_bank_inspector *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_bank_inspector);
+
+  new->samp_info = *sinfo;
+
+  suscan_bank_inspector_params_initialize(&new->cur_params, sinfo);
+  new->req_params = new->cur_params;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_bank_inspector_destroy(new);
+
+  return NULL;
+}
+
+SUPRIVATE void
+suscan_bank_inspector_send_layout(struct suscan_bank_inspector *self)
+{
+  suscan_inspector_send_signal(self->insp, "channels", self->channels);
+  suscan_inspector_send_signal(self->insp, "spacing", self->spacing);
+}
+
+/*
+ * Rebuild the filter bank after a configuration change. On failure, the
+ * bank is left empty and the input is discarded.
+ */
+SUPRIVATE SUBOOL
+suscan_bank_inspector_update_bank(struct suscan_bank_inspector *self)
+{
+  SUSCOUNT branches, channels, i;
+  SUSCOUNT *bin = NULL;
+  suscan_pfb_t *pfb = NULL;
+  SUFLOAT fs = self->samp_info.equiv_fs;
+  SUBOOL ok = SU_FALSE;
+
+  if (self->pfb != NULL) {
+    suscan_pfb_destroy(self->pfb);
+    self->pfb = NULL;
+  }
+
+  if (self->bin != NULL) {
+    free(self->bin);
+    self->bin = NULL;
+  }
+
+  self->channels = 0;
+  self->spacing  = fs;
+
+  SU_TRY(self->cur_params.spacing > 0);
+
+  branches = SU_FLOOR(fs / self->cur_params.spacing + .5);
+  if (branches < 1)
+    branches = 1;
+  if (branches > SUSCAN_PFB_MAX_BRANCHES)
+    branches = SUSCAN_PFB_MAX_BRANCHES;
+
+  channels = self->cur_params.channels;
+  if (channels > branches)
+    channels = branches;
+
+  SU_TRY(channels > 0);
+
+  SU_TRY(pfb = suscan_pfb_new(branches, SUSCAN_BANK_INSPECTOR_TAPS_PER_BRANCH));
+  SU_ALLOCATE_MANY(bin, channels, SUSCOUNT);
+
+  /* Channels are centered around the inspector frequency */
+  for (i = 0; i < channels; ++i)
+    bin[i] = (i + branches - channels / 2) % branches;
+
+  self->pfb      = pfb;
+  self->bin      = bin;
+  self->channels = channels;
+  self->spacing  = fs / branches;
+
+  pfb = NULL;
+  bin = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (pfb != NULL)
+    suscan_pfb_destroy(pfb);
+
+  if (bin != NULL)
+    free(bin);
+
+  return ok;
+}
+
+/************************** API implementation *******************************/
+void *
+suscan_bank_inspector_open(const struct suscan_inspector_sampling_info *s)
+{
+  struct suscan_bank_inspector *new;
+
+  if ((new = suscan_bank_inspector_new(s)) == NULL)
+    return NULL;
+
+  if (!suscan_bank_inspector_update_bank(new)) {
+    suscan_bank_inspector_destroy(new);
+    return NULL;
+  }
+
+  return new;
+}
+
+SUBOOL
+suscan_bank_inspector_bind(void *private, suscan_inspector_t *insp)
+{
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+
+  self->insp = insp;
+  suscan_inspector_set_sampler_frame(insp, self->channels);
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_bank_inspector_get_config(void *private, suscan_config_t *config)
+{
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+
+  SU_TRYCATCH(
+    suscan_config_set_integer(
+      config,
+      "bank.channels",
+      self->cur_params.channels),
+    return SU_FALSE);
+
+  SU_TRYCATCH(
+    suscan_config_set_float(
+      config,
+      "bank.spacing",
+      self->cur_params.spacing),
+    return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+SUBOOL
+suscan_bank_inspector_parse_config(void *private, const suscan_config_t *config)
+{
+  struct suscan_field_value *value;
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+
+  SU_TRYCATCH(
+      value = suscan_config_get_value(config, "bank.channels"),
+      return SU_FALSE);
+  SU_TRYCATCH(value->field->type == SUSCAN_FIELD_TYPE_INTEGER, return SU_FALSE);
+  self->req_params.channels = value->as_int;
+
+  SU_TRYCATCH(
+      value = suscan_config_get_value(config, "bank.spacing"),
+      return SU_FALSE);
+  SU_TRYCATCH(value->field->type == SUSCAN_FIELD_TYPE_FLOAT, return SU_FALSE);
+  self->req_params.spacing = value->as_float;
+
+  return SU_TRUE;
+}
+
+/* Called inside inspector mutex */
+void
+suscan_bank_inspector_commit_config(void *private)
+{
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+
+  /* Pending frames belong to the old layout: send them before it changes */
+  if (self->insp != NULL && !suscan_inspector_flush_samples(self->insp))
+    SU_WARNING("Pending bank frames could not be sent, discarded\n");
+
+  self->cur_params = self->req_params;
+
+  if (!suscan_bank_inspector_update_bank(self))
+    SU_ERROR(
+      "Failed to set up a bank of %" PRIu64 " channels\n",
+      (uint64_t) self->cur_params.channels);
+
+  if (self->insp != NULL) {
+    suscan_inspector_set_sampler_frame(self->insp, self->channels);
+    suscan_bank_inspector_send_layout(self);
+  }
+}
+
+SUSDIFF
+suscan_bank_inspector_feed(
+    void *private,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+  const SUCOMPLEX *frame;
+  SUSCOUNT i = 0, j;
+  SUSCOUNT channels = self->channels;
+
+  if (self->pfb == NULL)
+    return count;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) >= channels) {
+    i += suscan_pfb_feed(self->pfb, x + i, count - i, &frame);
+
+    if (frame != NULL) {
+      for (j = 0; j < channels; ++j)
+        suscan_inspector_push_sample(insp, frame[self->bin[j]]);
+
+      if (suscan_inspector_get_output_length(insp) >= insp->sample_msg_watermark)
+        break;
+    }
+  }
+
+  return i;
+}
+
+void
+suscan_bank_inspector_close(void *private)
+{
+  struct suscan_bank_inspector *self = (struct suscan_bank_inspector *) private;
+
+  suscan_bank_inspector_destroy(self);
+}
+
+SUPRIVATE struct suscan_inspector_interface iface = {
+    .name = "bank",
+    .desc = "Channel bank",
+    .open = suscan_bank_inspector_open,
+    .bind = suscan_bank_inspector_bind,
+    .get_config = suscan_bank_inspector_get_config,
+    .parse_config = suscan_bank_inspector_parse_config,
+    .commit_config = suscan_bank_inspector_commit_config,
+    .feed = suscan_bank_inspector_feed,
+    .close = suscan_bank_inspector_close
+};
+
+SUBOOL
+suscan_bank_inspector_register(void)
+{
+  suscan_config_desc_t *desc = NULL;
+
+  SU_TRY_FAIL(
+      desc = suscan_config_desc_new_ex(
+          "bank-params-desc-" SUSCAN_VERSION_STRING));
+
+  SU_TRY_FAIL(
+    suscan_config_desc_add_field(
+      desc,
+      SUSCAN_FIELD_TYPE_INTEGER,
+      SU_FALSE,
+      "bank.channels",
+      "Number of channels"));
+
+  SU_TRY_FAIL(
+    suscan_config_desc_add_field(
+      desc,
+      SUSCAN_FIELD_TYPE_FLOAT,
+      SU_FALSE,
+      "bank.spacing",
+      "Channel spacing (Hz)"));
+
+  iface.cfgdesc = desc;
+  desc = NULL;
+  SU_TRY_FAIL(suscan_config_desc_register(iface.cfgdesc));
+
+  (void) suscan_inspector_interface_add_spectsrc(&iface, "psd");
+
+  /* Register inspector interface */
+  SU_TRY_FAIL(suscan_inspector_interface_register(&iface));
+
+  return SU_TRUE;
+
+fail:
+  if (desc != NULL)
+    suscan_config_desc_destroy(desc);
+
+  return SU_FALSE;
+}
@@ -31,6 +31,7 @@
 #include "inspector/params.h"
 
 #include "inspector/inspector.h"
+#include "inspector/resampler.h"
 
 #define SUSCAN_DRIFT_INSPECTOR_PLL_BW_FRAC      5e-2
 #define SUSCAN_DRIFT_INSPECTOR_AGC_SLOWNESS     200
@@ -42,11 +43,19 @@
 #define SUSCAN_DRIFT_INSPECTOR_DELAY_LINE_FRAC  (SUSCAN_DRIFT_INSPECTOR_FAST_RISE_FRAC * 10)
 #define SUSCAN_DRIFT_INSPECTOR_MAG_HISTORY_FRAC (SUSCAN_DRIFT_INSPECTOR_FAST_RISE_FRAC * 10)
 
+/* Decimated sample rate, in loop bandwidths */
+#define SUSCAN_DRIFT_INSPECTOR_DECIM_RATIO      16
+#define SUSCAN_DRIFT_INSPECTOR_MIN_DECIM        4
+#define SUSCAN_DRIFT_INSPECTOR_MAX_DECIM        1024
+#define SUSCAN_DRIFT_INSPECTOR_KICK_TABLE_SIZE  256
+#define SUSCAN_DRIFT_INSPECTOR_BLOCK_SIZE       256
+
 struct suscan_drift_inspector_params {
   SUFLOAT lock_threshold;
   SUFLOAT cutoff;
   SUFLOAT feedback_interval;
   SUBOOL  pll_reset;
+  SUBOOL  decimate;
 
   /* These parameters are read only by the user */
   SUSCOUNT feedback_samples;
@@ -59,6 +68,7 @@ struct suscan_drift_inspector {
 
   /* Blocks */
   su_agc_t   agc; /* AGC, to make sure we have consistent lock readings */
+  SUBOOL     agc_init;
   su_pll_t   pll; /* PLL, to track the carrier */
 
   /* State */
@@ -80,6 +90,13 @@ struct suscan_drift_inspector {
 
   SUSCOUNT   feedback_wait;
   SUSCOUNT   feedback_counter;
+
+  /* Decimate-then-track (decimator == NULL: track at channel rate) */
+  unsigned int        decim;
+  suscan_resampler_t *decimator;
+  SUSCOUNT            feedback_wait_dec;
+  SUFLOAT             fkick_table[SUSCAN_DRIFT_INSPECTOR_KICK_TABLE_SIZE];
+  SUCOMPLEX           block[SUSCAN_DRIFT_INSPECTOR_BLOCK_SIZE];
 };
 
 SUPRIVATE void
@@ -94,22 +111,269 @@ suscan_drift_inspector_params_initialize(
   params->lock_threshold    = .25;
   params->cutoff            = true_bw * SUSCAN_DRIFT_INSPECTOR_PLL_BW_FRAC;
   params->feedback_interval = .1;
+  params->decimate          = SU_TRUE;
 }
 
 SUPRIVATE void
 suscan_drift_inspector_destroy(struct suscan_drift_inspector *self)
 {
-  su_agc_finalize(&self->agc);
+  if (self->agc_init)
+    su_agc_finalize(&self->agc);
+
   su_pll_finalize(&self->pll);
+
+  if (self->decimator != NULL)
+    suscan_resampler_destroy(self->decimator);
+
   free(self);
 }
 
+/*
+ * AGC time constants are given in samples. They are computed for the
+ * channel rate and scaled down to the tracking rate, so the AGC keeps
+ * the same time response regardless of the decimation.
+ */
+SUPRIVATE SUBOOL
+suscan_drift_inspector_make_agc(
+    const struct suscan_drift_inspector *self,
+    unsigned int decim,
+    su_agc_t *agc)
+{
+  struct su_agc_params agc_params = su_agc_params_INITIALIZER;
+  SUFLOAT tau;
+
+  tau = SUSCAN_DRIFT_INSPECTOR_AGC_SLOWNESS / self->samp_info.equiv_fs;
+  if (tau > 200)
+    tau = 200;
+
+  tau /= decim;
+
+  agc_params.fast_rise_t = tau * SUSCAN_DRIFT_INSPECTOR_FAST_RISE_FRAC;
+  agc_params.fast_fall_t = tau * SUSCAN_DRIFT_INSPECTOR_FAST_FALL_FRAC;
+  agc_params.slow_rise_t = tau * SUSCAN_DRIFT_INSPECTOR_SLOW_RISE_FRAC;
+  agc_params.slow_fall_t = tau * SUSCAN_DRIFT_INSPECTOR_SLOW_FALL_FRAC;
+  agc_params.hang_max    = tau * SUSCAN_DRIFT_INSPECTOR_HANG_MAX_FRAC;
+
+  /* TODO: Check whether these sizes are too big */
+  agc_params.delay_line_size  = tau * SUSCAN_DRIFT_INSPECTOR_DELAY_LINE_FRAC;
+  agc_params.mag_history_size = tau * SUSCAN_DRIFT_INSPECTOR_MAG_HISTORY_FRAC;
+
+  SU_TRYCATCH(su_agc_init(agc, &agc_params), return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+/************************** Decimate-then-track mode *************************/
+/*
+ * Drift tracking PLLs are narrow: running them at the channel rate wastes
+ * most of the CPU in samples that carry no new information. When the
+ * channel rate is much higher than the loop bandwidth, the channel is
+ * decimated first and both the AGC and the PLL run at the lower rate.
+ * The decimated Nyquist frequency stays well above the pull-in range of
+ * the loop, so tracking is unaffected.
+ */
+SUPRIVATE unsigned int
+suscan_drift_inspector_pick_decimation(
+    const struct suscan_drift_inspector *self)
+{
+  SUFLOAT fs = self->samp_info.equiv_fs;
+  SUFLOAT cutoff = self->cur_params.cutoff;
+  unsigned int decim = 1, d;
+
+  if (!self->cur_params.decimate)
+    return 1;
+
+  if (cutoff > 0)
+    decim = SU_FLOOR(fs / (cutoff * SUSCAN_DRIFT_INSPECTOR_DECIM_RATIO));
+
+  if (decim > SUSCAN_DRIFT_INSPECTOR_MAX_DECIM)
+    decim = SUSCAN_DRIFT_INSPECTOR_MAX_DECIM;
+  else if (decim < SUSCAN_DRIFT_INSPECTOR_MIN_DECIM)
+    return 1;
+
+  /*
+   * Feedback samples can only be produced every decim input samples.
+   * Prefer a slightly lower decimation that divides the feedback period,
+   * so that the requested feedback interval is kept exactly.
+   */
+  for (d = decim; 2 * d >= decim && d >= SUSCAN_DRIFT_INSPECTOR_MIN_DECIM; --d)
+    if (self->feedback_wait % d == 0)
+      return d;
+
+  return decim;
+}
+
+/* Loop cutoff and feedback period, relative to the current tracking rate */
+SUPRIVATE void
+suscan_drift_inspector_update_loop(struct suscan_drift_inspector *self)
+{
+  SUFLOAT fs = self->samp_info.equiv_fs;
+
+  su_pll_set_cutoff(
+      &self->pll,
+      SU_ABS2NORM_FREQ(fs / self->decim, self->cur_params.cutoff));
+
+  self->feedback_wait_dec = self->feedback_wait / self->decim;
+  if (self->feedback_wait_dec < 1)
+    self->feedback_wait_dec = 1;
+
+  /* Report the feedback period actually in use */
+  self->cur_params.feedback_samples  = self->feedback_wait_dec * self->decim;
+  self->cur_params.feedback_interval =
+    self->cur_params.feedback_samples / fs;
+}
+
+SUPRIVATE SUBOOL
+suscan_drift_inspector_update_decimation(struct suscan_drift_inspector *self)
+{
+  suscan_resampler_t *decimator = NULL;
+  su_agc_t agc;
+  SUFLOAT fnor;
+  unsigned int decim;
+
+  decim = suscan_drift_inspector_pick_decimation(self);
+
+  if (decim != self->decim || !self->agc_init) {
+    if (decim > 1)
+      SU_TRYCATCH(
+          decimator = suscan_resampler_new(1. / decim, 1. / decim),
+          return SU_FALSE);
+
+    if (!suscan_drift_inspector_make_agc(self, decim, &agc)) {
+      if (decimator != NULL)
+        suscan_resampler_destroy(decimator);
+      return SU_FALSE;
+    }
+
+    if (self->agc_init)
+      su_agc_finalize(&self->agc);
+
+    self->agc      = agc;
+    self->agc_init = SU_TRUE;
+
+    /* Keep the tracked frequency across rate changes */
+    fnor = su_pll_get_freq(&self->pll) * decim / self->decim;
+    su_pll_set_angfreq(&self->pll, SU_NORM2ANG_FREQ(fnor));
+
+    if (self->decimator != NULL)
+      suscan_resampler_destroy(self->decimator);
+
+    self->decimator        = decimator;
+    self->decim            = decim;
+    self->pending_fkicks   = 0;
+    self->feedback_counter = 0;
+  }
+
+  suscan_drift_inspector_update_loop(self);
+
+  return SU_TRUE;
+}
+
+/*
+ * Frequency switch compensation, spread as a raised sine over the next
+ * len decimated samples. The table is computed once per switch, so no
+ * trigonometry is left in the tracking loop. Kicks add up to the same
+ * total frequency change as in the full-rate loop.
+ */
+SUPRIVATE void
+suscan_drift_inspector_fill_kick_table(
+    struct suscan_drift_inspector *self,
+    SUSCOUNT count)
+{
+  SUSCOUNT len = (count + self->decim - 1) / self->decim;
+  SUSCOUNT k;
+  SUFLOAT total = -self->omdelta * self->decim;
+  SUFLOAT norm;
+
+  if (len > SUSCAN_DRIFT_INSPECTOR_KICK_TABLE_SIZE)
+    len = SUSCAN_DRIFT_INSPECTOR_KICK_TABLE_SIZE;
+  if (len < 1)
+    len = 1;
+
+  norm = SU_SIN(M_PI / (2 * len));
+
+  for (k = 0; k < len; ++k)
+    self->fkick_table[k] = total * norm * SU_SIN(M_PI * (k + .5) / len);
+
+  self->pending_fkicks = len;
+  self->num_fkicks     = len;
+}
+
+SUPRIVATE SUSDIFF
+suscan_drift_inspector_feed_decimated(
+    struct suscan_drift_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SUSCOUNT i = 0, j;
+  SUSCOUNT len, got, n;
+  SUSCOUNT kpending;
+  SUSCOUNT feedback_counter = self->feedback_counter;
+  SUSCOUNT feedback_max     = self->feedback_wait_dec;
+  SUFLOAT  dec_fs = self->samp_info.equiv_fs / self->decim;
+  SUFLOAT  carr_freq;
+  SUFREQ   curr_freq;
+  SUFLOAT  alpha;
+  SUCOMPLEX y;
+
+  if (self->switching_freq) {
+    suscan_drift_inspector_fill_kick_table(self, count);
+    self->switching_freq = SU_FALSE;
+  }
+
+  kpending = self->pending_fkicks;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
+    len = suscan_inspector_get_block_len(
+        insp,
+        feedback_max * self->decim,
+        count - i,
+        SUSCAN_DRIFT_INSPECTOR_BLOCK_SIZE * self->decim);
+
+    n   = SUSCAN_DRIFT_INSPECTOR_BLOCK_SIZE;
+    got = suscan_resampler_feed(self->decimator, x + i, len, self->block, &n);
+
+    for (j = 0; j < n; ++j) {
+      y = 2 * su_agc_feed(&self->agc, self->block[j]);
+      y = su_pll_track(&self->pll, y);
+
+      if (kpending > 0) {
+        su_pll_inc_angfreq(
+            &self->pll,
+            self->fkick_table[self->num_fkicks - kpending]);
+        --kpending;
+      }
+
+      if (++feedback_counter >= feedback_max) {
+        if (kpending == 0) {
+          curr_freq = self->chan_freq;
+        } else {
+          alpha = kpending / (SUFLOAT) self->num_fkicks;
+          curr_freq = (1 - alpha) * self->chan_freq  + alpha * self->old_freq;
+        }
+
+        carr_freq = SU_NORM2ABS_FREQ(dec_fs, su_pll_get_freq(&self->pll));
+
+        suscan_inspector_push_sample(insp, carr_freq + I * curr_freq);
+        feedback_counter = 0;
+      }
+    }
+
+    i += got;
+  }
+
+  self->feedback_counter = feedback_counter;
+  self->pending_fkicks   = kpending;
+
+  return i;
+}
+
 SUPRIVATE struct suscan_drift_inspector *
 suscan_drift_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
 {
   struct suscan_drift_inspector *new = NULL;
-  struct su_agc_params agc_params = su_agc_params_INITIALIZER;
-  SUFLOAT tau, norm_cutoff;
+  SUFLOAT norm_cutoff;
   SUFREQ  base_samp_rate = sinfo->equiv_fs * sinfo->decimation;
   SUFREQ f0;
 
@@ -126,8 +390,6 @@ suscan_drift_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
   suscan_drift_inspector_params_initialize(&new->cur_params, sinfo);
   
   new->feedback_wait = new->cur_params.feedback_interval * sinfo->equiv_fs;
-  new->cur_params.feedback_samples  = new->feedback_wait;
-  new->cur_params.feedback_interval = new->feedback_wait / sinfo->equiv_fs;
   norm_cutoff = SU_ABS2NORM_FREQ(sinfo->equiv_fs, new->cur_params.cutoff);
 
   /* Create PLL */
@@ -137,22 +399,9 @@ suscan_drift_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
           0,
           norm_cutoff));
 
-  /* Initialize AGC */
-  tau = SUSCAN_DRIFT_INSPECTOR_AGC_SLOWNESS / sinfo->equiv_fs;
-  if (tau > 200)
-    tau = 200;
-  
-  agc_params.fast_rise_t = tau * SUSCAN_DRIFT_INSPECTOR_FAST_RISE_FRAC;
-  agc_params.fast_fall_t = tau * SUSCAN_DRIFT_INSPECTOR_FAST_FALL_FRAC;
-  agc_params.slow_rise_t = tau * SUSCAN_DRIFT_INSPECTOR_SLOW_RISE_FRAC;
-  agc_params.slow_fall_t = tau * SUSCAN_DRIFT_INSPECTOR_SLOW_FALL_FRAC;
-  agc_params.hang_max    = tau * SUSCAN_DRIFT_INSPECTOR_HANG_MAX_FRAC;
-
-  /* TODO: Check whether these sizes are too big */
-  agc_params.delay_line_size  = tau * SUSCAN_DRIFT_INSPECTOR_DELAY_LINE_FRAC;
-  agc_params.mag_history_size = tau * SUSCAN_DRIFT_INSPECTOR_MAG_HISTORY_FRAC;
-
-  SU_TRY_FAIL(su_agc_init(&new->agc, &agc_params));
+  /* Also initializes the AGC and the feedback period */
+  new->decim = 1;
+  SU_TRY_FAIL(suscan_drift_inspector_update_decimation(new));
 
   return new;
 
@@ -203,6 +452,13 @@ suscan_drift_inspector_get_config(void *private, suscan_config_t *config)
       SU_FALSE),
     return SU_FALSE);
 
+  SU_TRYCATCH(
+    suscan_config_set_bool(
+      config,
+      "drift.decimate",
+      self->cur_params.decimate),
+    return SU_FALSE);
+
   SU_TRYCATCH(
     suscan_config_set_integer(
       config,
@@ -255,6 +511,15 @@ suscan_drift_inspector_parse_config(void *private, const suscan_config_t *config
   SU_TRYCATCH(value->field->type == SUSCAN_FIELD_TYPE_BOOLEAN, return SU_FALSE);
   self->req_params.pll_reset = value->as_bool;
 
+  SU_TRYCATCH(
+      value = suscan_config_get_value(
+          config,
+          "drift.decimate"),
+      return SU_FALSE);
+
+  SU_TRYCATCH(value->field->type == SUSCAN_FIELD_TYPE_BOOLEAN, return SU_FALSE);
+  self->req_params.decimate = value->as_bool;
+
   return SU_TRUE;
 }
 
@@ -262,17 +527,12 @@ suscan_drift_inspector_parse_config(void *private, const suscan_config_t *config
 void
 suscan_drift_inspector_commit_config(void *private)
 {
-  SUFLOAT fs;
-  SUBOOL needs_update;
-  SUFLOAT norm_cutoff;
   const struct suscan_inspector_sampling_info *sinfo;
 
   struct suscan_drift_inspector *self = (struct suscan_drift_inspector *) private;
   sinfo = &self->samp_info;
 
-  needs_update = self->cur_params.cutoff != self->req_params.cutoff;
   self->cur_params = self->req_params;
-  fs = self->samp_info.equiv_fs;
 
   if (self->cur_params.pll_reset) {
     self->cur_params.pll_reset = 0;
@@ -280,15 +540,16 @@ suscan_drift_inspector_commit_config(void *private)
     su_pll_set_angfreq(&self->pll, 0);
   }
 
-  if (needs_update) {
-    norm_cutoff = SU_ABS2NORM_FREQ(fs, self->cur_params.cutoff);
+  /*
+   * The feedback period and the loop cutoff depend on the decimation,
+   * which in turn depends on both. Recompute them always, as the
+   * requested feedback interval may differ from the effective one.
+   */
+  self->feedback_wait = self->cur_params.feedback_interval * sinfo->equiv_fs;
 
-    su_pll_set_cutoff(&self->pll, norm_cutoff);
-
-    /* Change feedback interval */
-    self->feedback_wait = self->cur_params.feedback_interval * sinfo->equiv_fs;
-    self->cur_params.feedback_samples = self->feedback_wait;
-    self->cur_params.feedback_interval = self->feedback_wait / sinfo->equiv_fs;
+  if (!suscan_drift_inspector_update_decimation(self)) {
+    SU_WARNING("Cannot update decimation, keeping the current one\n");
+    suscan_drift_inspector_update_loop(self);
   }
 }
 
@@ -342,6 +603,11 @@ suscan_drift_inspector_feed(
   struct suscan_drift_inspector *self =
       (struct suscan_drift_inspector *) private;
 
+  if (self->decimator != NULL) {
+    i = suscan_drift_inspector_feed_decimated(self, insp, x, count);
+    goto done;
+  }
+
   if (self->switching_freq) {
     self->fkick          = self->omdelta / count;
     self->pending_fkicks = count;
@@ -390,6 +656,7 @@ suscan_drift_inspector_feed(
   self->feedback_counter = feedback_counter;
   self->pending_fkicks   = kpending;
 
+done:
   lock_state = su_pll_locksig(&self->pll) > self->cur_params.lock_threshold;
   if (self->lock_state != lock_state) {
     self->lock_state = lock_state;
@@ -460,6 +727,14 @@ suscan_drift_inspector_register(void)
       "drift.pll-reset",
       "PLL reset signal"));
 
+  SU_TRY_FAIL(
+    suscan_config_desc_add_field(
+      desc,
+      SUSCAN_FIELD_TYPE_BOOLEAN,
+      SU_FALSE,
+      "drift.decimate",
+      "Track on a decimated channel"));
+
   SU_TRY_FAIL(
     suscan_config_desc_add_field(
       desc,
@@ -38,6 +38,8 @@
 #define SUSCAN_FSK_INSPECTOR_DEFAULT_EQ_MU     1e-3
 #define SUSCAN_FSK_INSPECTOR_DEFAULT_EQ_LENGTH 20
 #define SUSCAN_FSK_INSPECTOR_MAX_MF_SPAN       1024
+#define SUSCAN_FSK_INSPECTOR_BLOCK_SIZE        1024
+#define SUSCAN_FSK_INSPECTOR_CD_BUFSIZ         32
 
 /*
  * Spike durations measured in symbol times
@@ -72,6 +74,11 @@ struct suscan_fsk_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
   SUCOMPLEX           phase;      /* Local oscillator phase */
   SUCOMPLEX           last;       /* Last processed sample */
+
+  /* Scratch buffers for block processing */
+  SUCOMPLEX           block[SUSCAN_FSK_INSPECTOR_BLOCK_SIZE];
+  SUCOMPLEX           sc_block[SUSCAN_FSK_INSPECTOR_BLOCK_SIZE];
+  SUCOMPLEX           sym_block[SUSCAN_FSK_INSPECTOR_CD_BUFSIZ];
 };
 
 SUSCOUNT
@@ -146,7 +153,7 @@ suscan_fsk_inspector_new(const struct suscan_inspector_sampling_info *sinfo)
           &new->cd,
           1., /* Loop gain */
           .5 * bw, /* Baudrate hint */
-          32  /* Buffer size */),
+          SUSCAN_FSK_INSPECTOR_CD_BUFSIZ),
       goto fail);
 
   /* Fixed baudrate sampler */
@@ -305,74 +312,185 @@ suscan_fsk_inspector_commit_config(void *private)
   }
 }
 
-SUSDIFF
-suscan_fsk_inspector_feed(
-    void *private,
-    suscan_inspector_t *insp,
+/************************** Block FSK pipeline *******************************/
+/*
+ * Every stage runs over a whole block before the next one starts, in place
+ * in self->block. Stage selection (gain control, discriminator, matched
+ * filter and clock recovery) happens once per block instead of once per
+ * sample, and the arithmetic of each stage is unchanged, so the output
+ * matches the former per-sample loop.
+ */
+
+/* Re-center carrier and perform gain control */
+SUPRIVATE void
+suscan_fsk_inspector_condition_block(
+    struct suscan_fsk_inspector *self,
     const SUCOMPLEX *x,
-    SUSCOUNT count)
+    SUCOMPLEX *y,
+    SUSCOUNT len)
 {
   SUSCOUNT i;
-  SUCOMPLEX const_gain = 0;
-  SUCOMPLEX det_x;
-  SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  SUCOMPLEX last = 0;
+  SUFLOAT gain;
+
+  /*
+   * The oscillator stays at 0 Hz unless an offset is set, and then it
+   * only yields 1. Skip the mixer altogether in that case.
+   */
+  if (su_ncqo_get_freq(&self->lo) == 0) {
+    memcpy(y, x, len * sizeof(SUCOMPLEX));
+  } else {
+    for (i = 0; i < len; ++i)
+      y[i] = x[i] * SU_C_CONJ(su_ncqo_read(&self->lo));
+  }
 
-  struct suscan_fsk_inspector *fsk_insp =
-      (struct suscan_fsk_inspector *) private;
+  switch (self->cur_params.gc.gc_ctrl) {
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
+      gain = self->cur_params.gc.gc_gain;
+      for (i = 0; i < len; ++i)
+        y[i] = 2 * gain * y[i];
+      break;
+
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
+      for (i = 0; i < len; ++i)
+        y[i] = 2 * su_agc_feed(&self->agc, y[i]);
+      break;
+  }
+}
 
-  last = fsk_insp->last;
+/*
+ * We are actually encoding frequency information in the phase. This
+ * is intentional, as the UI quantizes the argument of each sample.
+ */
+SUPRIVATE void
+suscan_fsk_inspector_discriminate_block(
+    struct suscan_fsk_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUCOMPLEX last = self->last;
+  SUCOMPLEX curr;
+
+  if (self->cur_params.fsk.quad_demod) {
+    for (i = 0; i < len; ++i) {
+      curr = y[i];
+      y[i] = curr * SU_C_CONJ(last);
+      last = curr;
+    }
+  } else {
+    for (i = 0; i < len; ++i) {
+      curr = y[i];
+      y[i] = (curr * SU_C_CONJ(last)) /
+        (.5 * (curr * SU_C_CONJ(curr) + last * SU_C_CONJ(last)) + 1e-8);
+      last = curr;
+    }
+  }
 
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&fsk_insp->lo));
+  self->last = last;
+}
 
-    /* Perform gain control */
-    switch (fsk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        const_gain = 2 * fsk_insp->cur_params.gc.gc_gain * det_x;
-        break;
+/* Save for subcarrier inspection */
+SUPRIVATE void
+suscan_fsk_inspector_feed_sc_block(
+    struct suscan_fsk_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
 
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        const_gain = 2 * su_agc_feed(&fsk_insp->agc, det_x);
-        break;
+  for (i = 0; i < len; ++i)
+    self->sc_block[i] = SU_C_ARG(y[i]);
+
+  (void) suscan_inspector_feed_sc_stuner(insp, self->sc_block, len);
+}
+
+/*
+ * Symbol sampling, either at a fixed baudrate or with clock recovery. The
+ * clock detector is fed in chunks of up to SUSCAN_FSK_INSPECTOR_CD_BUFSIZ
+ * samples, and the symbols of each chunk are read and pushed at once. As
+ * it yields at most one symbol per sample, none of them is overwritten in
+ * its symbol buffer before being read.
+ */
+SUPRIVATE void
+suscan_fsk_inspector_sample_block(
+    struct suscan_fsk_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i, j, chunk;
+  SUSDIFF got;
+  SUCOMPLEX output;
+
+  if (self->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+    for (i = 0; i < len; ++i) {
+      output = y[i];
+      if (su_sampler_feed(&self->sampler, &output))
+        suscan_inspector_push_sample(insp, output * .75 * self->phase);
     }
+  } else {
+    /* Automatic baudrate control enabled */
+    for (i = 0; i < len; i += chunk) {
+      chunk = SU_MIN(len - i, SUSCAN_FSK_INSPECTOR_CD_BUFSIZ);
 
-    /*
-     * We are actually encoding frequency information in the phase. This
-     * is intentional, as the UI quantizes the argument of each sample.
-     */
-    if (fsk_insp->cur_params.fsk.quad_demod)
-      det_x = const_gain * SU_C_CONJ(last);
-    else
-      det_x = (const_gain * SU_C_CONJ(last)) /
-      (.5 * (const_gain * SU_C_CONJ(const_gain) + last * SU_C_CONJ(last)) + 1e-8);
+      for (j = 0; j < chunk; ++j)
+        su_clock_detector_feed(&self->cd, y[i + j]);
 
-    last = const_gain;
+      got = su_clock_detector_read(
+          &self->cd,
+          self->sym_block,
+          SUSCAN_FSK_INSPECTOR_CD_BUFSIZ);
+
+      for (j = 0; j < got; ++j)
+        self->sym_block[j] = self->sym_block[j] * .75 * self->phase;
+
+      if (got > 0)
+        (void) suscan_inspector_push_sample_buffer(insp, self->sym_block, got);
+    }
+  }
+}
 
-    /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, SU_C_ARG(det_x));
+SUSDIFF
+suscan_fsk_inspector_feed(
+    void *private,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SUSCOUNT i = 0;
+  SUSCOUNT len;
+  SUFLOAT period;
+  struct suscan_fsk_inspector *self = (struct suscan_fsk_inspector *) private;
+
+  /* The clock detector yields at most one symbol per sample */
+  period =
+    self->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL
+    ? su_sampler_get_period(&self->sampler)
+    : 1;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
+    len = suscan_inspector_get_block_len(
+        insp,
+        period,
+        count - i,
+        SUSCAN_FSK_INSPECTOR_BLOCK_SIZE);
+
+    suscan_fsk_inspector_condition_block(self, x + i, self->block, len);
+    suscan_fsk_inspector_discriminate_block(self, self->block, len);
+    suscan_fsk_inspector_feed_sc_block(self, insp, self->block, len);
 
     /* Add matched filter, if enabled */
-    if (fsk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&fsk_insp->mf, det_x);
+    if (self->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+      su_iir_filt_feed_bulk(&self->mf, self->block, self->block, len);
 
-    /* Check if channel sampler is enabled */
-    if (fsk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&fsk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&fsk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&fsk_insp->cd, &output, 1) == 1;
-    }
+    suscan_fsk_inspector_sample_block(self, insp, self->block, len);
 
-    if (new_sample)
-      suscan_inspector_push_sample(insp, output * .75 * fsk_insp->phase);
-  }
+    i += len;
 
-  fsk_insp->last = last;
+    if (suscan_inspector_get_output_length(insp) >= insp->sample_msg_watermark)
+      break;
+  }
 
   return i;
 }
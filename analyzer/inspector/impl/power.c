@@ -61,6 +61,9 @@
  */
 #define SU_POWER_INSPECTOR_VARIANCE_SCALING (35. / 18.)
 
+/* Below this size, frame energies are computed with a plain loop */
+#define SU_POWER_INSPECTOR_PAIRWISE_LEAF 64
+
 /*
  * The power inspector works by computing the energy of the received samples,
  * and dividing them by the number of samples. The Parseval theorem states
@@ -112,7 +115,7 @@ struct suscan_power_inspector {
   /* For frequency domain */
   SUFLOAT  K;
   SUFLOAT  Kr;
-  SUSCOUNT Kr_total_samples; /* floor(Kr) * fft_bins */
+  SUSCOUNT Kr_frames; /* floor(Kr) */
   
   SUFLOAT  alpha, beta;
   SUFLOAT  E_p;
@@ -295,94 +298,6 @@ suscan_power_inspector_feed_time_domain_volk(
   return i;
 }
 
-SUINLINE SUSDIFF
-suscan_power_inspector_feed_freq_domain_volk(
-  struct suscan_power_inspector *self,
-  const SUCOMPLEX *x,
-    SUSCOUNT count)
-{
-  suscan_inspector_t *insp = self->insp;
-  SUSCOUNT i, max, max_n, ptr;
-  SUFLOAT acc, t, y, c;
-  SUFLOAT E, E_t, E_n, E_p;
-  SUSCOUNT avail = 0;
-  lv_32fc_t power;
-
-  acc   = self->pwr_kahan_acc;
-  c     = self->pwr_kahan_c;
-  ptr   = self->pwr_count;
-  max   = self->Kr_total_samples;
-  E     = self->E;
-  E_p   = self->E_p;
-  max_n = max + self->samp_info.fft_bins;
-
-  i = 0;
-
-  if (count != self->samp_info.fft_bins)
-    return count;
-  
-  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
-    if (ptr == 0) {
-      self->Kr = self->K - self->beta;
-      self->alpha = self->Kr - SU_FLOOR(self->Kr);
-      max = SU_FLOOR(self->Kr) * self->samp_info.fft_bins;
-      max_n = max + self->samp_info.fft_bins;
-      E = 0;
-    }
-    
-    if (ptr < max) {
-      avail = SU_MIN(count - i, max - ptr);
-    } else if (ptr < max_n) {
-      avail = SU_MIN(count - i, max_n - ptr);
-    } else {
-      SU_ERROR("Error condition inside power meter (ptr >= max_n?)\n");
-      return 0;
-    }
-
-    volk_32fc_x2_conjugate_dot_prod_32fc(&power, x + i, x + i, avail);
-
-    y = SU_C_REAL(power) - c;
-    t = acc + y;
-
-    c = (t - acc) - y;
-    acc = t;
-
-    ptr += avail;
-
-    if (ptr == max) {
-      /* First floor(Kr) samples: calculate E. */
-      E = acc;
-
-      acc = 0;
-      c   = 0;
-    } else if (ptr == max_n) {
-      /* Got next. */
-      E_n = acc;
-      E_t = self->beta * E_p + E + self->alpha * E_n;
-
-      suscan_inspector_push_sample(
-        insp,
-        E_t / self->K * self->inv_gain);
-      E_p = E_n;
-      self->beta = 1 - self->alpha;
-
-      ptr = 0;
-      acc = 0;
-      c   = 0;
-    }
-
-    i += avail;
-  }
-
-  self->Kr_total_samples = max;
-  self->pwr_kahan_acc    = acc;
-  self->pwr_kahan_c      = c;
-  self->pwr_count        = ptr;
-  self->E                = E;
-  self->E_p              = E_p;
-
-  return i;
-}
 #else
 SUINLINE SUSDIFF
 suscan_power_inspector_feed_time_domain(
@@ -424,6 +339,40 @@ suscan_power_inspector_feed_time_domain(
   return i;
 }
 
+#endif
+
+/*
+ * Energy of a whole FFT frame. Pairwise summation keeps the rounding error
+ * growing as O(log n) instead of O(n), without the extra work of Kahan
+ * sums on every bin. The leaves are plain loops the compiler can vectorize.
+ */
+SUPRIVATE SUFLOAT
+suscan_power_inspector_frame_energy(const SUCOMPLEX *x, SUSCOUNT count)
+{
+  SUSCOUNT i, half;
+  SUFLOAT acc = 0;
+
+  if (count <= SU_POWER_INSPECTOR_PAIRWISE_LEAF) {
+    for (i = 0; i < count; ++i)
+      acc += SU_C_REAL(x[i]) * SU_C_REAL(x[i])
+        + SU_C_IMAG(x[i]) * SU_C_IMAG(x[i]);
+
+    return acc;
+  }
+
+  half = count >> 1;
+
+  return suscan_power_inspector_frame_energy(x, half)
+    + suscan_power_inspector_frame_energy(x + half, count - half);
+}
+
+/*
+ * In frequency mode, every call delivers the FFT bins of a channel frame
+ * straight from the channelizer. Since all integration boundaries fall
+ * at frame boundaries, we work with whole frames: pwr_count counts frames
+ * and Kr_frames is floor(Kr). Frame energies are still Kahan-summed, as
+ * integration times may span thousands of them.
+ */
 SUINLINE SUSDIFF
 suscan_power_inspector_feed_freq_domain(
   struct suscan_power_inspector *self,
@@ -431,73 +380,71 @@ suscan_power_inspector_feed_freq_domain(
     SUSCOUNT count)
 {
   suscan_inspector_t *insp = self->insp;
-  SUSCOUNT i, max, max_n, ptr;
-  SUFLOAT acc, t, y, c, power;
-  SUFLOAT E, E_t, E_n, E_p;
-
-  acc   = self->pwr_kahan_acc;
-  c     = self->pwr_kahan_c;
-  ptr   = self->pwr_count;
-  max   = self->Kr_total_samples;
-  E     = self->E;
-  E_p   = self->E_p;
-  max_n = max + self->samp_info.fft_bins;
-
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* First sample: initialize Kr and alpha */
-    if (ptr == 0) {
-      self->Kr = self->K - self->beta;
+  SUSCOUNT i, bins = self->samp_info.fft_bins, frames, whole;
+  SUFLOAT acc, t, y, c;
+  SUFLOAT E, E_t, E_n, energy;
+
+  acc    = self->pwr_kahan_acc;
+  c      = self->pwr_kahan_c;
+  frames = self->pwr_count;
+  whole  = self->Kr_frames;
+  E      = self->E;
+
+  for (
+    i = 0;
+    i + bins <= count && suscan_inspector_sampler_buf_avail(insp) > 0;
+    i += bins) {
+    /* First frame: initialize Kr and alpha */
+    if (frames == 0) {
+      self->Kr    = self->K - self->beta;
       self->alpha = self->Kr - SU_FLOOR(self->Kr);
-      max = SU_FLOOR(self->Kr) * self->samp_info.fft_bins;
-      max_n = max + self->samp_info.fft_bins;
+      whole       = SU_FLOOR(self->Kr);
       E = 0;
     }
 
-    power = SU_C_REAL(x[i] * SU_C_CONJ(x[i]));
-    
-    y = power - c;
-    t = acc + y;
+    energy = suscan_power_inspector_frame_energy(x + i, bins);
 
-    c = (t - acc) - y;
-    acc = t;
+    if (frames < whole) {
+      y = energy - c;
+      t = acc + y;
 
-    ++ptr;
-    
-    if (ptr == max) {
-      /* First floor(Kr) samples: calculate E. */
-      E = acc;
-      acc = 0;
-      c   = 0;
-    } else if (ptr == max_n) {
-      SUFLOAT measurement;
+      c = (t - acc) - y;
+      acc = t;
+
+      if (++frames == whole) {
+        /* First floor(Kr) frames: calculate E. */
+        E = acc;
+        acc = 0;
+        c   = 0;
+      }
+    } else {
       /* Got next. */
+      E_n = energy;
+      E_t = self->beta * self->E_p + E + self->alpha * E_n;
 
-      E_n = acc;
-      E_t = self->beta * E_p + E + self->alpha * E_n;
+      suscan_inspector_push_sample(insp, E_t / self->K * self->inv_gain);
 
-      measurement = E_t / self->K * self->inv_gain;
-      
-      suscan_inspector_push_sample(insp, measurement);
-      
-      E_p = E_n;
+      self->E_p  = E_n;
       self->beta = 1 - self->alpha;
 
-      ptr = 0;
-      acc = 0;
-      c   = 0;
+      frames = 0;
+      acc    = 0;
+      c      = 0;
     }
   }
 
-  self->Kr_total_samples = max;
-  self->pwr_kahan_acc    = acc;
-  self->pwr_kahan_c      = c;
-  self->pwr_count        = ptr;
-  self->E                = E;
-  self->E_p              = E_p;
+  /* Incomplete frames are not meaningful here. Drop them. */
+  if (i + bins > count)
+    i = count;
+
+  self->Kr_frames     = whole;
+  self->pwr_kahan_acc = acc;
+  self->pwr_kahan_c   = c;
+  self->pwr_count     = frames;
+  self->E             = E;
 
   return i;
 }
-#endif
 
 SUSDIFF
 suscan_power_inspector_feed(
@@ -524,14 +471,12 @@ suscan_power_inspector_feed(
     return count;
   
   if (self->stable) {
-#ifdef HAVE_VOLK_ACCELERATION
     if (self->frequency_mode)
-      return suscan_power_inspector_feed_freq_domain_volk(self, x, count);
+      return suscan_power_inspector_feed_freq_domain(self, x, count);
+#ifdef HAVE_VOLK_ACCELERATION
     else
       return suscan_power_inspector_feed_time_domain_volk(self, x, count);
 #else
-    if (self->frequency_mode)
-      return suscan_power_inspector_feed_freq_domain(self, x, count);
     else
       return suscan_power_inspector_feed_time_domain(self, x, count);
 #endif
@@ -554,6 +499,7 @@ SUPRIVATE struct suscan_inspector_interface iface = {
     .name = "power",
     .desc = "Channel power",
     .frequency_domain = SU_TRUE,
+    .direct_feed = SU_TRUE,
     .open = suscan_power_inspector_open,
     .get_config = suscan_power_inspector_get_config,
     .parse_config = suscan_power_inspector_parse_config,
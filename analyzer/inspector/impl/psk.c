@@ -26,6 +26,7 @@
 #include <sigutils/pll.h>
 #include <sigutils/clock.h>
 #include <sigutils/equalizer.h>
+#include <sigutils/taps.h>
 
 #include <analyzer/version.h>
 
@@ -33,12 +34,15 @@
 #include "inspector/params.h"
 
 #include "inspector/inspector.h"
+#include "inspector/fastconv.h"
 
 /* Some default PSK demodulator parameters */
 #define SUSCAN_PSK_INSPECTOR_DEFAULT_ROLL_OFF  .35
 #define SUSCAN_PSK_INSPECTOR_DEFAULT_EQ_MU     1e-3
 #define SUSCAN_PSK_INSPECTOR_DEFAULT_EQ_LENGTH 20
 #define SUSCAN_PSK_INSPECTOR_MAX_MF_SPAN       1024
+#define SUSCAN_PSK_INSPECTOR_FAST_MF_MIN_SPAN  128
+#define SUSCAN_PSK_INSPECTOR_BLOCK_SIZE        1024
 
 /*
  * Spike durations measured in symbol times
@@ -76,6 +80,13 @@ struct suscan_psk_inspector {
   su_ncqo_t           lo;         /* Oscillator for manual carrier offset */
 
   SUCOMPLEX           phase;      /* Local oscillator phase */
+
+  /* Matched filter through FFTs, used instead of mf at long spans */
+  suscan_fastconv_t  *fast_mf;
+
+  /* Scratch buffers for block processing */
+  SUCOMPLEX           block[SUSCAN_PSK_INSPECTOR_BLOCK_SIZE];
+  SUCOMPLEX           symbols[SUSCAN_PSK_INSPECTOR_BLOCK_SIZE];
 };
 
 SUSCOUNT
@@ -131,6 +142,9 @@ suscan_psk_inspector_destroy(struct suscan_psk_inspector *insp)
 
   su_sampler_finalize(&insp->sampler);
 
+  if (insp->fast_mf != NULL)
+    suscan_fastconv_destroy(insp->fast_mf);
+
   free(insp);
 }
 
@@ -292,6 +306,43 @@ suscan_psk_inspector_parse_config(void *private, const suscan_config_t *config)
 
 }
 
+/*
+ * Direct-form matched filters cost one multiplication per tap and sample.
+ * Past a few hundred taps, filtering whole blocks through FFTs is cheaper,
+ * and yields the same output.
+ */
+SUPRIVATE void
+suscan_psk_inspector_update_fast_mf(
+    struct suscan_psk_inspector *self,
+    SUSCOUNT span,
+    SUFLOAT period)
+{
+  suscan_fastconv_t *fast_mf = NULL;
+  SUFLOAT *taps = NULL;
+
+  if (span >= SUSCAN_PSK_INSPECTOR_FAST_MF_MIN_SPAN) {
+    SU_TRYCATCH(taps = malloc(span * sizeof(SUFLOAT)), goto done);
+
+    /* Same taps as su_iir_rrc_init */
+    su_taps_rrc_init(taps, period, self->cur_params.mf.mf_rolloff, span);
+
+    if ((fast_mf = suscan_fastconv_new(
+        taps,
+        span,
+        SUSCAN_PSK_INSPECTOR_BLOCK_SIZE)) == NULL)
+      SU_WARNING("Cannot create FFT matched filter, using direct form\n");
+  }
+
+done:
+  if (taps != NULL)
+    free(taps);
+
+  if (self->fast_mf != NULL)
+    suscan_fastconv_destroy(self->fast_mf);
+
+  self->fast_mf = fast_mf;
+}
+
 /* This method is called inside the inspector mutex */
 void
 suscan_psk_inspector_commit_config(void *private)
@@ -301,6 +352,7 @@ suscan_psk_inspector_commit_config(void *private)
   SUBOOL costas_changed;
   SUFLOAT actual_baud;
   SUFLOAT sym_period;
+  SUSCOUNT span;
   su_costas_t costas;
 
   su_iir_filt_t mf = su_iir_filt_INITIALIZER;
@@ -344,15 +396,17 @@ suscan_psk_inspector_commit_config(void *private)
 
   /* Update matched filter */
   if (mf_changed && sym_period > 0) {
+    span = SU_CEIL(suscan_psk_inspector_mf_span(6 * sym_period));
     if (!su_iir_rrc_init(
         &mf,
-        SU_CEIL(suscan_psk_inspector_mf_span(6 * sym_period)),
+        span,
         SU_CEIL(sym_period),
         insp->cur_params.mf.mf_rolloff)) {
       SU_ERROR("No memory left to update matched filter!\n");
     } else {
       su_iir_filt_finalize(&insp->mf);
       insp->mf = mf;
+      suscan_psk_inspector_update_fast_mf(insp, span, SU_CEIL(sym_period));
     }
   }
 
@@ -393,6 +447,106 @@ suscan_psk_inspector_commit_config(void *private)
   }
 }
 
+/************************** Block PSK receiver chain *************************/
+/*
+ * Each stage of the receiver runs over a whole block, in place in
+ * self->block. Stage selection happens once per block, and the inner
+ * loops of the carrier and clock recovery stages only touch their own
+ * state.
+ */
+
+/* Re-center carrier and perform gain control */
+SUPRIVATE void
+suscan_psk_inspector_condition_block(
+    struct suscan_psk_inspector *self,
+    const SUCOMPLEX *x,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+  SUFLOAT gain;
+
+  for (i = 0; i < len; ++i)
+    y[i] = x[i] * SU_C_CONJ(su_ncqo_read(&self->lo)) * self->phase;
+
+  switch (self->cur_params.gc.gc_ctrl) {
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
+      gain = 2 * self->cur_params.gc.gc_gain;
+      for (i = 0; i < len; ++i)
+        y[i] *= gain;
+      break;
+
+    case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
+      for (i = 0; i < len; ++i)
+        y[i] = 2 * su_agc_feed(&self->agc, y[i]);
+      break;
+  }
+}
+
+/* Perform frequency correction */
+SUPRIVATE void
+suscan_psk_inspector_costas_block(
+    struct suscan_psk_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < len; ++i) {
+    su_costas_feed(&self->costas, y[i]);
+    y[i] = self->costas.y;
+  }
+}
+
+/* Add matched filter, through FFTs for long spans */
+SUPRIVATE void
+suscan_psk_inspector_mf_block(
+    struct suscan_psk_inspector *self,
+    SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  if (self->fast_mf != NULL)
+    suscan_fastconv_feed(self->fast_mf, y, y, len);
+  else
+    su_iir_filt_feed_bulk(&self->mf, y, y, len);
+}
+
+/* Symbol sampling and channel equalization */
+SUPRIVATE void
+suscan_psk_inspector_sample_block(
+    struct suscan_psk_inspector *self,
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *y,
+    SUSCOUNT len)
+{
+  SUSCOUNT i, n = 0;
+  SUCOMPLEX output;
+
+  if (self->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
+    for (i = 0; i < len; ++i) {
+      output = y[i];
+      if (su_sampler_feed(&self->sampler, &output))
+        self->symbols[n++] = output;
+    }
+  } else {
+    /* Automatic baudrate control enabled */
+    for (i = 0; i < len; ++i) {
+      su_clock_detector_feed(&self->cd, y[i]);
+      if (su_clock_detector_read(&self->cd, &output, 1) == 1)
+        self->symbols[n++] = output;
+    }
+  }
+
+  /* Apply channel equalizer, if enabled */
+  if (self->cur_params.eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA)
+    for (i = 0; i < n; ++i)
+      self->symbols[i] = su_equalizer_feed(&self->eq, self->symbols[i]);
+
+  /* Reduce amplitude so it fits in the constellation window */
+  for (i = 0; i < n; ++i)
+    suscan_inspector_push_sample(insp, self->symbols[i] * .75);
+}
+
 SUSDIFF
 suscan_psk_inspector_feed(
     void *private,
@@ -400,61 +554,41 @@ suscan_psk_inspector_feed(
     const SUCOMPLEX *x,
     SUSCOUNT count)
 {
-  SUSCOUNT i;
-  SUCOMPLEX det_x;
-  SUCOMPLEX output;
-  SUBOOL new_sample = SU_FALSE;
-  struct suscan_psk_inspector *psk_insp =
-      (struct suscan_psk_inspector *) private;
-
-  for (i = 0; i < count && suscan_inspector_sampler_buf_avail(insp) > 0; ++i) {
-    /* Re-center carrier */
-    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&psk_insp->lo)) * psk_insp->phase;
-
-    /* Perform gain control */
-    switch (psk_insp->cur_params.gc.gc_ctrl) {
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_MANUAL:
-        det_x *= 2 * psk_insp->cur_params.gc.gc_gain;
-        break;
-
-      case SUSCAN_INSPECTOR_GAIN_CONTROL_AUTOMATIC:
-        det_x  = 2 * su_agc_feed(&psk_insp->agc, det_x);
-        break;
-    }
+  SUSCOUNT i = 0;
+  SUSCOUNT len;
+  SUFLOAT period;
+  struct suscan_psk_inspector *self = (struct suscan_psk_inspector *) private;
 
-    /* Perform frequency correction */
-    if (psk_insp->cur_params.fc.fc_ctrl
-        != SUSCAN_INSPECTOR_CARRIER_CONTROL_MANUAL) {
-      su_costas_feed(&psk_insp->costas, det_x);
-      det_x = psk_insp->costas.y;
-    }
+  /* The clock detector yields at most one symbol per sample */
+  period =
+    self->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL
+    ? su_sampler_get_period(&self->sampler)
+    : 1;
+
+  while (i < count && suscan_inspector_sampler_buf_avail(insp) > 0) {
+    len = suscan_inspector_get_block_len(
+        insp,
+        period,
+        count - i,
+        SUSCAN_PSK_INSPECTOR_BLOCK_SIZE);
+
+    suscan_psk_inspector_condition_block(self, x + i, self->block, len);
+
+    if (self->cur_params.fc.fc_ctrl != SUSCAN_INSPECTOR_CARRIER_CONTROL_MANUAL)
+      suscan_psk_inspector_costas_block(self, self->block, len);
 
     /* Save for subcarrier inspection */
-    suscan_inspector_feed_sc_sample(insp, det_x);
+    (void) suscan_inspector_feed_sc_stuner(insp, self->block, len);
 
-    /* Add matched filter, if enabled */
-    if (psk_insp->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
-      det_x = su_iir_filt_feed(&psk_insp->mf, det_x);
+    if (self->cur_params.mf.mf_conf == SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL)
+      suscan_psk_inspector_mf_block(self, self->block, len);
 
-    /* Check if channel sampler is enabled */
-    if (psk_insp->cur_params.br.br_ctrl == SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL) {
-      output = det_x;
-      new_sample = su_sampler_feed(&psk_insp->sampler, &output);
-    } else {
-      /* Automatic baudrate control enabled */
-      su_clock_detector_feed(&psk_insp->cd, det_x);
-      new_sample = su_clock_detector_read(&psk_insp->cd, &output, 1) == 1;
-    }
+    suscan_psk_inspector_sample_block(self, insp, self->block, len);
 
-    /* Apply channel equalizer, if enabled */
-    if (new_sample) {
-      if (psk_insp->cur_params.eq.eq_conf == SUSCAN_INSPECTOR_EQUALIZER_CMA) {
-        output = su_equalizer_feed(&psk_insp->eq, output);
-      }
+    i += len;
 
-      /* Reduce amplitude so it fits in the constellation window */
-      suscan_inspector_push_sample(insp, output * .75);
-    }
+    if (suscan_inspector_get_output_length(insp) >= insp->sample_msg_watermark)
+      break;
   }
 
   return i;
@@ -498,6 +632,9 @@ suscan_psk_inspector_register(void)
   /* Add some estimators */
   (void) suscan_inspector_interface_add_estimator(&iface, "baud-fac");
   (void) suscan_inspector_interface_add_estimator(&iface, "baud-nonlinear");
+  (void) suscan_inspector_interface_add_estimator(&iface, "baud-fam");
+  (void) suscan_inspector_interface_add_estimator(&iface, "offset-fam");
+  (void) suscan_inspector_interface_add_estimator(&iface, "order-fam");
 
   /* Add applicable spectrum sources */
   (void) suscan_inspector_interface_add_spectsrc(&iface, "psd");
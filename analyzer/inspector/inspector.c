@@ -408,6 +408,7 @@ static struct suscan_inspector_factory_class g_sc_factory = {
   .set_domain          = suscan_sc_inspector_factory_set_domain,
   .get_abs_freq        = suscan_sc_inspector_factory_get_abs_freq,
   .set_freq_correction = suscan_sc_inspector_factory_set_freq_correction,
+  .batched             = SU_TRUE,
   .dtor                = suscan_sc_inspector_factory_dtor
 };
 
@@ -418,13 +419,55 @@ suscan_inspector_register_factory(void)
 }
 
 /********************* Inspector loop methods ***************************/
+/*
+ * Sends the samples pushed so far (if any) as a sample batch. Inspectors
+ * call this before changing the layout of their output, so that samples
+ * produced with the old layout never reach the client with the new one.
+ * If the batch cannot be sent, pending samples are discarded.
+ */
+SUBOOL
+suscan_inspector_flush_samples(suscan_inspector_t *insp)
+{
+  struct suscan_analyzer_sample_batch_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if (insp->sampler_ptr == 0)
+    return SU_TRUE;
+
+  SU_TRYCATCH(
+      msg = suscan_analyzer_sample_batch_msg_new(
+          insp->inspector_id,
+          suscan_inspector_get_output_buffer(insp),
+          suscan_inspector_get_output_length(insp)),
+      goto done);
+
+  SU_TRYCATCH(
+      suscan_mq_write(
+        insp->mq_out, 
+        SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES, 
+        msg),
+      goto done);
+
+  msg = NULL; /* We don't own this anymore */
+
+  ok = SU_TRUE;
+
+done:
+  /* Reset size */
+  insp->sampler_ptr = 0;
+
+  if (msg != NULL)
+    suscan_analyzer_sample_batch_msg_destroy(msg);
+
+  return ok;
+}
+
 SUBOOL
 suscan_inspector_sampler_loop(
     suscan_inspector_t *insp,
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count)
 {
-  struct suscan_analyzer_sample_batch_msg *msg = NULL;
   unsigned int length;
 
   SUSDIFF fed;
@@ -440,26 +483,9 @@ suscan_inspector_sampler_loop(
     length = suscan_inspector_get_output_length(insp);
 
     if (length > 0 && (length >= insp->sample_msg_watermark
-        || suscan_inspector_sampler_buf_avail(insp) == 0)) {
+        || suscan_inspector_sampler_buf_full(insp))) {
       /* New samples produced by sampler: send to client */
-      SU_TRYCATCH(
-          msg = suscan_analyzer_sample_batch_msg_new(
-              insp->inspector_id,
-              suscan_inspector_get_output_buffer(insp),
-              suscan_inspector_get_output_length(insp)),
-          goto fail);
-
-      /* Reset size */
-      insp->sampler_ptr = 0;
-
-      SU_TRYCATCH(
-          suscan_mq_write(
-            insp->mq_out, 
-            SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES, 
-            msg),
-          goto fail);
-
-      msg = NULL; /* We don't own this anymore */
+      SU_TRYCATCH(suscan_inspector_flush_samples(insp), goto fail);
     }
 
     samp_buf   += fed;
@@ -469,9 +495,6 @@ suscan_inspector_sampler_loop(
   return SU_TRUE;
 
 fail:
-  if (msg != NULL)
-    suscan_analyzer_sample_batch_msg_destroy(msg);
-
   return SU_FALSE;
 }
 
@@ -483,6 +506,7 @@ suscan_inspector_send_freq_domain_psd(
 {
   struct suscan_analyzer_inspector_msg *msg = NULL;
   suscan_inspector_t *insp = (suscan_inspector_t *) userdata;
+  SUFLOAT *psd;
   SUSCOUNT i;
   SUBOOL ok = SU_FALSE;
   SUFLOAT K;
@@ -504,8 +528,11 @@ suscan_inspector_send_freq_domain_psd(
       msg->spectrum_data = malloc(size * sizeof(SUFLOAT)),
       goto done);
 
+  /* Written as real arithmetic so that it vectorizes */
+  psd = msg->spectrum_data;
   for (i = 0; i < size; ++i)
-    msg->spectrum_data[i] = K * SU_C_REAL(x[i] * SU_C_CONJ(x[i]));
+    psd[i] = K * (SU_C_REAL(x[i]) * SU_C_REAL(x[i])
+      + SU_C_IMAG(x[i]) * SU_C_IMAG(x[i]));
 
   /* Provide a more accurate real timestamp */
   gettimeofday(&msg->rt_time, NULL);
@@ -537,6 +564,14 @@ suscan_inspector_spectrum_loop(
   SUSDIFF fed;
 
   if (insp->spectsrc_index > 0) {
+    /* 
+     * The client is not keeping up. Spectra are the first thing to go,
+     * and there is no point in computing them either.
+     */
+    if (suscan_mq_get_count(insp->mq_out) 
+      > SUSCAN_INSPECTOR_SPECTRUM_MAX_QUEUED)
+      return SU_TRUE;
+
     src = insp->spectsrc_list[insp->spectsrc_index - 1];
 
     if (suscan_inspector_is_freq_domain(insp)) {
@@ -604,62 +639,262 @@ done:
   return ok;
 }
 
+SUPRIVATE SUBOOL
+suscan_inspector_publish_estimates(suscan_inspector_t *insp)
+{
+  struct suscan_analyzer_inspector_msg *msg = NULL;
+  unsigned int i;
+
+  for (i = 0; i < insp->estimator_count; ++i)
+    if (suscan_estimator_is_enabled(insp->estimator_list[i])
+        && suscan_estimator_update(insp->estimator_list[i])) {
+      SU_TRYCATCH(
+          msg = suscan_analyzer_inspector_msg_new(
+              SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
+              rand()),
+          goto fail);
+
+      msg->enabled = SU_TRUE;
+      msg->estimator_id = i;
+      msg->inspector_id = insp->inspector_id;
+      SU_TRYCATCH(
+          suscan_estimator_get_cached(
+              insp->estimator_list[i],
+              &msg->value,
+              &msg->rt_time),
+          goto fail);
+
+      SU_TRYCATCH(
+          suscan_mq_write(
+              insp->mq_out,
+              SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
+              msg),
+          goto fail);
+      msg = NULL;
+    }
+
+  return SU_TRUE;
+
+fail:
+  if (msg != NULL)
+    suscan_analyzer_inspector_msg_destroy(msg);
+
+  return SU_FALSE;
+}
+
+/*
+ * Estimators are duty-cycled: once every interval_estimator seconds (or
+ * when explicitly requested) a window of estimator_window samples is
+ * fed to them, and the resulting estimates are cached and sent. Outside
+ * these windows, estimators cost nothing.
+ */
 SUBOOL
 suscan_inspector_estimator_loop(
     suscan_inspector_t *insp,
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count)
 {
-  struct suscan_analyzer_inspector_msg *msg = NULL;
-  unsigned int i;
-  uint64_t now;
-  SUFLOAT value;
-  SUFLOAT seconds;
+  uint64_t now, end, rest;
+  SUSCOUNT chunk;
 
-  /* Check esimator state and update clients */
-  if (insp->interval_estimator > 0) {
-    now = suscan_gettime();
-    seconds = (now - insp->last_estimator) * 1e-9;
-    if (seconds >= insp->interval_estimator) {
-      insp->last_estimator = now;
-      for (i = 0; i < insp->estimator_count; ++i)
-        if (suscan_estimator_is_enabled(insp->estimator_list[i])) {
-          if (suscan_estimator_is_enabled(insp->estimator_list[i]))
-            SU_TRYCATCH(
-                suscan_estimator_feed(
-                    insp->estimator_list[i],
-                    samp_buf,
-                    samp_count),
-                goto fail);
-
-          if (suscan_estimator_read(insp->estimator_list[i], &value)) {
-            SU_TRYCATCH(
-                msg = suscan_analyzer_inspector_msg_new(
-                    SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ESTIMATOR,
-                    rand()),
-                goto fail);
-
-            msg->enabled = SU_TRUE;
-            msg->estimator_id = i;
-            msg->value = value;
-            msg->inspector_id = insp->inspector_id;
-
-            SU_TRYCATCH(
-                suscan_mq_write(
-                    insp->mq_out,
-                    SUSCAN_ANALYZER_MESSAGE_TYPE_INSPECTOR,
-                    msg),
-                goto fail);
-          }
-        }
+  if (insp->estimator_count == 0)
+    return SU_TRUE;
+
+  now = suscan_gettime();
+
+  /*
+   * Idle: check whether a new estimation window is due. The schedule and
+   * pending requests are written by the analyzer thread, hence the lock.
+   */
+  if (insp->estimator_left == 0) {
+    suscan_inspector_lock(insp);
+
+    if (!insp->estimator_requested
+        && (insp->interval_estimator <= 0 || now < insp->next_estimator)) {
+      suscan_inspector_unlock(insp);
+      return SU_TRUE;
     }
+
+    insp->estimator_requested = SU_FALSE;
+    insp->estimator_left      = insp->estimator_window;
+    insp->estimator_interval  = insp->interval_estimator;
+
+    suscan_inspector_unlock(insp);
+
+    insp->estimator_cost      = 0;
+    insp->last_estimator      = now;
+  }
+
+  chunk = SU_MIN(samp_count, insp->estimator_left);
+
+  /* Spectral estimators share one FFT per block */
+  if (insp->estimator_frontend != NULL)
+    SU_TRYCATCH(
+        suscan_estimator_frontend_feed(
+            insp->estimator_frontend,
+            insp->estimator_list,
+            insp->estimator_count,
+            samp_buf,
+            chunk),
+        return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_estimator_feed_list(
+          insp->estimator_list,
+          insp->estimator_count,
+          samp_buf,
+          chunk),
+      return SU_FALSE);
+
+  end = suscan_gettime();
+  insp->estimator_cost += end - now;
+  insp->estimator_left -= chunk;
+
+  if (insp->estimator_left == 0) {
+    SU_TRYCATCH(suscan_inspector_publish_estimates(insp), return SU_FALSE);
+
+    /*
+     * Next window starts after the configured interval, or later if
+     * this one was expensive enough to exceed the duty cycle budget.
+     */
+    now  = end;
+    end  = suscan_gettime();
+    insp->estimator_cost += end - now;
+    rest = insp->estimator_cost / SUSCAN_INSPECTOR_ESTIMATOR_MAX_DUTY;
+
+    insp->next_estimator = insp->last_estimator
+      + (uint64_t) (insp->estimator_interval * 1e9);
+
+    if (insp->next_estimator < end + rest)
+      insp->next_estimator = end + rest;
   }
 
   return SU_TRUE;
+}
 
-fail:
-  if (msg != NULL)
-    suscan_analyzer_inspector_msg_destroy(msg);
+/*
+ * Tells whether a batch of samples would reach an estimator or a spectrum
+ * source. Must be called from the thread that feeds the inspector, while
+ * no analysis task is running on it.
+ */
+SUBOOL
+suscan_inspector_wants_analysis(suscan_inspector_t *insp)
+{
+  SUBOOL wants;
+
+  if (insp->spectsrc_index > 0 || insp->estimator_left > 0)
+    return SU_TRUE;
+
+  if (insp->estimator_count == 0)
+    return SU_FALSE;
+
+  suscan_inspector_lock(insp);
+  wants = insp->estimator_requested
+    || (insp->interval_estimator > 0
+      && suscan_gettime() >= insp->next_estimator);
+  suscan_inspector_unlock(insp);
+
+  return wants;
+}
+
+/*
+ * Runs a batch of channel samples through estimators and spectrum
+ * sources only. Direct-feed inspectors run their sampler from the
+ * channelizer thread and leave this part to an inspector task.
+ */
+SUBOOL
+suscan_inspector_analyze_samples(
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *samp_buf,
+    SUSCOUNT samp_count)
+{
+  /* Feed all enabled estimators */
+  SU_TRYCATCH(
+      suscan_inspector_estimator_loop(insp, samp_buf, samp_count),
+      return SU_FALSE);
+
+  /* Feed spectrum */
+  SU_TRYCATCH(
+      suscan_inspector_spectrum_loop(insp, samp_buf, samp_count),
+      return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+/*
+ * Runs a batch of channel samples through estimators, spectrum sources
+ * and the inspector itself. This is what an inspector task does.
+ */
+SUBOOL
+suscan_inspector_process_samples(
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *samp_buf,
+    SUSCOUNT samp_count)
+{
+  SU_TRYCATCH(
+      suscan_inspector_analyze_samples(insp, samp_buf, samp_count),
+      return SU_FALSE);
+
+  /* And finally, the inspector */
+  SU_TRYCATCH(
+      suscan_inspector_sampler_loop(insp, samp_buf, samp_count),
+      return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+/*
+ * Correction state is exchanged between the channelizer and the correction
+ * service through sequence counters: writers make the counter odd while
+ * they update the data, and readers retry a few times if they observe an
+ * odd or changing counter. Neither side ever waits for the other.
+ */
+SUPRIVATE SUBOOL
+suscan_inspector_seq_write(
+  unsigned int *seq,
+  void *dest,
+  const void *src,
+  size_t size)
+{
+  unsigned int prev = __atomic_load_n(seq, __ATOMIC_RELAXED);
+
+  /* Someone else is writing. Give up. */
+  if ((prev & 1) || !__atomic_compare_exchange_n(
+    seq,
+    &prev,
+    prev + 1,
+    SU_FALSE,
+    __ATOMIC_ACQUIRE,
+    __ATOMIC_RELAXED))
+    return SU_FALSE;
+
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(dest, src, size);
+  __atomic_store_n(seq, prev + 2, __ATOMIC_RELEASE);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspector_seq_read(
+  unsigned int *seq,
+  void *dest,
+  const void *src,
+  size_t size)
+{
+  unsigned int i, before;
+
+  for (i = 0; i < SUSCAN_INSPECTOR_CORRECTION_READ_RETRIES; ++i) {
+    before = __atomic_load_n(seq, __ATOMIC_ACQUIRE);
+    if (before & 1)
+      continue;
+
+    memcpy(dest, src, size);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    if (__atomic_load_n(seq, __ATOMIC_RELAXED) == before)
+      return SU_TRUE;
+  }
 
   return SU_FALSE;
 }
@@ -669,6 +904,7 @@ suscan_inspector_set_corrector(
   suscan_inspector_t *self, 
   suscan_frequency_corrector_t *corrector)
 {
+  struct suscan_inspector_correction invalid;
   SUBOOL ok = SU_FALSE;
   SUBOOL mutex_acquired = SU_FALSE;
 
@@ -680,6 +916,15 @@ suscan_inspector_set_corrector(
 
   self->corrector = corrector;
 
+  /* Forget about the previous model */
+  memset(&invalid, 0, sizeof(struct suscan_inspector_correction));
+  SU_TRY(
+    suscan_inspector_seq_write(
+      &self->correction_seq,
+      &self->correction,
+      &invalid,
+      sizeof(struct suscan_inspector_correction)));
+
   /* Delegated to factory */
   if (corrector == NULL)
     suscan_inspector_factory_set_inspector_freq_correction(
@@ -687,6 +932,140 @@ suscan_inspector_set_corrector(
       self,
       0.);
 
+  pthread_mutex_unlock(&self->corrector_mutex);
+  mutex_acquired = SU_FALSE;
+
+  if (corrector != NULL)
+    SU_TRY(suscan_inspector_factory_wake_correction_service(self->factory));
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    pthread_mutex_unlock(&self->corrector_mutex);
+
+  return ok;
+}
+
+SUBOOL
+suscan_inspector_post_correction_request(
+  suscan_inspector_t *self,
+  const struct timeval *tv,
+  SUFREQ abs_freq)
+{
+  struct suscan_inspector_correction_request req;
+
+  req.valid       = SU_TRUE;
+  req.source_time = *tv;
+  req.abs_freq    = abs_freq;
+
+  return suscan_inspector_seq_write(
+    &self->correction_req_seq,
+    &self->correction_req,
+    &req,
+    sizeof(struct suscan_inspector_correction_request));
+}
+
+SUBOOL
+suscan_inspector_get_interpolated_correction(
+  suscan_inspector_t *self,
+  const struct timeval *tv,
+  SUFLOAT *freq)
+{
+  struct suscan_inspector_correction corr;
+  struct timeval diff;
+
+  if (!suscan_inspector_seq_read(
+    &self->correction_seq,
+    &corr,
+    &self->correction,
+    sizeof(struct suscan_inspector_correction)))
+    return SU_FALSE;
+
+  if (!corr.valid)
+    return SU_FALSE;
+
+  timersub(tv, &corr.t0, &diff);
+
+  *freq = corr.f0 + corr.slope * (diff.tv_sec + 1e-6 * diff.tv_usec);
+
+  return SU_TRUE;
+}
+
+/*
+ * Evaluates the corrector at the last time seen by the channelizer and
+ * one horizon later, and publishes the resulting linear model.
+ */
+SUBOOL
+suscan_inspector_update_correction(
+  suscan_inspector_t *self,
+  SUFLOAT horizon)
+{
+  struct suscan_inspector_correction_request req;
+  struct suscan_inspector_correction corr;
+  struct timeval delta, t1;
+  SUFLOAT f1;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  /* Nothing from the channelizer yet */
+  if (!suscan_inspector_seq_read(
+    &self->correction_req_seq,
+    &req,
+    &self->correction_req,
+    sizeof(struct suscan_inspector_correction_request))
+    || !req.valid) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  SU_TRYC(pthread_mutex_lock(&self->corrector_mutex));
+  mutex_acquired = SU_TRUE;
+
+  if (self->corrector == NULL) {
+    ok = SU_TRUE;
+    goto done;
+  }
+
+  memset(&corr, 0, sizeof(struct suscan_inspector_correction));
+
+  if (suscan_frequency_corrector_is_applicable(
+    self->corrector,
+    &req.source_time)) {
+    delta.tv_sec  = (time_t) horizon;
+    delta.tv_usec = (horizon - delta.tv_sec) * 1e6;
+    timeradd(&req.source_time, &delta, &t1);
+
+    corr.valid = SU_TRUE;
+    corr.t0    = req.source_time;
+    corr.f0    = suscan_frequency_corrector_get_correction(
+        self->corrector,
+        &corr.t0,
+        req.abs_freq);
+    f1         = suscan_frequency_corrector_get_correction(
+        self->corrector,
+        &t1,
+        req.abs_freq);
+    corr.slope = (f1 - corr.f0) / horizon;
+  }
+
+  SU_TRY(
+    suscan_inspector_seq_write(
+      &self->correction_seq,
+      &self->correction,
+      &corr,
+      sizeof(struct suscan_inspector_correction)));
+
+  pthread_mutex_unlock(&self->corrector_mutex);
+  mutex_acquired = SU_FALSE;
+
+  /* Orbit reports are produced here too, away from the channelizer */
+  SU_TRY(
+    suscan_inspector_deliver_report(
+      self,
+      &req.source_time,
+      req.abs_freq));
+
   ok = SU_TRUE;
 
 done:
@@ -860,6 +1239,9 @@ suscan_inspector_destroy(suscan_inspector_t *self)
   if (self->estimator_list != NULL)
     free(self->estimator_list);
 
+  if (self->estimator_frontend != NULL)
+    suscan_estimator_frontend_destroy(self->estimator_frontend);
+
   for (i = 0; i < self->spectsrc_count; ++i)
     suscan_spectsrc_destroy(self->spectsrc_list[i]);
 
@@ -904,6 +1286,37 @@ suscan_inspector_set_domain(suscan_inspector_t *self, SUBOOL domain)
     domain);
 }
 
+/*
+ * Sets how often (in seconds) estimators are run, and on how many samples.
+ * An interval of zero disables periodic estimation: estimators are only
+ * run on explicit request.
+ */
+void
+suscan_inspector_set_estimator_schedule(
+    suscan_inspector_t *self,
+    SUFLOAT interval,
+    SUSCOUNT window)
+{
+  if (window == 0)
+    window = SUSCAN_INSPECTOR_ESTIMATOR_WINDOW;
+
+  suscan_inspector_lock(self);
+
+  self->interval_estimator = interval < 0 ? 0 : interval;
+  self->estimator_window   = window;
+
+  suscan_inspector_unlock(self);
+}
+
+/* Run estimators on the next window of samples, regardless of schedule */
+void
+suscan_inspector_request_estimates(suscan_inspector_t *self)
+{
+  suscan_inspector_lock(self);
+  self->estimator_requested = SU_TRUE;
+  suscan_inspector_unlock(self);
+}
+
 SUBOOL
 suscan_inspector_get_config(
     const suscan_inspector_t *insp,
@@ -928,11 +1341,44 @@ suscan_inspector_add_estimator(
     suscan_inspector_t *insp,
     const struct suscan_estimator_class *class)
 {
+  const struct suscan_estimator_class *owner_class;
   suscan_estimator_t *estimator = NULL;
+  suscan_estimator_t *owner = NULL;
+  unsigned int i;
 
-  SU_TRYCATCH(
-      estimator = suscan_estimator_new(class, insp->samp_info.equiv_fs),
-      goto fail);
+  if (class->view_of != NULL) {
+    /* Views read the estimator they are a view of, which comes first */
+    for (i = 0; i < insp->estimator_count; ++i)
+      if (strcmp(
+          insp->estimator_list[i]->classptr->name,
+          class->view_of) == 0) {
+        owner = insp->estimator_list[i];
+        break;
+      }
+
+    if (owner == NULL) {
+      SU_TRYCATCH(
+          owner_class = suscan_estimator_class_lookup(class->view_of),
+          goto fail);
+      SU_TRYCATCH(suscan_inspector_add_estimator(insp, owner_class), goto fail);
+      owner = insp->estimator_list[insp->estimator_count - 1];
+    }
+
+    SU_TRYCATCH(
+        estimator = suscan_estimator_new_view(class, owner),
+        goto fail);
+  } else {
+    SU_TRYCATCH(
+        estimator = suscan_estimator_new(class, insp->samp_info.equiv_fs),
+        goto fail);
+  }
+
+  if (suscan_estimator_is_spectral(estimator)
+      && insp->estimator_frontend == NULL)
+    SU_TRYCATCH(
+        insp->estimator_frontend = suscan_estimator_frontend_new(
+            SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ),
+        goto fail);
 
   SU_TRYCATCH(
       PTR_LIST_APPEND_CHECK(insp->estimator, estimator) != -1,
@@ -1057,9 +1503,9 @@ suscan_inspector_feed_sc_stuner(
 
     if (su_specttuner_new_data(self->sc_stuner)) {
       /*
-       * New data has been queued to the existing inspectors. We must
-       * ensure that all of them are done by issuing a barrier at the end
-       * of the worker queue.
+       * New data has been queued to the existing inspectors. The
+       * subcarrier factory is batched, so this runs all of them right
+       * here, in this worker, with no barrier involved.
        */
 
       suscan_inspector_factory_force_sync(self->sc_factory);
@@ -1151,6 +1597,8 @@ suscan_inspector_new(
 
   /* Initialize clocks */
   new->last_estimator = suscan_gettime();
+  new->next_estimator = new->last_estimator;
+  new->estimator_window = SUSCAN_INSPECTOR_ESTIMATOR_WINDOW;
   new->last_spectrum  = suscan_gettime();
 
   /* All set to call specific inspector */
@@ -1242,6 +1690,7 @@ suscan_init_inspectors(void)
   SU_TRYCATCH(suscan_power_inspector_register(), return SU_FALSE);
   SU_TRYCATCH(suscan_drift_inspector_register(), return SU_FALSE);
   SU_TRYCATCH(suscan_multicarrier_inspector_register(),   return SU_FALSE);
+  SU_TRYCATCH(suscan_bank_inspector_register(),  return SU_FALSE);
 
 
   return SU_TRUE;
@@ -27,6 +27,7 @@ extern "C" {
 #include <sigutils/sigutils.h>
 #include <sigutils/specttuner.h>
 #include "interface.h"
+#include "resampler.h"
 #include <analyzer/corrector.h>
 #include <util/com.h>
 
@@ -39,6 +40,17 @@ extern "C" {
 #define SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE  65536
 #define SUSCAN_INSPECTOR_SPECTRUM_BUF_SIZE 8192
 
+/* Spectra are not computed while the output queue is longer than this */
+#define SUSCAN_INSPECTOR_SPECTRUM_MAX_QUEUED 128
+
+/*
+ * Estimators run on windows of this many samples, once every estimator
+ * interval. In between, they are not fed at all. Time spent estimating
+ * is kept under the given fraction of the wall time.
+ */
+#define SUSCAN_INSPECTOR_ESTIMATOR_WINDOW   (4 * SUSCAN_DEFAULT_ESTIMATOR_BUFSIZ)
+#define SUSCAN_INSPECTOR_ESTIMATOR_MAX_DUTY .1
+
 struct suscan_inspector_factory;
 
 enum suscan_aync_state {
@@ -48,6 +60,26 @@ enum suscan_aync_state {
   SUSCAN_ASYNC_STATE_HALTED
 };
 
+#define SUSCAN_INSPECTOR_CORRECTION_READ_RETRIES 4
+
+/*
+ * Linear model of the frequency correction around a given source time,
+ * computed by the factory's correction service.
+ */
+struct suscan_inspector_correction {
+  SUBOOL         valid;
+  struct timeval t0;    /* Source time of the estimate */
+  SUFLOAT        f0;    /* Correction at t0 (Hz) */
+  SUFLOAT        slope; /* Correction drift (Hz/s) */
+};
+
+/* Last source time and frequency seen by the channelizer */
+struct suscan_inspector_correction_request {
+  SUBOOL         valid;
+  struct timeval source_time;
+  SUFREQ         abs_freq;
+};
+
 /* TODO: protect baudrate access with mutexes */
 struct suscan_inspector {
   SUSCAN_REFCOUNT;              /* Reference counter */
@@ -76,6 +108,12 @@ struct suscan_inspector {
   SUBOOL                        corrector_init;
   suscan_frequency_corrector_t *corrector;
 
+  /* Lock-free correction state, guarded by sequence counters */
+  unsigned int                               correction_seq;
+  struct suscan_inspector_correction         correction;
+  unsigned int                               correction_req_seq;
+  struct suscan_inspector_correction_request correction_req;
+
   /* Spectrum and estimator state */
   SUFLOAT  interval_estimator;
   SUFLOAT  interval_spectrum;
@@ -85,6 +123,18 @@ struct suscan_inspector {
   uint64_t last_spectrum;
   uint64_t last_orbit_report;
 
+  /*
+   * Estimator duty cycle. Interval 0 means "only when requested". The
+   * schedule and the request flag are protected by the inspector mutex,
+   * the rest belongs to the estimator loop.
+   */
+  SUSCOUNT estimator_window;    /* Samples per estimation window */
+  SUFLOAT  estimator_interval;  /* Interval of the current window */
+  SUSCOUNT estimator_left;      /* Samples left in current window */
+  uint64_t estimator_cost;      /* Time spent in current window (ns) */
+  uint64_t next_estimator;      /* Earliest start of the next window */
+  SUBOOL   estimator_requested; /* Explicit estimation request */
+
   uint32_t spectsrc_index;
 
   SUBOOL    params_requested;    /* New parameters requested */
@@ -101,8 +151,10 @@ struct suscan_inspector {
   SUCOMPLEX sampler_buf[SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE];
   SUSCOUNT  sampler_ptr;
   SUSCOUNT  sample_msg_watermark; /* Watermark. When reached, message is sent */
+  SUSCOUNT  sampler_frame;        /* Samples pushed together (multiplexed) */
   
   PTR_LIST(suscan_estimator_t, estimator); /* Parameter estimators */
+  suscan_estimator_frontend_t *estimator_frontend; /* Shared FFT, if needed */
   PTR_LIST(suscan_spectsrc_t, spectsrc); /* Spectrum source */
 };
 
@@ -181,6 +233,24 @@ suscan_inspector_sampler_buf_avail(const suscan_inspector_t *self)
   return SUSCAN_INSPECTOR_SAMPLER_BUF_SIZE - self->sampler_ptr;
 }
 
+/*
+ * Inspectors multiplexing several outputs push them in frames of a fixed
+ * size, that must never be split across sample batches.
+ */
+SUINLINE void
+suscan_inspector_set_sampler_frame(suscan_inspector_t *self, SUSCOUNT len)
+{
+  self->sampler_frame = len;
+}
+
+SUINLINE SUBOOL
+suscan_inspector_sampler_buf_full(const suscan_inspector_t *self)
+{
+  SUSCOUNT frame = self->sampler_frame > 0 ? self->sampler_frame : 1;
+
+  return suscan_inspector_sampler_buf_avail(self) < frame;
+}
+
 SUINLINE SUBOOL
 suscan_inspector_push_sample(suscan_inspector_t *self, SUCOMPLEX samp)
 {
@@ -210,6 +280,70 @@ suscan_inspector_push_sample_buffer(
   return count;
 }
 
+/*
+ * Largest input block (up to max) that cannot produce more output samples
+ * than the room left before the message watermark or the end of the
+ * sampler buffer, given the number of input samples per output (period).
+ * Block-based inspectors use it to run their output stage without
+ * per-sample exit checks, so their state always matches the number of
+ * samples they report as consumed.
+ */
+SUINLINE SUSCOUNT
+suscan_inspector_get_block_len(
+  const suscan_inspector_t *self,
+  SUFLOAT period,
+  SUSCOUNT count,
+  SUSCOUNT max)
+{
+  SUSCOUNT room = suscan_inspector_sampler_buf_avail(self);
+  SUSCOUNT length = self->sampler_ptr;
+  SUFLOAT max_len;
+
+  if (self->sample_msg_watermark > length
+      && self->sample_msg_watermark - length < room)
+    room = self->sample_msg_watermark - length;
+
+  if (period < 1)
+    period = 1;
+
+  max_len = (room - 1) * period + 1;
+
+  if (count > max)
+    count = max;
+
+  if (count > max_len)
+    count = (SUSCOUNT) max_len;
+
+  return count;
+}
+
+/*
+ * Post-demodulation resampling stage: decimates x straight into the
+ * sampler buffer, computing only the samples that are actually sent.
+ * Returns the number of input samples consumed.
+ */
+SUINLINE SUSCOUNT
+suscan_inspector_push_resampled(
+  suscan_inspector_t *self,
+  suscan_resampler_t *resampler,
+  const SUCOMPLEX *x,
+  SUSCOUNT count)
+{
+  SUSCOUNT avail = suscan_inspector_sampler_buf_avail(self);
+  SUSCOUNT got;
+
+  got = suscan_resampler_feed(
+    resampler,
+    x,
+    count,
+    self->sampler_buf + self->sampler_ptr,
+    &avail);
+
+  self->sampler_ptr += avail;
+
+  return got;
+}
+
 SUINLINE SUSCOUNT
 suscan_inspector_get_output_length(const suscan_inspector_t *self)
 {
@@ -285,6 +419,22 @@ SUBOOL suscan_inspector_get_correction(
   SUFREQ abs_freq,
   SUFLOAT *freq);
 
+/* Lock-free access to the correction state */
+SUBOOL suscan_inspector_get_interpolated_correction(
+  suscan_inspector_t *self,
+  const struct timeval *tv,
+  SUFLOAT *freq);
+
+SUBOOL suscan_inspector_post_correction_request(
+  suscan_inspector_t *self,
+  const struct timeval *tv,
+  SUFREQ abs_freq);
+
+/* Called by the correction service */
+SUBOOL suscan_inspector_update_correction(
+  suscan_inspector_t *self,
+  SUFLOAT horizon);
+
 SUBOOL suscan_inspector_deliver_report(
   suscan_inspector_t *self,
   const struct timeval *tv,
@@ -304,6 +454,13 @@ void suscan_inspector_set_throttle_factor(
 
 void suscan_inspector_set_domain(suscan_inspector_t *self, SUBOOL domain);
 
+void suscan_inspector_set_estimator_schedule(
+    suscan_inspector_t *self,
+    SUFLOAT interval,
+    SUSCOUNT window);
+
+void suscan_inspector_request_estimates(suscan_inspector_t *self);
+
 SUBOOL suscan_inspector_notify_bandwidth(
     suscan_inspector_t *insp,
     SUFREQ new_bandwidth);
@@ -332,6 +489,8 @@ SUBOOL suscan_inspector_walk_inspectors(
     struct suscan_inspector *insp),
   void *userdata);
 
+SUBOOL suscan_inspector_flush_samples(suscan_inspector_t *insp);
+
 SUBOOL suscan_inspector_sampler_loop(
     suscan_inspector_t *insp,
     const SUCOMPLEX *samp_buf,
@@ -347,6 +506,18 @@ SUBOOL suscan_inspector_estimator_loop(
     const SUCOMPLEX *samp_buf,
     SUSCOUNT samp_count);
 
+SUBOOL suscan_inspector_wants_analysis(suscan_inspector_t *insp);
+
+SUBOOL suscan_inspector_analyze_samples(
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *samp_buf,
+    SUSCOUNT samp_count);
+
+SUBOOL suscan_inspector_process_samples(
+    suscan_inspector_t *insp,
+    const SUCOMPLEX *samp_buf,
+    SUSCOUNT samp_count);
+
 SUSDIFF suscan_inspector_feed_bulk(
     suscan_inspector_t *insp,
     const SUCOMPLEX *x,
@@ -368,6 +539,7 @@ SUBOOL suscan_raw_inspector_register(void);
 SUBOOL suscan_power_inspector_register(void);
 SUBOOL suscan_multicarrier_inspector_register(void);
 SUBOOL suscan_drift_inspector_register(void);
+SUBOOL suscan_bank_inspector_register(void);
 
 #ifdef __cplusplus
 }
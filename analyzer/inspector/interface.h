@@ -50,6 +50,7 @@ struct suscan_inspector_interface {
   const char *sc_factory_class;   /* Factory class (if any) */
 
   SUBOOL frequency_domain;
+  SUBOOL direct_feed;             /* Sampler runs in the channelizer */
   
   suscan_config_desc_t *cfgdesc;
 
@@ -148,7 +148,8 @@ SUBOOL suscan_inspector_fsk_params_save(
 enum suscan_inspector_ask_channel {
   SUSCAN_INSPECTOR_ASK_CHANNEL_BOTH,
   SUSCAN_INSPECTOR_ASK_CHANNEL_I,
-  SUSCAN_INSPECTOR_ASK_CHANNEL_Q
+  SUSCAN_INSPECTOR_ASK_CHANNEL_Q,
+  SUSCAN_INSPECTOR_ASK_CHANNEL_ENVELOPE /* Envelope, coherent if PLL is used */
 };
 
 struct suscan_inspector_ask_params {
@@ -0,0 +1,215 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "pfb"
+
+#include <string.h>
+#include <sigutils/sigutils.h>
+
+#include "pfb.h"
+#include "src/fftplan.h"
+
+SUPRIVATE SUFLOAT
+suscan_pfb_window(SUFLOAT x)
+{
+  /* Blackmann-Harris, x in [0, 1] */
+  return .35875
+    - .48829 * SU_COS(2 * PI * x)
+    + .14128 * SU_COS(4 * PI * x)
+    - .01168 * SU_COS(6 * PI * x);
+}
+
+SUPRIVATE SUFLOAT
+suscan_pfb_sinc(SUFLOAT x)
+{
+  if (SU_ABS(x) < 1e-6)
+    return 1;
+
+  return SU_SIN(PI * x) / (PI * x);
+}
+
+/*
+ * Symmetric lowpass prototype, one channel wide (cutoff at fs / 2M) and
+ * with unity gain at DC.
+ */
+SUPRIVATE void
+suscan_pfb_design(suscan_pfb_t *self)
+{
+  SUSCOUNT i;
+  SUFLOAT center = .5 * (self->size - 1);
+  SUFLOAT sum = 0;
+
+  for (i = 0; i < self->size; ++i) {
+    self->h[i] =
+        suscan_pfb_sinc((i - center) / self->branches)
+        * suscan_pfb_window((i + .5) / self->size);
+    sum += self->h[i];
+  }
+
+  for (i = 0; i < self->size; ++i)
+    self->h[i] /= sum;
+}
+
+void
+suscan_pfb_reset(suscan_pfb_t *self)
+{
+  memset(self->hist, 0, self->size * sizeof(SUCOMPLEX));
+  self->fill = 0;
+}
+
+suscan_pfb_t *
+suscan_pfb_new(SUSCOUNT branches, SUSCOUNT taps)
+{
+  suscan_pfb_t *new = NULL;
+  SUBOOL locked = SU_FALSE;
+
+  SU_TRYCATCH(branches > 0 && branches <= SUSCAN_PFB_MAX_BRANCHES, goto fail);
+  SU_TRYCATCH(taps > 0 && taps <= SUSCAN_PFB_MAX_TAPS, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_pfb_t);
+
+  new->branches = branches;
+  new->taps     = taps;
+  new->size     = branches * taps;
+
+  SU_ALLOCATE_MANY_FAIL(new->h, new->size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->hist, new->size, SUCOMPLEX);
+  SU_TRYCATCH(
+      new->buf = SU_FFTW(_malloc)(branches * sizeof(SUCOMPLEX)),
+      goto fail);
+
+  SU_TRYCATCH(suscan_fft_planner_lock(), goto fail);
+  locked = SU_TRUE;
+
+  SU_TRYCATCH(
+      new->plan = SU_FFTW(_plan_dft_1d)(
+          branches,
+          (SU_FFTW(_complex) *) new->buf,
+          (SU_FFTW(_complex) *) new->buf,
+          FFTW_FORWARD,
+          FFTW_ESTIMATE),
+      goto fail);
+
+  suscan_fft_planner_unlock();
+  locked = SU_FALSE;
+
+  suscan_pfb_design(new);
+
+  suscan_pfb_reset(new);
+
+  return new;
+
+fail:
+  if (locked)
+    suscan_fft_planner_unlock();
+
+  if (new != NULL)
+    suscan_pfb_destroy(new);
+
+  return NULL;
+}
+
+/*
+ * With the newest sample at the end of the history and a symmetric
+ * prototype, the polyphase sum of every branch is a plain product of the
+ * history against the taps, folded modulo M. As blocks are M samples
+ * long, the mixing phase of every channel is the same at the end of each
+ * block, and the FFT of the folded buffer needs no further correction.
+ */
+SUPRIVATE void
+suscan_pfb_compute_frame(suscan_pfb_t *self)
+{
+  SUSCOUNT q, r;
+  SUSCOUNT M = self->branches;
+  const SUFLOAT *h;
+  const SUCOMPLEX *x;
+  SUCOMPLEX *buf = self->buf;
+
+  for (r = 0; r < M; ++r)
+    buf[r] = self->h[r] * self->hist[r];
+
+  for (q = 1; q < self->taps; ++q) {
+    h = self->h + q * M;
+    x = self->hist + q * M;
+
+    for (r = 0; r < M; ++r)
+      buf[r] += h[r] * x[r];
+  }
+
+  SU_FFTW(_execute)(self->plan);
+}
+
+SUSCOUNT
+suscan_pfb_feed(
+    suscan_pfb_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT len,
+    const SUCOMPLEX **frame)
+{
+  SUSCOUNT M = self->branches;
+  SUSCOUNT chunk = M - self->fill;
+
+  *frame = NULL;
+
+  if (chunk > len)
+    chunk = len;
+
+  memcpy(
+      self->hist + self->size - M + self->fill,
+      x,
+      chunk * sizeof(SUCOMPLEX));
+
+  self->fill += chunk;
+
+  if (self->fill == M) {
+    suscan_pfb_compute_frame(self);
+
+    /* Make room for the next block */
+    memmove(
+        self->hist,
+        self->hist + M,
+        (self->size - M) * sizeof(SUCOMPLEX));
+
+    self->fill = 0;
+    *frame = self->buf;
+  }
+
+  return chunk;
+}
+
+void
+suscan_pfb_destroy(suscan_pfb_t *self)
+{
+  if (self->plan != NULL) {
+    (void) suscan_fft_planner_lock();
+    SU_FFTW(_destroy_plan)(self->plan);
+    suscan_fft_planner_unlock();
+  }
+
+  if (self->buf != NULL)
+    SU_FFTW(_free)(self->buf);
+
+  if (self->hist != NULL)
+    free(self->hist);
+
+  if (self->h != NULL)
+    free(self->h);
+
+  free(self);
+}
@@ -0,0 +1,82 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _INSPECTOR_PFB_H
+#define _INSPECTOR_PFB_H
+
+#include <sigutils/sigutils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Critically sampled polyphase analysis filter bank. The input is split
+ * in M channels spaced fs / M apart, each one decimated by M. Every M
+ * input samples, a frame of M outputs is produced (one per channel, with
+ * bin k centered at k * fs / M) with a single M-point FFT, no matter how
+ * many channels are actually used.
+ */
+
+#define SUSCAN_PFB_MAX_BRANCHES 16384
+#define SUSCAN_PFB_MAX_TAPS     32 /* Per branch */
+
+struct suscan_pfb {
+  SUSCOUNT   branches; /* M */
+  SUSCOUNT   taps;     /* Taps per branch (P) */
+  SUSCOUNT   size;     /* M x P */
+  SUSCOUNT   fill;     /* Samples of the current block */
+
+  SUFLOAT   *h;        /* Prototype filter, M x P taps */
+  SUCOMPLEX *hist;     /* Last M x P input samples */
+  SUCOMPLEX *buf;      /* Folded input, then frame (in place) */
+
+  SU_FFTW(_plan) plan;
+};
+
+typedef struct suscan_pfb suscan_pfb_t;
+
+SUINLINE SUSCOUNT
+suscan_pfb_get_branches(const suscan_pfb_t *self)
+{
+  return self->branches;
+}
+
+suscan_pfb_t *suscan_pfb_new(SUSCOUNT branches, SUSCOUNT taps);
+
+void suscan_pfb_reset(suscan_pfb_t *self);
+
+/*
+ * Consume input up to the end of the current block. Returns the number of
+ * samples consumed. If the block was completed, *frame points to the
+ * M channel outputs, valid until the next call.
+ */
+SUSCOUNT suscan_pfb_feed(
+    suscan_pfb_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT len,
+    const SUCOMPLEX **frame);
+
+void suscan_pfb_destroy(suscan_pfb_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _INSPECTOR_PFB_H */
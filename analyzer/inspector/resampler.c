@@ -0,0 +1,214 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "resampler"
+
+#include <string.h>
+#include <sigutils/sigutils.h>
+
+#include "resampler.h"
+
+SUPRIVATE SUFLOAT
+suscan_resampler_window(SUFLOAT x)
+{
+  /* Blackmann-Harris, x in [0, 1] */
+  return .35875
+    - .48829 * SU_COS(2 * PI * x)
+    + .14128 * SU_COS(4 * PI * x)
+    - .01168 * SU_COS(6 * PI * x);
+}
+
+SUPRIVATE SUFLOAT
+suscan_resampler_sinc(SUFLOAT x)
+{
+  if (SU_ABS(x) < 1e-6)
+    return 1;
+
+  return SU_SIN(PI * x) / (PI * x);
+}
+
+/*
+ * Tap n of phase p samples the prototype at n + p / phases input samples.
+ * Row phases is the next sample of phase 0, so that adjacent phases can
+ * always be interpolated.
+ */
+SUPRIVATE void
+suscan_resampler_design(suscan_resampler_t *self, SUFLOAT fc)
+{
+  unsigned int p, n;
+  SUFLOAT *row;
+  SUFLOAT t, sum;
+  SUFLOAT center = .5 * self->taps;
+
+  for (p = 0; p <= self->phases; ++p) {
+    row = self->bank + p * self->taps;
+    sum = 0;
+
+    for (n = 0; n < self->taps; ++n) {
+      t = n + (SUFLOAT) p / self->phases;
+      row[n] = fc
+        * suscan_resampler_sinc(fc * (t - center))
+        * suscan_resampler_window(t / self->taps);
+      sum += row[n];
+    }
+
+    /* Unity gain at DC, for every phase */
+    if (sum > 0)
+      for (n = 0; n < self->taps; ++n)
+        row[n] /= sum;
+  }
+}
+
+void
+suscan_resampler_reset(suscan_resampler_t *self)
+{
+  memset(self->hist, 0, 2 * self->taps * sizeof(SUCOMPLEX));
+  self->hist_ptr = 0;
+  self->acc      = 0;
+}
+
+suscan_resampler_t *
+suscan_resampler_new(SUFLOAT ratio, SUFLOAT cutoff)
+{
+  suscan_resampler_t *new = NULL;
+  SUFLOAT fc, dec;
+  unsigned int phases, taps;
+
+  SU_TRYCATCH(ratio > 0, goto fail);
+  SU_TRYCATCH(cutoff > 0, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_resampler_t);
+
+  new->ratio  = ratio;
+  new->step   = 1. / ratio;
+  new->cutoff = cutoff;
+
+  /*
+   * Anything above the output Nyquist frequency would alias. Filter length
+   * scales with the decimation so the transition band stays constant
+   * relative to the output rate, and the number of phases shrinks with it,
+   * as the prototype becomes smoother at the input rate.
+   */
+  dec = new->step > 1 ? new->step : 1;
+  fc  = SU_MIN(cutoff, 1. / dec);
+
+  taps = SU_CEIL(SUSCAN_RESAMPLER_TAPS_PER_OUTPUT * dec);
+  if (taps > SUSCAN_RESAMPLER_MAX_TAPS)
+    taps = SUSCAN_RESAMPLER_MAX_TAPS;
+
+  phases = SU_CEIL(SUSCAN_RESAMPLER_PHASES / dec);
+  if (phases < SUSCAN_RESAMPLER_MIN_PHASES)
+    phases = SUSCAN_RESAMPLER_MIN_PHASES;
+
+  new->taps   = taps;
+  new->phases = phases;
+
+  SU_ALLOCATE_MANY_FAIL(new->bank, (phases + 1) * taps, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->hist, 2 * taps, SUCOMPLEX);
+
+  suscan_resampler_design(new, fc);
+  suscan_resampler_reset(new);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_resampler_destroy(new);
+
+  return NULL;
+}
+
+SUINLINE SUCOMPLEX
+suscan_resampler_output(const suscan_resampler_t *self)
+{
+  const SUCOMPLEX *w = self->hist + self->hist_ptr;
+  const SUFLOAT *a, *b;
+  SUFLOAT pf, f;
+  unsigned int p, n;
+  SUCOMPLEX y = 0;
+
+  pf = self->acc * self->phases;
+  p  = (unsigned int) pf;
+  if (p >= self->phases)
+    p = self->phases - 1;
+  f  = pf - p;
+  a  = self->bank + p * self->taps;
+
+  if (f == 0) {
+    /* Exact phase (always the case for integer ratios) */
+    for (n = 0; n < self->taps; ++n)
+      y += w[n] * a[n];
+  } else {
+    b = a + self->taps;
+    for (n = 0; n < self->taps; ++n)
+      y += w[n] * (a[n] + f * (b[n] - a[n]));
+  }
+
+  return y;
+}
+
+SUSCOUNT
+suscan_resampler_feed(
+    suscan_resampler_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT len,
+    SUCOMPLEX *y,
+    SUSCOUNT *y_len)
+{
+  SUSCOUNT i;
+  SUSCOUNT avail = *y_len;
+  SUSCOUNT out = 0;
+  SUSCOUNT pending;
+
+  for (i = 0; i < len; ++i) {
+    /* Outputs falling before the next input sample */
+    if (self->acc < 1) {
+      pending = SU_CEIL((1 - self->acc) / self->step);
+      if (out + pending > avail)
+        break;
+    }
+
+    /* Push into the mirrored delay line, newest first */
+    self->hist_ptr = (self->hist_ptr + self->taps - 1) % self->taps;
+    self->hist[self->hist_ptr] = self->hist[self->hist_ptr + self->taps] = x[i];
+
+    while (self->acc < 1) {
+      y[out++] = suscan_resampler_output(self);
+      self->acc += self->step;
+    }
+
+    self->acc -= 1;
+  }
+
+  *y_len = out;
+
+  return i;
+}
+
+void
+suscan_resampler_destroy(suscan_resampler_t *self)
+{
+  if (self->bank != NULL)
+    free(self->bank);
+
+  if (self->hist != NULL)
+    free(self->hist);
+
+  free(self);
+}
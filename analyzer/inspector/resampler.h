@@ -0,0 +1,94 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _INSPECTOR_RESAMPLER_H
+#define _INSPECTOR_RESAMPLER_H
+
+#include <sigutils/sigutils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Polyphase FIR resampler. Unlike a filter followed by su_sampler, only
+ * the output samples are ever computed: each one is the dot product of
+ * the input history against the filter phase closest to the output
+ * instant. Phases are linearly interpolated, so both rational and
+ * arbitrary ratios are supported.
+ */
+
+#define SUSCAN_RESAMPLER_PHASES           32 /* For ratios >= 1 */
+#define SUSCAN_RESAMPLER_MIN_PHASES       4
+#define SUSCAN_RESAMPLER_TAPS_PER_OUTPUT  32
+#define SUSCAN_RESAMPLER_MAX_TAPS         8192
+
+struct suscan_resampler {
+  SUFLOAT    ratio;    /* Output rate / input rate */
+  SUFLOAT    step;     /* Input samples per output sample */
+  SUFLOAT    cutoff;   /* Normalized cutoff (1 = input Nyquist) */
+  SUFLOAT    acc;      /* Time to next output, in input samples */
+
+  unsigned   phases;
+  unsigned   taps;     /* Taps per phase */
+  SUFLOAT   *bank;     /* (phases + 1) x taps */
+
+  SUCOMPLEX *hist;     /* Mirrored delay line, 2 x taps */
+  unsigned   hist_ptr;
+};
+
+typedef struct suscan_resampler suscan_resampler_t;
+
+SUINLINE SUFLOAT
+suscan_resampler_get_ratio(const suscan_resampler_t *self)
+{
+  return self->ratio;
+}
+
+/* Input samples per output sample, as in su_sampler_get_period */
+SUINLINE SUFLOAT
+suscan_resampler_get_period(const suscan_resampler_t *self)
+{
+  return self->step;
+}
+
+suscan_resampler_t *suscan_resampler_new(SUFLOAT ratio, SUFLOAT cutoff);
+
+void suscan_resampler_reset(suscan_resampler_t *self);
+
+/*
+ * Consume up to len input samples, writing at most *y_len output samples
+ * to y. On return, *y_len holds the number of samples written. Returns
+ * the number of input samples consumed, which is less than len only
+ * when the output buffer is full.
+ */
+SUSCOUNT suscan_resampler_feed(
+    suscan_resampler_t *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT len,
+    SUCOMPLEX *y,
+    SUSCOUNT *y_len);
+
+void suscan_resampler_destroy(suscan_resampler_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _INSPECTOR_RESAMPLER_H */
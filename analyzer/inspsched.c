@@ -141,28 +141,22 @@ suscan_inpsched_task_cb(
 
   switch (task_info->type) {
     case SUSCAN_INSPECTOR_TASK_INFO_TYPE_SAMPLES:
-      /* Feed all enabled estimators */
-      SU_TRYCATCH(
-          suscan_inspector_estimator_loop(
-              task_info->inspector,
-              task_info->samples.data,
-              task_info->samples.size),
-          goto fail);
-
-      /* Feed spectrum */
+      /*
+      * We just process the incoming data. If we broke something,
+      * mark the inspector as halted.
+      */
       SU_TRYCATCH(
-          suscan_inspector_spectrum_loop(
+          suscan_inspector_process_samples(
               task_info->inspector,
               task_info->samples.data,
               task_info->samples.size),
           goto fail);
+      break;
 
-      /*
-      * We just process the incoming data. If we broke something,
-      * mark the inspector as halted.
-      */
+    case SUSCAN_INSPECTOR_TASK_INFO_TYPE_ANALYSIS:
+      /* Direct-feed inspectors: the sampler already ran */
       SU_TRYCATCH(
-          suscan_inspector_sampler_loop(
+          suscan_inspector_analyze_samples(
               task_info->inspector,
               task_info->samples.data,
               task_info->samples.size),
@@ -213,11 +207,81 @@ suscan_inspsched_get_min_workers(void)
   return count - 1;
 }
 
+SUPRIVATE SUBOOL
+suscan_inspsched_batch_task(
+    suscan_inspsched_t *sched,
+    struct suscan_inspector_task_info *task_info)
+{
+  struct suscan_inspector_task_info **tmp;
+  unsigned int new_alloc;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  /* Tasks may be queued from other threads (e.g. frequency changes) */
+  SU_TRYCATCH(pthread_mutex_lock(&sched->task_mutex) == 0, goto done);
+  mutex_acquired = SU_TRUE;
+
+  if (sched->batch_len == sched->batch_alloc) {
+    new_alloc = sched->batch_alloc == 0 ? 16 : sched->batch_alloc << 1;
+
+    SU_TRYCATCH(
+      tmp = realloc(
+        sched->batch,
+        new_alloc * sizeof(struct suscan_inspector_task_info *)),
+      goto done);
+
+    sched->batch       = tmp;
+    sched->batch_alloc = new_alloc;
+  }
+
+  sched->batch[sched->batch_len++] = task_info;
+
+  ok = SU_TRUE;
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&sched->task_mutex);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_inspsched_run_batch(suscan_inspsched_t *sched)
+{
+  struct suscan_inspector_task_info **tmp;
+  unsigned int i, len, alloc;
+
+  SU_TRYCATCH(pthread_mutex_lock(&sched->task_mutex) == 0, return SU_FALSE);
+
+  /* Swap lists, so that tasks can be queued while we run these */
+  tmp                  = sched->running;
+  sched->running       = sched->batch;
+  sched->batch         = tmp;
+
+  alloc                = sched->running_alloc;
+  sched->running_alloc = sched->batch_alloc;
+  sched->batch_alloc   = alloc;
+
+  len                  = sched->batch_len;
+  sched->batch_len     = 0;
+
+  (void) pthread_mutex_unlock(&sched->task_mutex);
+
+  /* Queue order is preserved */
+  for (i = 0; i < len; ++i)
+    (void) suscan_inpsched_task_cb(NULL, sched, sched->running[i]);
+
+  return SU_TRUE;
+}
+
 SUBOOL
 suscan_inspsched_queue_task(
     suscan_inspsched_t *sched,
     struct suscan_inspector_task_info *task_info)
 {
+  if (sched->batched)
+    return suscan_inspsched_batch_task(sched, task_info);
+
   /* Process new samples */
   SU_TRYCATCH(
       suscan_worker_push(
@@ -237,6 +301,12 @@ suscan_inspsched_sync(suscan_inspsched_t *sched)
 {
   unsigned int i;
 
+  if (sched->batched) {
+    SU_TRYCATCH(suscan_inspsched_run_batch(sched), return SU_FALSE);
+    sched->have_time = SU_FALSE;
+    return SU_TRUE;
+  }
+
   /* Queue barriers */
   for (i = 0; i < sched->worker_count; ++i)
     SU_TRYCATCH(
@@ -274,6 +344,13 @@ suscan_inspsched_destroy(suscan_inspsched_t *self)
   if (self->worker_list != NULL)
     free(self->worker_list);
 
+  /* Unprocessed batched tasks are still in the alloc list */
+  if (self->batch != NULL)
+    free(self->batch);
+
+  if (self->running != NULL)
+    free(self->running);
+
   /*
    * All workers halted, source worker must be finished by now
    * it is safe to go on with the object destruction. We basically
@@ -305,7 +382,7 @@ suscan_inspsched_destroy(suscan_inspsched_t *self)
 
 
 suscan_inspsched_t *
-suscan_inspsched_new(struct suscan_mq *ctl_mq)
+suscan_inspsched_new_ex(struct suscan_mq *ctl_mq, SUBOOL batched)
 {
   suscan_inspsched_t *new = NULL;
   suscan_worker_t *worker = NULL;
@@ -314,9 +391,10 @@ suscan_inspsched_new(struct suscan_mq *ctl_mq)
 
   SU_TRYCATCH(new = calloc(1, sizeof(suscan_inspsched_t)), goto fail);
   
-  new->ctl_mq = ctl_mq;
+  new->ctl_mq  = ctl_mq;
+  new->batched = batched;
   
-  count = suscan_inspsched_get_min_workers();
+  count = batched ? 0 : suscan_inspsched_get_min_workers();
 
   SU_TRYCATCH(suscan_mq_init(&new->mq_out), goto fail);
   new->mq_out_init = SU_TRUE;
@@ -334,10 +412,12 @@ suscan_inspsched_new(struct suscan_mq *ctl_mq)
     goto fail);
   new->task_init = SU_TRUE;
 
-  SU_TRYCATCH(
-    pthread_barrier_init(&new->barrier, NULL, new->worker_count + 1) == 0,
-    goto fail);
-  new->barrier_init = SU_TRUE;
+  if (!batched) {
+    SU_TRYCATCH(
+      pthread_barrier_init(&new->barrier, NULL, new->worker_count + 1) == 0,
+      goto fail);
+    new->barrier_init = SU_TRUE;
+  }
 
   return new;
 
@@ -354,3 +434,9 @@ fail:
 
   return NULL;
 }
+
+suscan_inspsched_t *
+suscan_inspsched_new(struct suscan_mq *ctl_mq)
+{
+  return suscan_inspsched_new_ex(ctl_mq, SU_FALSE);
+}
@@ -35,6 +35,7 @@ struct suscan_inspector_factory;
 
 enum suscan_inspector_task_info_type {
   SUSCAN_INSPECTOR_TASK_INFO_TYPE_SAMPLES,
+  SUSCAN_INSPECTOR_TASK_INFO_TYPE_ANALYSIS, /* Estimators and spectrum only */
   SUSCAN_INSPECTOR_TASK_INFO_TYPE_NEW_FREQ
 };
 
@@ -76,6 +77,17 @@ struct suscan_inspsched {
   unsigned int last_worker; /* Used as rotatory index */
   pthread_barrier_t  barrier; /* Inspector barrier */
   SUBOOL barrier_init;
+
+  /*
+   * Batched mode: no workers. Tasks are collected and executed by the
+   * thread calling sync, which is the one that fed the inspectors.
+   */
+  SUBOOL batched;
+  struct suscan_inspector_task_info **batch;
+  struct suscan_inspector_task_info **running;
+  unsigned int batch_len;
+  unsigned int batch_alloc;
+  unsigned int running_alloc;
 };
 
 typedef struct suscan_inspsched suscan_inspsched_t;
@@ -106,6 +118,11 @@ SUBOOL suscan_inspsched_sync(suscan_inspsched_t *sched);
  */
 suscan_inspsched_t *suscan_inspsched_new(struct suscan_mq *ctl_mq);
 
+/* Same as above, optionally in batched mode */
+suscan_inspsched_t *suscan_inspsched_new_ex(
+  struct suscan_mq *ctl_mq,
+  SUBOOL batched);
+
 SUBOOL suscan_inspsched_destroy(suscan_inspsched_t *sched);
 
 #endif /* _INSPSCHED_H */
@@ -640,6 +640,13 @@ suscan_mq_set_cleanup_watermark(
   self->cleanup_watermark = watermark;
 }
 
+/* Does not lock the queue: the result is just a hint */
+unsigned int
+suscan_mq_get_count(const struct suscan_mq *self)
+{
+  return __atomic_load_n(&self->count, __ATOMIC_RELAXED);
+}
+
 void
 suscan_mq_set_callbacks(
   struct suscan_mq *self,
@@ -74,6 +74,7 @@ struct suscan_mq {
 /*************************** Message queue API *******************************/
 SUBOOL suscan_mq_init(struct suscan_mq *mq);
 void   suscan_mq_set_cleanup_watermark(struct suscan_mq *mq, unsigned int);
+unsigned int suscan_mq_get_count(const struct suscan_mq *mq);
 void   suscan_mq_set_callbacks(
   struct suscan_mq *mq,
   const struct suscan_mq_callbacks *);
@@ -29,6 +29,8 @@
 
 #include "mq.h"
 #include "msg.h"
+#include "panorama.h"
+#include "spectstats.h"
 #include "source.h"
 #include <sgdp4/sgdp4.h>
 
@@ -193,6 +195,15 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_psd_msg)
   SUSCAN_PACK(float, self->samp_rate);
   SUSCAN_PACK(float, self->measured_samp_rate);
   SUSCAN_PACK(float, self->N0);
+  SUSCAN_PACK(float, self->sweep_rate);
+  SUSCAN_PACK(float, self->timings.read);
+  SUSCAN_PACK(float, self->timings.prepare);
+  SUSCAN_PACK(float, self->timings.wait);
+  SUSCAN_PACK(float, self->timings.channelize);
+  SUSCAN_PACK(float, self->timings.inspectors);
+  SUSCAN_PACK(uint,  self->psd_stats.processed);
+  SUSCAN_PACK(uint,  self->psd_stats.skipped);
+  SUSCAN_PACK(uint,  self->psd_stats.dropped);
 
   SU_TRYCATCH(
       suscan_pack_compact_single_array(
@@ -228,6 +239,15 @@ SUSCAN_PARTIAL_DESERIALIZER_PROTO(suscan_analyzer_psd_msg)
   SUSCAN_UNPACK(float,  self->samp_rate);
   SUSCAN_UNPACK(float,  self->measured_samp_rate);
   SUSCAN_UNPACK(float,  self->N0);
+  SUSCAN_UNPACK(float,  self->sweep_rate);
+  SUSCAN_UNPACK(float,  self->timings.read);
+  SUSCAN_UNPACK(float,  self->timings.prepare);
+  SUSCAN_UNPACK(float,  self->timings.wait);
+  SUSCAN_UNPACK(float,  self->timings.channelize);
+  SUSCAN_UNPACK(float,  self->timings.inspectors);
+  SUSCAN_UNPACK(uint64, self->psd_stats.processed);
+  SUSCAN_UNPACK(uint64, self->psd_stats.skipped);
+  SUSCAN_UNPACK(uint64, self->psd_stats.dropped);
 
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
@@ -339,6 +359,295 @@ fail:
   return NULL;
 }
 
+/**************************** Panorama message ********************************/
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_panorama_msg)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+  unsigned int i;
+
+  SUSCAN_PACK(freq,  self->min_freq);
+  SUSCAN_PACK(freq,  self->max_freq);
+  SUSCAN_PACK(uint,  self->bins);
+  SUSCAN_PACK(bool,  self->reset);
+  SUSCAN_PACK(uint,  self->timestamp.tv_sec);
+  SUSCAN_PACK(uint,  self->timestamp.tv_usec);
+  SUSCAN_PACK(uint,  self->rt_time.tv_sec);
+  SUSCAN_PACK(uint,  self->rt_time.tv_usec);
+  SUSCAN_PACK(float, self->sweep_rate);
+
+  SU_TRYCATCH(
+      cbor_pack_array_start(buffer, self->range_count) == 0,
+      goto fail);
+
+  for (i = 0; i < self->range_count; ++i) {
+    SUSCAN_PACK(uint, self->range_list[i]->first);
+    SU_TRYCATCH(
+        suscan_pack_compact_single_array(
+            buffer,
+            self->range_list[i]->data,
+            self->range_list[i]->size),
+        goto fail);
+  }
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE void
+suscan_analyzer_panorama_range_destroy(
+    struct suscan_analyzer_panorama_range *self)
+{
+  if (self->data != NULL)
+    free(self->data);
+
+  free(self);
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_panorama_msg)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+  struct suscan_analyzer_panorama_range *range = NULL;
+  uint64_t tv_sec = 0;
+  uint32_t tv_usec = 0;
+  uint64_t nelem;
+  SUBOOL end_required = SU_FALSE;
+  unsigned int i;
+
+  SUSCAN_UNPACK(freq,   self->min_freq);
+  SUSCAN_UNPACK(freq,   self->max_freq);
+  SUSCAN_UNPACK(uint32, self->bins);
+  SUSCAN_UNPACK(bool,   self->reset);
+
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->timestamp.tv_sec  = tv_sec;
+  self->timestamp.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->rt_time.tv_sec  = tv_sec;
+  self->rt_time.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(float,  self->sweep_rate);
+
+  SU_TRYCATCH(
+      cbor_unpack_array_start(
+          buffer,
+          &nelem,
+          &end_required) == 0,
+      goto fail);
+  SU_TRYCATCH(!end_required, goto fail);
+
+  for (i = 0; i < nelem; ++i) {
+    SU_TRYCATCH(
+        range = calloc(1, sizeof(struct suscan_analyzer_panorama_range)),
+        goto fail);
+
+    SUSCAN_UNPACK(uint32, range->first);
+    SU_TRYCATCH(
+        suscan_unpack_compact_single_array(
+            buffer,
+            &range->data,
+            &range->size),
+        goto fail);
+
+    SU_TRYCATCH(range->first + range->size <= self->bins, goto fail);
+    SU_TRYCATCH(PTR_LIST_APPEND_CHECK(self->range, range) != -1, goto fail);
+    range = NULL;
+  }
+
+  SUSCAN_UNPACK_BOILERPLATE_FINALLY;
+
+  if (range != NULL)
+    suscan_analyzer_panorama_range_destroy(range);
+
+  SUSCAN_UNPACK_BOILERPLATE_RETURN;
+}
+
+struct suscan_analyzer_panorama_msg *
+suscan_analyzer_panorama_msg_new(void)
+{
+  struct suscan_analyzer_panorama_msg *new = NULL;
+
+  SU_TRYCATCH(
+      new = calloc(1, sizeof(struct suscan_analyzer_panorama_msg)),
+      return NULL);
+
+  gettimeofday(&new->rt_time, NULL);
+
+  return new;
+}
+
+SUBOOL
+suscan_analyzer_panorama_msg_add_range(
+    struct suscan_analyzer_panorama_msg *msg,
+    uint32_t first,
+    const SUFLOAT *data,
+    SUSCOUNT size)
+{
+  struct suscan_analyzer_panorama_range *range = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_ALLOCATE(range, struct suscan_analyzer_panorama_range);
+  SU_ALLOCATE_MANY(range->data, size, SUFLOAT);
+
+  memcpy(range->data, data, size * sizeof(SUFLOAT));
+  range->first = first;
+  range->size  = size;
+
+  SU_TRYC(PTR_LIST_APPEND_CHECK(msg->range, range));
+  range = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (range != NULL)
+    suscan_analyzer_panorama_range_destroy(range);
+
+  return ok;
+}
+
+void
+suscan_analyzer_panorama_msg_destroy(struct suscan_analyzer_panorama_msg *msg)
+{
+  unsigned int i;
+
+  for (i = 0; i < msg->range_count; ++i)
+    if (msg->range_list[i] != NULL)
+      suscan_analyzer_panorama_range_destroy(msg->range_list[i]);
+
+  if (msg->range_list != NULL)
+    free(msg->range_list);
+
+  free(msg);
+}
+
+/*********************** Spectral statistics message **************************/
+SUSCAN_SERIALIZER_PROTO(suscan_analyzer_spectral_stats_msg)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+  const SUFLOAT *arrays[] = {
+    self->max, self->min, self->mean, self->pct, self->duty
+  };
+  unsigned int i;
+
+  SUSCAN_PACK(int,   self->fc);
+  SUSCAN_PACK(float, self->samp_rate);
+  SUSCAN_PACK(uint,  self->start.tv_sec);
+  SUSCAN_PACK(uint,  self->start.tv_usec);
+  SUSCAN_PACK(uint,  self->timestamp.tv_sec);
+  SUSCAN_PACK(uint,  self->timestamp.tv_usec);
+  SUSCAN_PACK(uint,  self->rt_time.tv_sec);
+  SUSCAN_PACK(uint,  self->rt_time.tv_usec);
+  SUSCAN_PACK(uint,  self->frames);
+  SUSCAN_PACK(float, self->threshold);
+  SUSCAN_PACK(float, self->percentile);
+
+  for (i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i)
+    SU_TRYCATCH(
+        suscan_pack_compact_single_array(buffer, arrays[i], self->size),
+        goto fail);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_spectral_stats_msg)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+  SUFLOAT **arrays[] = {
+    &self->max, &self->min, &self->mean, &self->pct, &self->duty
+  };
+  uint64_t tv_sec = 0;
+  uint32_t tv_usec = 0;
+  SUSCOUNT size;
+  unsigned int i;
+
+  SUSCAN_UNPACK(int64,  self->fc);
+  SUSCAN_UNPACK(float,  self->samp_rate);
+
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->start.tv_sec  = tv_sec;
+  self->start.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->timestamp.tv_sec  = tv_sec;
+  self->timestamp.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(uint64, tv_sec);
+  SUSCAN_UNPACK(uint32, tv_usec);
+  self->rt_time.tv_sec  = tv_sec;
+  self->rt_time.tv_usec = tv_usec;
+
+  SUSCAN_UNPACK(uint64, self->frames);
+  SUSCAN_UNPACK(float,  self->threshold);
+  SUSCAN_UNPACK(float,  self->percentile);
+
+  /* All arrays must have the same size */
+  for (i = 0; i < sizeof(arrays) / sizeof(arrays[0]); ++i) {
+    SU_TRYCATCH(
+        suscan_unpack_compact_single_array(buffer, arrays[i], &size),
+        goto fail);
+
+    if (i == 0)
+      self->size = size;
+
+    SU_TRYCATCH(size == self->size, goto fail);
+  }
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
+struct suscan_analyzer_spectral_stats_msg *
+suscan_analyzer_spectral_stats_msg_new(SUSCOUNT size)
+{
+  struct suscan_analyzer_spectral_stats_msg *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_analyzer_spectral_stats_msg);
+
+  if (size > 0) {
+    SU_ALLOCATE_MANY_FAIL(new->max,  size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->min,  size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->mean, size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->pct,  size, SUFLOAT);
+    SU_ALLOCATE_MANY_FAIL(new->duty, size, SUFLOAT);
+  }
+
+  new->size = size;
+
+  gettimeofday(&new->rt_time, NULL);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_analyzer_spectral_stats_msg_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_analyzer_spectral_stats_msg_destroy(
+    struct suscan_analyzer_spectral_stats_msg *msg)
+{
+  if (msg->max != NULL)
+    free(msg->max);
+
+  if (msg->min != NULL)
+    free(msg->min);
+
+  if (msg->mean != NULL)
+    free(msg->mean);
+
+  if (msg->pct != NULL)
+    free(msg->pct);
+
+  if (msg->duty != NULL)
+    free(msg->duty);
+
+  free(msg);
+}
+
 /***************************** Inspector message ******************************/
 SUSCAN_SERIALIZABLE(sigutils_channel);
 
@@ -651,6 +960,32 @@ suscan_analyzer_inspector_msg_deserialize_set_watermark(
   SUSCAN_UNPACK_BOILERPLATE_END;
 }
 
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_serialize_set_estimator_schedule(
+    grow_buf_t *buffer,
+    const struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_PACK_BOILERPLATE_START;
+
+  SUSCAN_PACK(float, self->estimator_interval);
+  SUSCAN_PACK(uint,  self->estimator_window);
+
+  SUSCAN_PACK_BOILERPLATE_END;
+}
+
+SUPRIVATE SUBOOL
+suscan_analyzer_inspector_msg_deserialize_set_estimator_schedule(
+    grow_buf_t *buffer,
+    struct suscan_analyzer_inspector_msg *self)
+{
+  SUSCAN_UNPACK_BOILERPLATE_START;
+
+  SUSCAN_UNPACK(float,  self->estimator_interval);
+  SUSCAN_UNPACK(uint64, self->estimator_window);
+
+  SUSCAN_UNPACK_BOILERPLATE_END;
+}
+
 SUPRIVATE SUBOOL
 suscan_analyzer_inspector_msg_serialize_set_tle(
     grow_buf_t *buffer,
@@ -854,6 +1189,15 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
       SU_TRYCATCH(
           suscan_analyzer_inspector_msg_serialize_signal(buffer, self),
           goto fail);
+      break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_ESTIMATOR_SCHEDULE:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_serialize_set_estimator_schedule(
+              buffer,
+              self),
+          goto fail);
+      break;
     
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_NOOP:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_ID:
@@ -866,6 +1210,7 @@ SUSCAN_SERIALIZER_PROTO(suscan_analyzer_inspector_msg)
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_KIND:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CHANNEL:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CORRECTION:
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_REQUEST_ESTIMATES:
       /* Empty messages */
       break;
 
@@ -954,6 +1299,14 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
           suscan_analyzer_inspector_msg_deserialize_signal(buffer, self),
           goto fail);
       break;
+
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_ESTIMATOR_SCHEDULE:
+      SU_TRYCATCH(
+          suscan_analyzer_inspector_msg_deserialize_set_estimator_schedule(
+              buffer,
+              self),
+          goto fail);
+      break;
     
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_NOOP:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_ID:
@@ -966,6 +1319,7 @@ SUSCAN_DESERIALIZER_PROTO(suscan_analyzer_inspector_msg)
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_WRONG_KIND:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CHANNEL:
     case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CORRECTION:
+    case SUSCAN_ANALYZER_INSPECTOR_MSGKIND_REQUEST_ESTIMATES:
       /* Empty messages */
       break;
 
@@ -1275,6 +1629,14 @@ suscan_analyzer_msg_serialize(
     case SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY:
       SU_TRY_FAIL(suscan_analyzer_replay_msg_serialize(ptr, buffer));
       break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA:
+      SU_TRY_FAIL(suscan_analyzer_panorama_msg_serialize(ptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS:
+      SU_TRY_FAIL(suscan_analyzer_spectral_stats_msg_serialize(ptr, buffer));
+      break;
     
   }
 
@@ -1360,6 +1722,17 @@ suscan_analyzer_msg_deserialize(uint32_t *type, void **ptr, grow_buf_t *buffer)
       SU_TRY_FAIL(suscan_analyzer_replay_msg_deserialize(msgptr, buffer));
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA:
+      SU_TRY_FAIL(msgptr = suscan_analyzer_panorama_msg_new());
+      SU_TRY_FAIL(suscan_analyzer_panorama_msg_deserialize(msgptr, buffer));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS:
+      SU_TRY_FAIL(msgptr = suscan_analyzer_spectral_stats_msg_new(0));
+      SU_TRY_FAIL(
+        suscan_analyzer_spectral_stats_msg_deserialize(msgptr, buffer));
+      break;
+
     default:
       SU_WARNING("Unknown message type `%d'\n", *type);
       goto fail;
@@ -1404,6 +1777,14 @@ suscan_analyzer_dispose_message(uint32_t type, void *ptr)
       suscan_analyzer_psd_msg_destroy(ptr);
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA:
+      suscan_analyzer_panorama_msg_destroy(ptr);
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS:
+      suscan_analyzer_spectral_stats_msg_destroy(ptr);
+      break;
+
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
       suscan_analyzer_sample_batch_msg_destroy(ptr);
       break;
@@ -1540,10 +1921,18 @@ done:
   return ok;
 }
 
+/*
+ * PSD of a wide sweep capture. Captures are transformed while the source
+ * is already at the next hop, so frequency and time are those of the
+ * capture, not the current ones.
+ */
 SUBOOL
-suscan_analyzer_send_psd(
+suscan_analyzer_send_sweep_psd(
     suscan_analyzer_t *self,
-    const su_channel_detector_t *detector)
+    const su_channel_detector_t *detector,
+    SUFREQ fc,
+    const struct timeval *timestamp,
+    SUFLOAT sweep_rate)
 {
   struct suscan_analyzer_psd_msg *msg = NULL;
   SUBOOL ok = SU_FALSE;
@@ -1558,12 +1947,12 @@ suscan_analyzer_send_psd(
     goto done;
   }
 
-  /* In wide spectrum mode, frequency is given by curr_freq */
-  msg->fc = suscan_analyzer_get_source_info(self)->frequency;
+  msg->fc = fc;
   msg->samp_rate = suscan_analyzer_get_source_info(self)->source_samp_rate;
   msg->measured_samp_rate = suscan_analyzer_get_measured_samp_rate(self);
-  suscan_analyzer_get_source_time(self, &msg->timestamp);
+  msg->timestamp = *timestamp;
   msg->N0 = detector->N0;
+  msg->sweep_rate = sweep_rate;
 
   if (!suscan_mq_write(
       self->mq_out,
@@ -1590,12 +1979,128 @@ done:
   return ok;
 }
 
+SUBOOL
+suscan_analyzer_send_psd(
+    suscan_analyzer_t *self,
+    const su_channel_detector_t *detector)
+{
+  struct timeval timestamp;
+
+  suscan_analyzer_get_source_time(self, &timestamp);
+
+  return suscan_analyzer_send_sweep_psd(
+      self,
+      detector,
+      suscan_analyzer_get_source_info(self)->frequency,
+      &timestamp,
+      0);
+}
+
+SUBOOL
+suscan_analyzer_send_panorama(
+    suscan_analyzer_t *self,
+    struct suscan_panorama *panorama,
+    const struct timeval *timestamp,
+    SUFLOAT sweep_rate)
+{
+  struct suscan_analyzer_panorama_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if ((msg = suscan_analyzer_panorama_msg_new()) == NULL) {
+    suscan_analyzer_send_status(
+        self,
+        SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL,
+        -1,
+        "Cannot create message: %s",
+        strerror(errno));
+    goto done;
+  }
+
+  SU_TRY(suscan_panorama_take_update(panorama, msg));
+
+  msg->timestamp  = *timestamp;
+  msg->sweep_rate = sweep_rate;
+
+  if (!suscan_mq_write(
+      self->mq_out,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA,
+      msg)) {
+    suscan_analyzer_send_status(
+        self,
+        SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL,
+        -1,
+        "Cannot write message: %s",
+        strerror(errno));
+    goto done;
+  }
+
+  /* Message queued, forget about it */
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_dispose_message(SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA, msg);
+
+  return ok;
+}
+
+SUBOOL
+suscan_analyzer_send_spectral_stats(
+    suscan_analyzer_t *self,
+    const struct suscan_spectstats *stats)
+{
+  struct suscan_analyzer_spectral_stats_msg *msg = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  if ((msg = suscan_analyzer_spectral_stats_msg_new(stats->size)) == NULL) {
+    suscan_analyzer_send_status(
+        self,
+        SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL,
+        -1,
+        "Cannot create message: %s",
+        strerror(errno));
+    goto done;
+  }
+
+  SU_TRY(suscan_spectstats_report(stats, msg));
+
+  if (!suscan_mq_write(
+      self->mq_out,
+      SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS,
+      msg)) {
+    suscan_analyzer_send_status(
+        self,
+        SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL,
+        -1,
+        "Cannot write message: %s",
+        strerror(errno));
+    goto done;
+  }
+
+  /* Message queued, forget about it */
+  msg = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (msg != NULL)
+    suscan_analyzer_dispose_message(
+      SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS,
+      msg);
+
+  return ok;
+}
+
 SUBOOL
 suscan_analyzer_send_psd_from_smoothpsd(
     suscan_analyzer_t *self,
     const su_smoothpsd_t *smoothpsd,
     SUBOOL looped,
-    SUSCOUNT history_size)
+    SUSCOUNT history_size,
+    const struct suscan_analyzer_channelizer_timings *timings,
+    const struct suscan_analyzer_psd_sched_stats *psd_stats)
 {
   struct suscan_analyzer_psd_msg *msg = NULL;
   SUBOOL ok = SU_FALSE;
@@ -1621,6 +2126,12 @@ suscan_analyzer_send_psd_from_smoothpsd(
   msg->history_size = history_size;
   msg->N0 = 0;
 
+  if (timings != NULL)
+    msg->timings = *timings;
+
+  if (psd_stats != NULL)
+    msg->psd_stats = *psd_stats;
+
   if (!suscan_mq_write(
       self->mq_out,
       SUSCAN_ANALYZER_MESSAGE_TYPE_PSD,
@@ -32,6 +32,9 @@
 extern "C" {
 #endif /* __cplusplus */
 
+struct suscan_panorama;
+struct suscan_spectstats;
+
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_SOURCE_INFO   0x0
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_SOURCE_INIT   0x1
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_CHANNEL       0x2
@@ -48,6 +51,8 @@ extern "C" {
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_SEEK          0xd
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_HISTORY_SIZE  0xe
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_REPLAY        0xf
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA      0x10 /* Stitched sweep */
+#define SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS 0x11 /* Long-term spectrum */
 
 /* Invalid message. No one should even send this. */
 #define SUSCAN_ANALYZER_MESSAGE_TYPE_INVALID       0x8000000
@@ -103,6 +108,28 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_replay_msg) {
 
 
 /* Channel spectrum message */
+/*
+ * Smoothed per-stage timings of the pipelined channelizer, in nanoseconds
+ * per buffer. All zero if the channelizer is not pipelined.
+ */
+struct suscan_analyzer_channelizer_timings {
+  SUFLOAT read;       /* Source read */
+  SUFLOAT prepare;    /* Overlap copy, baseband filters and PSD */
+  SUFLOAT wait;       /* Source worker waiting for the channelizer */
+  SUFLOAT channelize; /* Forward FFT and channel outputs */
+  SUFLOAT inspectors; /* Inspector barrier */
+};
+
+/*
+ * PSD scheduler counters of the last rate measurement interval, in
+ * samples read from the source.
+ */
+struct suscan_analyzer_psd_sched_stats {
+  SUSCOUNT processed; /* Delivered to the PSD */
+  SUSCOUNT skipped;   /* Not needed for the PSD refresh rate */
+  SUSCOUNT dropped;   /* Needed, but no buffer was available */
+};
+
 SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
   int64_t fc;
   uint32_t inspector_id;
@@ -113,6 +140,9 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
   SUFLOAT  samp_rate;
   SUFLOAT  measured_samp_rate;
   SUFLOAT  N0;
+  SUFLOAT  sweep_rate;        /* Wide spectrum mode only (Hz/s) */
+  struct suscan_analyzer_channelizer_timings timings;
+  struct suscan_analyzer_psd_sched_stats psd_stats;
   SUSCOUNT psd_size;
   SUFLOAT *psd_data;
 };
@@ -120,6 +150,42 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_psd_msg) {
 /* These messages allow partial deserialization */
 SUSCAN_PARTIAL_DESERIALIZER_PROTO(suscan_analyzer_psd_msg);
 
+/* Stitched spectrum update (wide spectrum mode). Bins out of ranges are kept */
+struct suscan_analyzer_panorama_range {
+  uint32_t first;
+  SUSCOUNT size;
+  SUFLOAT *data;
+};
+
+SUSCAN_SERIALIZABLE(suscan_analyzer_panorama_msg) {
+  SUFREQ   min_freq;
+  SUFREQ   max_freq;
+  uint32_t bins;
+  SUBOOL   reset;             /* Bins not in any range are unknown */
+  struct   timeval timestamp; /* Timestamp of the last hop */
+  struct   timeval rt_time;   /* Real time timestamp */
+  SUFLOAT  sweep_rate;        /* Hz/s */
+  PTR_LIST(struct suscan_analyzer_panorama_range, range);
+};
+
+/* Cumulative per-bin statistics of the main spectrum, since start */
+SUSCAN_SERIALIZABLE(suscan_analyzer_spectral_stats_msg) {
+  int64_t  fc;
+  SUFLOAT  samp_rate;
+  struct   timeval start;     /* Timestamp of the first PSD */
+  struct   timeval timestamp; /* Timestamp of the last PSD */
+  struct   timeval rt_time;   /* Real time timestamp */
+  SUSCOUNT frames;
+  SUFLOAT  threshold;         /* Occupancy threshold (dB) */
+  SUFLOAT  percentile;
+  SUSCOUNT size;
+  SUFLOAT *max;
+  SUFLOAT *min;
+  SUFLOAT *mean;
+  SUFLOAT *pct;               /* Estimated percentile */
+  SUFLOAT *duty;              /* Fraction of PSDs above threshold */
+};
+
 /* Channel sample batch */
 SUSCAN_SERIALIZABLE(suscan_analyzer_sample_batch_msg) {
   uint32_t   inspector_id;
@@ -153,6 +219,8 @@ enum suscan_analyzer_inspector_msgkind {
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_ORBIT_REPORT,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_INVALID_CORRECTION,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SIGNAL,
+  SUSCAN_ANALYZER_INSPECTOR_MSGKIND_SET_ESTIMATOR_SCHEDULE,
+  SUSCAN_ANALYZER_INSPECTOR_MSGKIND_REQUEST_ESTIMATES,
   SUSCAN_ANALYZER_INSPECTOR_MSGKIND_COUNT
 };
 
@@ -185,6 +253,8 @@ suscan_analyzer_inspector_msgkind_to_string(
     SUSCAN_COMP_MSGKIND(ORBIT_REPORT);
     SUSCAN_COMP_MSGKIND(INVALID_CORRECTION);
     SUSCAN_COMP_MSGKIND(SIGNAL);
+    SUSCAN_COMP_MSGKIND(SET_ESTIMATOR_SCHEDULE);
+    SUSCAN_COMP_MSGKIND(REQUEST_ESTIMATES);
 
     default:
       return "UNKNOWN";
@@ -242,6 +312,11 @@ SUSCAN_SERIALIZABLE(suscan_analyzer_inspector_msg) {
       char    *signal_name;
       SUDOUBLE signal_value;
     };
+
+    struct {
+      SUFLOAT  estimator_interval; /* Seconds. 0: only on request */
+      SUSCOUNT estimator_window;   /* Samples. 0: default */
+    };
     
     struct suscan_orbit_report orbit_report;
 
@@ -269,11 +344,30 @@ SUBOOL suscan_analyzer_send_psd(
     suscan_analyzer_t *analyzer,
     const su_channel_detector_t *detector);
 
+SUBOOL suscan_analyzer_send_sweep_psd(
+    suscan_analyzer_t *analyzer,
+    const su_channel_detector_t *detector,
+    SUFREQ fc,
+    const struct timeval *timestamp,
+    SUFLOAT sweep_rate);
+
+SUBOOL suscan_analyzer_send_panorama(
+    suscan_analyzer_t *analyzer,
+    struct suscan_panorama *panorama,
+    const struct timeval *timestamp,
+    SUFLOAT sweep_rate);
+
+SUBOOL suscan_analyzer_send_spectral_stats(
+    suscan_analyzer_t *analyzer,
+    const struct suscan_spectstats *stats);
+
 SUBOOL suscan_analyzer_send_psd_from_smoothpsd(
     suscan_analyzer_t *self,
     const su_smoothpsd_t *smoothpsd,
     SUBOOL looped,
-    SUSCOUNT history_size);
+    SUSCOUNT history_size,
+    const struct suscan_analyzer_channelizer_timings *timings,
+    const struct suscan_analyzer_psd_sched_stats *psd_stats);
 
 SUBOOL suscan_analyzer_send_source_info(
     suscan_analyzer_t *self,
@@ -325,6 +419,25 @@ SUFLOAT *suscan_analyzer_psd_msg_take_psd(struct suscan_analyzer_psd_msg *msg);
 
 void suscan_analyzer_psd_msg_destroy(struct suscan_analyzer_psd_msg *msg);
 
+/* Panorama update message */
+struct suscan_analyzer_panorama_msg *suscan_analyzer_panorama_msg_new(void);
+
+SUBOOL suscan_analyzer_panorama_msg_add_range(
+    struct suscan_analyzer_panorama_msg *msg,
+    uint32_t first,
+    const SUFLOAT *data,
+    SUSCOUNT size);
+
+void suscan_analyzer_panorama_msg_destroy(
+    struct suscan_analyzer_panorama_msg *msg);
+
+/* Spectral statistics message */
+struct suscan_analyzer_spectral_stats_msg *
+suscan_analyzer_spectral_stats_msg_new(SUSCOUNT size);
+
+void suscan_analyzer_spectral_stats_msg_destroy(
+    struct suscan_analyzer_spectral_stats_msg *msg);
+
 /* Sample batch message */
 struct suscan_analyzer_sample_batch_msg *suscan_analyzer_sample_batch_msg_new(
     uint32_t inspector_id,
@@ -0,0 +1,232 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SU_LOG_DOMAIN "panorama"
+
+#include <sigutils/sigutils.h>
+#include "panorama.h"
+#include "msg.h"
+
+SUINLINE void
+suscan_panorama_clear_dirty(suscan_panorama_t *self)
+{
+  self->dirty_first = self->bins;
+  self->dirty_last  = 0;
+}
+
+suscan_panorama_t *
+suscan_panorama_new(SUFREQ min_freq, SUFREQ max_freq, SUSCOUNT bins)
+{
+  suscan_panorama_t *new = NULL;
+
+  SU_TRYCATCH(max_freq > min_freq, goto fail);
+  SU_TRYCATCH(bins > 0 && bins <= SUSCAN_PANORAMA_MAX_BINS, goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_panorama_t);
+
+  new->min_freq  = min_freq;
+  new->max_freq  = max_freq;
+  new->bins      = bins;
+  new->bin_width = (max_freq - min_freq) / bins;
+
+  SU_ALLOCATE_MANY_FAIL(new->psd,   bins, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->dirty, bins, uint8_t);
+
+  suscan_panorama_clear_dirty(new);
+
+  /* Nothing received yet: first update must clear the client's panorama */
+  new->reset = SU_TRUE;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_panorama_destroy(new);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_panorama_matches(
+    const suscan_panorama_t *self,
+    SUFREQ min_freq,
+    SUFREQ max_freq,
+    SUSCOUNT bins)
+{
+  return self->min_freq == min_freq
+    && self->max_freq == max_freq
+    && self->bins == bins;
+}
+
+/*
+ * Stitches the PSD of a hop centered at fc. Only the central fraction
+ * (keep) of the hop's spectrum is used, the rest is either outside the
+ * partition of this hop or affected by the rolloff of the front end.
+ * Panorama bins wider than the hop bins get the mean of the hop bins
+ * they cover, narrower ones get the closest hop bin.
+ */
+void
+suscan_panorama_feed(
+    suscan_panorama_t *self,
+    const su_channel_detector_t *cd,
+    SUFREQ fc,
+    SUFLOAT keep)
+{
+  SUSCOUNT size = cd->params.window_size;
+  SUFLOAT fs = cd->params.samp_rate;
+  SUFLOAT hop_width, half, a, b, acc, re, im;
+  SUSDIFF first, last, j, k, k0, k1, idx;
+
+  if (cd->params.decimation > 1)
+    fs /= cd->params.decimation;
+
+  keep = SU_MIN(keep, 1 - 2 * SUSCAN_PANORAMA_EDGE_TRIM);
+
+  hop_width = fs / size;
+  half      = .5 * keep * fs;
+
+  /* Panorama bins whose center falls in the useful part of the hop */
+  first = SU_CEIL((fc - half - self->min_freq) / self->bin_width - .5);
+  last  = SU_CEIL((fc + half - self->min_freq) / self->bin_width - .5) - 1;
+
+  if (first < 0)
+    first = 0;
+  if (last >= (SUSDIFF) self->bins)
+    last = self->bins - 1;
+
+  for (j = first; j <= last; ++j) {
+    a = (self->min_freq + j * self->bin_width - fc) / hop_width;
+    b = a + self->bin_width / hop_width;
+
+    k0 = SU_FLOOR(a + .5);
+    k1 = SU_FLOOR(b + .5);
+
+    if (k1 <= k0) {
+      k0 = SU_FLOOR(.5 * (a + b) + .5);
+      k1 = k0 + 1;
+    }
+
+    if (k0 < -(SUSDIFF) size / 2)
+      k0 = -(SUSDIFF) size / 2;
+    if (k1 > (SUSDIFF) size / 2)
+      k1 = size / 2;
+
+    acc = 0;
+    for (k = k0; k < k1; ++k) {
+      idx = k < 0 ? k + size : k;
+      re  = SU_C_REAL(cd->fft[idx]);
+      im  = SU_C_IMAG(cd->fft[idx]);
+      acc += re * re + im * im;
+    }
+
+    if (k1 > k0)
+      self->psd[j] = acc / ((k1 - k0) * size);
+
+    self->dirty[j] = 1;
+  }
+
+  if (first <= last) {
+    if ((SUSCOUNT) first < self->dirty_first)
+      self->dirty_first = first;
+    if ((SUSCOUNT) last > self->dirty_last)
+      self->dirty_last = last;
+  }
+}
+
+/*
+ * Moves the bins changed since the last update to a panorama message.
+ * Runs of dirty bins separated by a few clean bins are sent as a single
+ * range, as the range header would cost more than the clean bins.
+ */
+SUBOOL
+suscan_panorama_take_update(
+    suscan_panorama_t *self,
+    struct suscan_analyzer_panorama_msg *msg)
+{
+  SUSCOUNT i, start, end, gap;
+  SUBOOL ok = SU_FALSE;
+
+  msg->min_freq = self->min_freq;
+  msg->max_freq = self->max_freq;
+  msg->bins     = self->bins;
+  msg->reset    = self->reset;
+
+  if (self->reset) {
+    /* Resend everything */
+    self->dirty_first = 0;
+    self->dirty_last  = self->bins - 1;
+    memset(self->dirty, 1, self->bins);
+  }
+
+  i = self->dirty_first;
+  while (suscan_panorama_is_dirty(self) && i <= self->dirty_last) {
+    /* Find the start of the next run */
+    while (i <= self->dirty_last && !self->dirty[i])
+      ++i;
+
+    if (i > self->dirty_last)
+      break;
+
+    start = end = i;
+    gap = 0;
+
+    /* Extend it, tolerating short gaps */
+    while (++i <= self->dirty_last && gap < SUSCAN_PANORAMA_MIN_GAP) {
+      if (self->dirty[i]) {
+        end = i;
+        gap = 0;
+      } else {
+        ++gap;
+      }
+    }
+
+    SU_TRY(
+      suscan_analyzer_panorama_msg_add_range(
+        msg,
+        start,
+        self->psd + start,
+        end - start + 1));
+
+    memset(self->dirty + start, 0, end - start + 1);
+    i = end + 1;
+  }
+
+  suscan_panorama_clear_dirty(self);
+  self->reset = SU_FALSE;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+void
+suscan_panorama_destroy(suscan_panorama_t *self)
+{
+  if (self->dirty != NULL)
+    free(self->dirty);
+
+  if (self->psd != NULL)
+    free(self->psd);
+
+  free(self);
+}
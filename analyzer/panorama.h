@@ -0,0 +1,96 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _PANORAMA_H
+#define _PANORAMA_H
+
+#include <sigutils/sigutils.h>
+#include <sigutils/detect.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_PANORAMA_MAX_BINS   (1 << 24)
+#define SUSCAN_PANORAMA_EDGE_TRIM  .1  /* Of each hop, lost to FFT rolloff */
+#define SUSCAN_PANORAMA_MIN_GAP    16  /* Clean bins worth a new range */
+
+struct suscan_analyzer_panorama_msg;
+
+/*
+ * The panorama is a fixed-resolution PSD of the whole sweep span, stitched
+ * from the PSDs of the individual hops. Each hop only contributes the
+ * central part of its spectrum, and the bins it touches are marked as
+ * dirty so that only those get sent to the client.
+ */
+struct suscan_panorama {
+  SUFREQ    min_freq;
+  SUFREQ    max_freq;
+  SUSCOUNT  bins;
+  SUFREQ    bin_width;
+
+  SUFLOAT  *psd;
+  uint8_t  *dirty;
+  SUSCOUNT  dirty_first;
+  SUSCOUNT  dirty_last;   /* Inclusive. Clean if dirty_last < dirty_first */
+  SUBOOL    reset;        /* Next update must replace the client's copy */
+};
+
+typedef struct suscan_panorama suscan_panorama_t;
+
+SUINLINE SUBOOL
+suscan_panorama_is_dirty(const suscan_panorama_t *self)
+{
+  return self->dirty_last >= self->dirty_first;
+}
+
+SUINLINE SUSCOUNT
+suscan_panorama_get_bins(const suscan_panorama_t *self)
+{
+  return self->bins;
+}
+
+suscan_panorama_t *suscan_panorama_new(
+    SUFREQ min_freq,
+    SUFREQ max_freq,
+    SUSCOUNT bins);
+
+SUBOOL suscan_panorama_matches(
+    const suscan_panorama_t *self,
+    SUFREQ min_freq,
+    SUFREQ max_freq,
+    SUSCOUNT bins);
+
+void suscan_panorama_feed(
+    suscan_panorama_t *self,
+    const su_channel_detector_t *cd,
+    SUFREQ fc,
+    SUFLOAT keep);
+
+SUBOOL suscan_panorama_take_update(
+    suscan_panorama_t *self,
+    struct suscan_analyzer_panorama_msg *msg);
+
+void suscan_panorama_destroy(suscan_panorama_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _PANORAMA_H */
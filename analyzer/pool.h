@@ -75,6 +75,12 @@ SU_GETTER(suscan_sample_buffer, SUBOOL, is_circular)
   return self->circular;
 }
 
+SUINLINE
+SU_GETTER(suscan_sample_buffer, struct suscan_sample_buffer_pool *, parent)
+{
+  return self->parent;
+}
+
 SUINLINE
 SU_METHOD(suscan_sample_buffer, void, set_userdata, void *userdata)
 {
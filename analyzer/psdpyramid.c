@@ -0,0 +1,284 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SU_LOG_DOMAIN "psdpyramid"
+
+#include <sigutils/sigutils.h>
+#include "psdpyramid.h"
+#include "msg.h"
+
+SUPRIVATE void
+suscan_psd_pyramid_release_levels(suscan_psd_pyramid_t *self)
+{
+  unsigned int a, k;
+
+  for (a = 0; a < SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT; ++a) {
+    for (k = 0; k < self->level_count; ++k) {
+      if (self->level[a][k] != NULL) {
+        free(self->level[a][k]);
+        self->level[a][k] = NULL;
+      }
+    }
+
+    self->valid[a] = 0;
+  }
+
+  self->level_count = 0;
+}
+
+SUPRIVATE SUBOOL
+suscan_psd_pyramid_resize(suscan_psd_pyramid_t *self, SUSCOUNT size)
+{
+  SUFLOAT *tmp;
+  unsigned int a, k, count = 0;
+  SUBOOL ok = SU_FALSE;
+
+  suscan_psd_pyramid_release_levels(self);
+  self->size = 0;
+
+  SU_TRY(tmp = realloc(self->psd, size * sizeof(SUFLOAT)));
+  self->psd = tmp;
+
+  SU_TRY(tmp = realloc(self->view_buf, size * sizeof(SUFLOAT)));
+  self->view_buf = tmp;
+
+  /* Keep halving while the size is even and big enough */
+  while (count < SUSCAN_PSD_PYRAMID_MAX_LEVELS
+      && (size >> count) % 2 == 0
+      && (size >> (count + 1)) >= SUSCAN_PSD_PYRAMID_MIN_SIZE)
+    ++count;
+
+  self->level_count = count;
+
+  for (a = 0; a < SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT; ++a)
+    for (k = 0; k < count; ++k)
+      SU_ALLOCATE_MANY(self->level[a][k], size >> (k + 1), SUFLOAT);
+
+  self->size = size;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/*
+ * Halves the resolution of a PSD in FFT order. Coarse bin j is centered
+ * at fine bin 2j and also covers half of each of its neighbors, so
+ * that the DC bin stays centered across levels.
+ */
+SUPRIVATE void
+suscan_psd_pyramid_derive(
+    SUFLOAT *coarse,
+    const SUFLOAT *fine,
+    SUSCOUNT size,
+    enum suscan_analyzer_psd_aggregation aggregation)
+{
+  SUSCOUNT j, c;
+  SUFLOAT l, m, r;
+
+  for (j = 0; j < size / 2; ++j) {
+    c = 2 * j;
+    l = fine[c == 0 ? size - 1 : c - 1];
+    m = fine[c];
+    r = fine[c + 1];
+
+    if (aggregation == SUSCAN_ANALYZER_PSD_AGGREGATION_MAX)
+      coarse[j] = SU_MAX(m, SU_MAX(l, r));
+    else
+      coarse[j] = .25 * (l + r) + .5 * m;
+  }
+}
+
+suscan_psd_pyramid_t *
+suscan_psd_pyramid_new(void)
+{
+  suscan_psd_pyramid_t *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, suscan_psd_pyramid_t);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_psd_pyramid_destroy(new);
+
+  return NULL;
+}
+
+/* Replaces the finest level. Coarser levels are recomputed on demand */
+SUBOOL
+suscan_psd_pyramid_feed(
+    suscan_psd_pyramid_t *self,
+    const SUFLOAT *psd,
+    SUSCOUNT size)
+{
+  unsigned int a;
+
+  SU_TRYCATCH(size > 0, return SU_FALSE);
+
+  if (size != self->size)
+    SU_TRYCATCH(suscan_psd_pyramid_resize(self, size), return SU_FALSE);
+
+  memcpy(self->psd, psd, size * sizeof(SUFLOAT));
+
+  for (a = 0; a < SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT; ++a)
+    self->valid[a] = 0;
+
+  return SU_TRUE;
+}
+
+/*
+ * Returns the coarsest level with at least *size bins (or the finest one,
+ * if none has that many) and updates *size accordingly.
+ */
+const SUFLOAT *
+suscan_psd_pyramid_get_level(
+    suscan_psd_pyramid_t *self,
+    enum suscan_analyzer_psd_aggregation aggregation,
+    SUSCOUNT *size)
+{
+  const SUFLOAT *prev;
+  unsigned int k = 0;
+
+  if (self->size == 0)
+    return NULL;
+
+  if (aggregation >= SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT)
+    aggregation = SUSCAN_ANALYZER_PSD_AGGREGATION_MEAN;
+
+  while (k < self->level_count && (self->size >> (k + 1)) >= *size)
+    ++k;
+
+  while (self->valid[aggregation] < k) {
+    prev = self->valid[aggregation] == 0
+      ? self->psd
+      : self->level[aggregation][self->valid[aggregation] - 1];
+
+    suscan_psd_pyramid_derive(
+        self->level[aggregation][self->valid[aggregation]],
+        prev,
+        self->size >> self->valid[aggregation],
+        aggregation);
+
+    ++self->valid[aggregation];
+  }
+
+  *size = self->size >> k;
+
+  return k == 0 ? self->psd : self->level[aggregation][k - 1];
+}
+
+/*
+ * Renders a view of the last PSD fed to the pyramid. The result is a
+ * regular PSD message, in FFT order, whose center frequency and sample
+ * rate describe the selected span. Consumers need not know it is a view.
+ */
+struct suscan_analyzer_psd_msg *
+suscan_psd_pyramid_render(
+    suscan_psd_pyramid_t *self,
+    const struct suscan_psd_view *view,
+    const struct suscan_analyzer_psd_msg *native)
+{
+  struct suscan_analyzer_psd_msg *new = NULL;
+  const SUFLOAT *data;
+  SUSCOUNT size, count, half, i, dst;
+  SUSDIFF first, last, s;
+  SUFLOAT bw;
+
+  SU_TRYCATCH(native->psd_size == self->size, goto fail);
+
+  size = view->size;
+  if (size == 0 || size > self->size)
+    size = self->size;
+
+  SU_TRYCATCH(
+      data = suscan_psd_pyramid_get_level(self, view->aggregation, &size),
+      goto fail);
+
+  bw = native->samp_rate / size;
+
+  if (suscan_psd_view_is_full_span(view) || bw <= 0) {
+    first = -(SUSDIFF) (size / 2);
+    last  = first + size - 1;
+  } else {
+    /* Bins whose center falls in the span */
+    first = SU_CEIL(view->span_min / bw);
+    last  = SU_FLOOR(view->span_max / bw);
+
+    if (first < -(SUSDIFF) (size / 2))
+      first = -(SUSDIFF) (size / 2);
+    if (last > (SUSDIFF) (size - size / 2) - 1)
+      last = size - size / 2 - 1;
+    if (last < first)
+      last = first;
+  }
+
+  count = last - first + 1;
+  half  = count / 2;
+
+  /* Back to FFT order, now around the center of the span */
+  for (i = 0; i < count; ++i) {
+    s   = first + i;
+    dst = i >= half ? i - half : i + count - half;
+    self->view_buf[dst] = data[s < 0 ? s + size : s];
+  }
+
+  SU_TRYCATCH(
+      new = suscan_analyzer_psd_msg_new_from_data(
+          count * bw,
+          self->view_buf,
+          count),
+      goto fail);
+
+  new->fc                 = native->fc + SU_FLOOR((first + half) * bw + .5);
+  new->inspector_id       = native->inspector_id;
+  new->timestamp          = native->timestamp;
+  new->rt_time            = native->rt_time;
+  new->looped             = native->looped;
+  new->history_size       = native->history_size;
+  new->measured_samp_rate = native->measured_samp_rate;
+  new->N0                 = native->N0;
+  new->sweep_rate         = native->sweep_rate;
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_analyzer_psd_msg_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_psd_pyramid_destroy(suscan_psd_pyramid_t *self)
+{
+  suscan_psd_pyramid_release_levels(self);
+
+  if (self->view_buf != NULL)
+    free(self->view_buf);
+
+  if (self->psd != NULL)
+    free(self->psd);
+
+  free(self);
+}
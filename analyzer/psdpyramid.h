@@ -0,0 +1,117 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _PSDPYRAMID_H
+#define _PSDPYRAMID_H
+
+#include <sigutils/sigutils.h>
+#include <analyzer/analyzer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_PSD_PYRAMID_MAX_LEVELS 24
+#define SUSCAN_PSD_PYRAMID_MIN_SIZE   16   /* Coarsest level worth deriving */
+
+#define SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT \
+  (SUSCAN_ANALYZER_PSD_AGGREGATION_MAX + 1)
+
+struct suscan_analyzer_psd_msg;
+
+/*
+ * The part of the spectrum a consumer is interested in. The size refers to
+ * the whole band (i.e. it is the FFT size the consumer would have asked
+ * for), the span selects which of those bins actually get delivered.
+ */
+struct suscan_psd_view {
+  SUSCOUNT size;
+  SUFREQ   span_min;
+  SUFREQ   span_max;
+  enum suscan_analyzer_psd_aggregation aggregation;
+};
+
+/*
+ * A PSD pyramid keeps the finest PSD delivered by the analyzer and lazily
+ * derives coarser resolutions from it, halving the number of bins on each
+ * level. Levels are computed at most once per PSD, no matter how many
+ * consumers ask for them.
+ */
+struct suscan_psd_pyramid {
+  SUSCOUNT size;     /* Of the finest level */
+  SUFLOAT *psd;      /* Finest level, as delivered by the analyzer */
+
+  /* level[a][k] holds size >> (k + 1) bins */
+  SUFLOAT *level[SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT][SUSCAN_PSD_PYRAMID_MAX_LEVELS];
+  unsigned int level_count;
+  unsigned int valid[SUSCAN_PSD_PYRAMID_AGGREGATION_COUNT];
+
+  SUFLOAT *view_buf; /* Scratch buffer for rendered views */
+};
+
+typedef struct suscan_psd_pyramid suscan_psd_pyramid_t;
+
+SUINLINE void
+suscan_psd_view_from_params(
+    struct suscan_psd_view *view,
+    const struct suscan_analyzer_params *params)
+{
+  view->size        = params->detector_params.window_size;
+  view->span_min    = params->psd_span_min;
+  view->span_max    = params->psd_span_max;
+  view->aggregation = params->psd_aggregation;
+}
+
+SUINLINE SUBOOL
+suscan_psd_view_is_full_span(const struct suscan_psd_view *view)
+{
+  return view->span_max <= view->span_min;
+}
+
+/* Native views can be served with the analyzer's PSD as-is */
+SUINLINE SUBOOL
+suscan_psd_view_is_native(const struct suscan_psd_view *view, SUSCOUNT size)
+{
+  return view->size >= size && suscan_psd_view_is_full_span(view);
+}
+
+suscan_psd_pyramid_t *suscan_psd_pyramid_new(void);
+
+SUBOOL suscan_psd_pyramid_feed(
+    suscan_psd_pyramid_t *self,
+    const SUFLOAT *psd,
+    SUSCOUNT size);
+
+const SUFLOAT *suscan_psd_pyramid_get_level(
+    suscan_psd_pyramid_t *self,
+    enum suscan_analyzer_psd_aggregation aggregation,
+    SUSCOUNT *size);
+
+struct suscan_analyzer_psd_msg *suscan_psd_pyramid_render(
+    suscan_psd_pyramid_t *self,
+    const struct suscan_psd_view *view,
+    const struct suscan_analyzer_psd_msg *native);
+
+void suscan_psd_pyramid_destroy(suscan_psd_pyramid_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _PSDPYRAMID_H */
@@ -0,0 +1,118 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#define SU_LOG_DOMAIN "psdsched"
+
+#include <sigutils/sigutils.h>
+#include "psdsched.h"
+
+/*
+ * Computes the schedule for the requested smooth PSD parameters. As the
+ * smooth PSD only sees the delivered samples, its refresh rate must be
+ * adjusted so that it produces one PSD per burst.
+ */
+void
+suscan_psd_sched_set_params(
+    suscan_psd_sched_t *self,
+    const struct sigutils_smoothpsd_params *params,
+    SUSCOUNT averaging,
+    struct sigutils_smoothpsd_params *effective)
+{
+  SUSCOUNT period = 0, burst;
+
+  *effective = *params;
+
+  if (params->refresh_rate > 0 && params->samp_rate > 0)
+    period = SU_FLOOR(params->samp_rate / params->refresh_rate);
+
+  burst = averaging * params->fft_size;
+
+  if (burst == 0 || burst >= period) {
+    /* Every FFT is needed */
+    self->period = 0;
+    self->burst  = 0;
+  } else {
+    self->period = period;
+    self->burst  = burst;
+    effective->refresh_rate = (SUFLOAT) params->samp_rate / burst;
+  }
+
+  self->pos   = 0;
+  self->extra = 0;
+  self->debt  = 0;
+}
+
+/*
+ * Walks a buffer of size samples from *cursor and returns the next range
+ * to deliver. It must be called until it returns SU_FALSE, as a buffer
+ * may hold the tail of a burst and the head of the next one, or several
+ * bursts if it spans several periods.
+ */
+SUBOOL
+suscan_psd_sched_plan(
+    suscan_psd_sched_t *self,
+    SUSCOUNT size,
+    SUSCOUNT *cursor,
+    SUSCOUNT *offset,
+    SUSCOUNT *length)
+{
+  SUSCOUNT left, len;
+
+  if (*cursor >= size)
+    return SU_FALSE;
+
+  left = size - *cursor;
+
+  if (self->period == 0) {
+    *offset = *cursor;
+    *length = left;
+    *cursor = size;
+    self->processed += left;
+    return SU_TRUE;
+  }
+
+  while (left > 0) {
+    if (self->pos < self->burst + self->extra) {
+      len = SU_MIN(left, self->burst + self->extra - self->pos);
+
+      *offset = *cursor;
+      *length = len;
+      *cursor += len;
+      self->pos += len;
+      self->processed += len;
+      return SU_TRUE;
+    }
+
+    /* Skip to the beginning of the next period */
+    len = SU_MIN(left, self->period - self->pos);
+
+    *cursor += len;
+    left -= len;
+    self->pos += len;
+    self->skipped += len;
+
+    if (self->pos == self->period) {
+      self->pos    = 0;
+      self->extra  = SU_MIN(self->debt, self->period - self->burst);
+      self->debt  -= self->extra;
+    }
+  }
+
+  return SU_FALSE;
+}
@@ -0,0 +1,91 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _PSDSCHED_H
+#define _PSDSCHED_H
+
+#include <sigutils/sigutils.h>
+#include <sigutils/smoothpsd.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * The PSD scheduler decides which samples of the stream are worth an FFT.
+ * Of every refresh period, only the first `averaging' FFT windows are
+ * delivered to the smooth PSD, and the rest is skipped before it even
+ * leaves the channelizer. Samples that should have been delivered but
+ * could not (e.g. no free buffers) are accounted as dropped.
+ *
+ * The smooth PSD counts samples, not time: a dropped range would leave
+ * it out of step with the bursts for good. Dropped samples are therefore
+ * owed to the next burst, which is extended (up to the whole period) so
+ * that every PSD update still ends with a burst.
+ */
+struct suscan_psd_sched {
+  SUSCOUNT period;     /* Samples per PSD update. 0: deliver everything */
+  SUSCOUNT burst;      /* Samples delivered per update */
+  SUSCOUNT pos;        /* Position in the current period */
+  SUSCOUNT extra;      /* Added to the current burst */
+  SUSCOUNT debt;       /* To be added to the next burst */
+
+  SUSCOUNT processed;
+  SUSCOUNT skipped;
+  SUSCOUNT dropped;
+};
+
+typedef struct suscan_psd_sched suscan_psd_sched_t;
+
+#define suscan_psd_sched_INITIALIZER { 0, 0, 0, 0, 0, 0, 0, 0 }
+
+SUINLINE void
+suscan_psd_sched_drop(suscan_psd_sched_t *self, SUSCOUNT length)
+{
+  self->processed -= length;
+  self->dropped   += length;
+
+  if (self->period > 0)
+    self->debt += length;
+}
+
+SUINLINE void
+suscan_psd_sched_reset_stats(suscan_psd_sched_t *self)
+{
+  self->processed = self->skipped = self->dropped = 0;
+}
+
+void suscan_psd_sched_set_params(
+    suscan_psd_sched_t *self,
+    const struct sigutils_smoothpsd_params *params,
+    SUSCOUNT averaging,
+    struct sigutils_smoothpsd_params *effective);
+
+SUBOOL suscan_psd_sched_plan(
+    suscan_psd_sched_t *self,
+    SUSCOUNT size,
+    SUSCOUNT *cursor,
+    SUSCOUNT *offset,
+    SUSCOUNT *length);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _PSDSCHED_H */
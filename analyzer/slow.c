@@ -504,6 +504,7 @@ suscan_local_analyzer_set_psd_params_cb(
     void *cb_private)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
+  struct sigutils_smoothpsd_params sp_params;
 
   if (self->psd_params_req) {
     self->psd_params_req = SU_FALSE;
@@ -511,9 +512,19 @@ suscan_local_analyzer_set_psd_params_cb(
     /* This alters detector params */
     self->parent->params.detector_params.window_size = self->sp_params.fft_size;
     self->parent->params.detector_params.window = self->sp_params.window;
+    self->parent->params.psd_averaging = self->psd_averaging;
     self->interval_psd = 1. / self->sp_params.refresh_rate;
 
-    (void) su_smoothpsd_set_params(self->smooth_psd, &self->sp_params);
+    /* The channelizer consults the schedule on every read */
+    SU_TRYCATCH(suscan_local_analyzer_lock_loop(self), return SU_FALSE);
+    suscan_psd_sched_set_params(
+        &self->psd_sched,
+        &self->sp_params,
+        self->psd_averaging,
+        &sp_params);
+    suscan_local_analyzer_unlock_loop(self);
+
+    (void) su_smoothpsd_set_params(self->smooth_psd, &sp_params);
     SU_TRYCATCH(suscan_local_analyzer_notify_params(self), return SU_FALSE);
   }
 
@@ -621,6 +632,8 @@ suscan_local_analyzer_set_analyzer_params_overridable(
     suscan_local_analyzer_t *self,
     const struct suscan_analyzer_params *params)
 {
+  struct suscan_spectstats_params stats_params;
+
   SU_TRYCATCH(
       self->parent->params.mode == SUSCAN_ANALYZER_MODE_CHANNEL,
       return SU_FALSE);
@@ -628,6 +641,41 @@ suscan_local_analyzer_set_analyzer_params_overridable(
   self->sp_params.fft_size     = params->detector_params.window_size;
   self->sp_params.window       = params->detector_params.window;
   self->sp_params.refresh_rate = 1. / params->psd_update_int;
+  self->psd_averaging          = params->psd_averaging;
+
+  /* Picked up by the correction service at its next update */
+  if (params->corr_update_rate > 0) {
+    SU_TRYCATCH(
+        suscan_inspector_factory_set_correction_rate(
+          self->insp_factory,
+          params->corr_update_rate),
+        return SU_FALSE);
+    self->parent->params.corr_update_rate = params->corr_update_rate;
+  }
+
+  /*
+   * Statistics are applied by the PSD worker, and restarted when they
+   * do. Parameter updates that leave them untouched (e.g. a client
+   * changing its FFT size) must not discard them.
+   */
+  stats_params.interval   = params->stats_interval;
+  stats_params.threshold  = params->stats_threshold;
+  stats_params.percentile = params->stats_percentile;
+
+  SU_TRYCATCH(
+      pthread_mutex_lock(&self->hotconf_mutex) != -1,
+      return SU_FALSE);
+  if (self->stats_params_req.interval != stats_params.interval
+    || self->stats_params_req.threshold != stats_params.threshold
+    || self->stats_params_req.percentile != stats_params.percentile) {
+    self->stats_params_req     = stats_params;
+    self->stats_params_pending = SU_TRUE;
+  }
+  pthread_mutex_unlock(&self->hotconf_mutex);
+
+  self->parent->params.stats_interval   = params->stats_interval;
+  self->parent->params.stats_threshold  = params->stats_threshold;
+  self->parent->params.stats_percentile = params->stats_percentile;
 
   self->psd_params_req = SU_TRUE;
 
@@ -408,7 +408,8 @@ suscan_source_read(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
     return 0;
 
   /* With non-real time sources, use throttle to control CPU usage */
-  if (!suscan_source_is_real_time(self) || replay) {
+  if (!(suscan_source_is_real_time(self) || self->throttle_disabled)
+      || replay) {
     SU_TRYZ(pthread_mutex_lock(&self->throttle_mutex));
     max = suscan_throttle_get_portion(&self->throttle, max);
     SU_TRYZ(pthread_mutex_unlock(&self->throttle_mutex));
@@ -431,7 +432,8 @@ suscan_source_read(suscan_source_t *self, SUCOMPLEX *buffer, SUSCOUNT max)
   if (result > 0)
     self->total_samples += result;
 
-  if (!suscan_source_is_real_time(self) || replay) {
+  if (!(suscan_source_is_real_time(self) || self->throttle_disabled)
+      || replay) {
     SU_TRYZ(pthread_mutex_lock(&self->throttle_mutex));
     suscan_throttle_advance(&self->throttle, result);
     SU_TRYZ(pthread_mutex_unlock(&self->throttle_mutex));
@@ -602,6 +604,23 @@ done:
 }
 
 
+/*
+ * Recordings may be made of several segments, each one captured at a
+ * different frequency. Sources that know nothing about this return
+ * SU_FALSE.
+ */
+SUBOOL
+suscan_source_get_segments(
+    const suscan_source_t *self,
+    const struct suscan_source_segment **list,
+    unsigned int *count)
+{
+  if (self->iface->get_segments == NULL)
+    return SU_FALSE;
+
+  return (self->iface->get_segments) (self->src_priv, list, count);
+}
+
 SUSDIFF
 suscan_source_get_max_size(const suscan_source_t *self)
 {
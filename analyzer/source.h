@@ -61,6 +61,16 @@ struct sigutils_specttuner_channel;
 
 /************** Source interface: to be implemented by all sources ************/
 struct suscan_source;
+
+/*
+ * Part of a recording captured at a fixed center frequency (e.g. a SigMF
+ * capture segment). Positions are given in samples of the recording.
+ */
+struct suscan_source_segment {
+  SUSCOUNT start;
+  SUSCOUNT length;
+  SUFREQ   freq;
+};
 struct suscan_source_interface {
   const char *name;
   const char *analyzer;
@@ -88,6 +98,10 @@ struct suscan_source_interface {
   
   void     (*get_time) (void *, struct timeval *tv);
   SUBOOL   (*seek) (void *,  SUSCOUNT samples);
+  SUBOOL   (*get_segments) (
+    void *,
+    const struct suscan_source_segment **list,
+    unsigned int *count);
 
   SUBOOL   (*set_frequency) (void *, SUFREQ freq);
   SUBOOL   (*set_gain) (void *, const char *name, SUFLOAT value);
@@ -109,6 +123,7 @@ struct suscan_source {
   suscan_throttle_t throttle; /* For non-realtime sources */
   SUBOOL throttle_mutex_init;
   pthread_mutex_t throttle_mutex;
+  SUBOOL throttle_disabled;   /* Read as fast as possible (offline sweeps) */
   
   /* Source state */
   SUBOOL   capturing;
@@ -185,6 +200,10 @@ void   suscan_source_get_time(suscan_source_t *self, struct timeval *tv);
 SUBOOL suscan_source_seek(suscan_source_t *self, SUSCOUNT);
 
 SUBOOL suscan_source_override_throttle(suscan_source_t *self, SUSCOUNT val);
+SUBOOL suscan_source_get_segments(
+    const suscan_source_t *self,
+    const struct suscan_source_segment **list,
+    unsigned int *count);
 SUFREQ suscan_source_get_freq(const suscan_source_t *source);
 SUBOOL suscan_source_set_freq(suscan_source_t *source, SUFREQ freq);
 SUBOOL suscan_source_set_lnb_freq(suscan_source_t *source, SUFREQ freq);
@@ -256,6 +275,12 @@ suscan_source_is_real_time(const suscan_source_t *self)
     return suscan_source_config_is_real_time(self->config);
 }
 
+SUINLINE void
+suscan_source_set_throttle_disabled(suscan_source_t *self, SUBOOL disabled)
+{
+  self->throttle_disabled = disabled;
+}
+
 SUINLINE SUBOOL
 suscan_source_is_seekable(const suscan_source_t *self)
 {
@@ -271,6 +271,9 @@ suscan_source_file_close(void *ptr)
 
   if (self->sf != NULL)
     sf_close(self->sf);
+
+  if (self->segment_list != NULL)
+    free(self->segment_list);
   
   free(self);
 }
@@ -290,6 +293,43 @@ suscan_source_config_file_check(const suscan_source_config_t *config)
 }
 
 
+/*
+ * SigMF recordings may consist of several capture segments, each one at
+ * a different frequency. Keep them around for offline sweeps.
+ */
+SUPRIVATE void
+suscan_source_file_load_segments(struct suscan_source_file *self)
+{
+#ifdef HAVE_JSONC
+  struct suscan_sigmf_metadata metadata;
+  SUSCOUNT frames = self->sf_info.frames;
+  struct suscan_source_segment *segment;
+  unsigned int i;
+
+  if (self->config->format != SUSCAN_SOURCE_FORMAT_AUTO
+    && self->config->format != SUSCAN_SOURCE_FORMAT_SIGMF)
+    return;
+
+  if (!suscan_sigmf_extract_metadata(&metadata, self->config->path))
+    return;
+
+  for (i = 0; i < metadata.segment_count; ++i) {
+    segment = metadata.segment_list + i;
+
+    if (segment->start >= frames)
+      segment->length = 0;
+    else if (segment->length == 0 || segment->start + segment->length > frames)
+      segment->length = frames - segment->start;
+  }
+
+  self->segment_list    = metadata.segment_list;
+  self->segment_count   = metadata.segment_count;
+  metadata.segment_list = NULL;
+
+  suscan_sigmf_metadata_finalize(&metadata);
+#endif /* HAVE_JSONC */
+}
+
 SUPRIVATE void *
 suscan_source_file_open(
   suscan_source_t *source,
@@ -311,6 +351,8 @@ suscan_source_file_open(
 
   new->iq_file   = new->sf_info.channels == 2;
 
+  suscan_source_file_load_segments(new);
+
   /* Initialize source info */
   suscan_source_info_init(info);
   info->permissions         = SUSCAN_ANALYZER_ALL_FILE_PERMISSIONS;
@@ -426,6 +468,23 @@ suscan_source_file_seek(void *userdata, SUSCOUNT pos)
   return SU_TRUE;
 }
 
+SUPRIVATE SUBOOL
+suscan_source_file_get_segments(
+  void *userdata,
+  const struct suscan_source_segment **list,
+  unsigned int *count)
+{
+  struct suscan_source_file *self = (struct suscan_source_file *) userdata;
+
+  if (self->segment_count == 0)
+    return SU_FALSE;
+
+  *list  = self->segment_list;
+  *count = self->segment_count;
+
+  return SU_TRUE;
+}
+
 SUPRIVATE SUSDIFF
 suscan_source_file_max_size(void *userdata)
 {
@@ -688,6 +747,7 @@ SUPRIVATE struct suscan_source_interface g_file_source =
   .cancel          = suscan_source_file_cancel,
   .read            = suscan_source_file_read,
   .seek            = suscan_source_file_seek,
+  .get_segments    = suscan_source_file_get_segments,
   .max_size        = suscan_source_file_max_size,
   .get_time        = suscan_source_file_get_time,
   .guess_metadata  = suscan_source_file_guess_metadata,
@@ -28,6 +28,7 @@
 
 struct suscan_source_config;
 struct suscan_source;
+struct suscan_source_segment;
 
 /* SigMF metadata that is relevant for Suscan */
 /* TODO: What if we created a unified metadata structure that can be
@@ -41,6 +42,10 @@ struct suscan_sigmf_metadata {
   SUFREQ         frequency;
   struct timeval start_time;
   uint32_t       guessed;
+
+  /* One per capture segment. Last one extends up to the end of the file */
+  struct suscan_source_segment *segment_list;
+  unsigned int   segment_count;
 };
 
 struct suscan_source_file {
@@ -54,6 +59,9 @@ struct suscan_source_file {
   SUFLOAT  samp_rate;
   SUSCOUNT total_samples;
   SUSCOUNT seek_request;
+
+  struct suscan_source_segment *segment_list;
+  unsigned int segment_count;
 };
 
 SUBOOL suscan_sigmf_extract_metadata(
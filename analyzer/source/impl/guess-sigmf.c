@@ -147,6 +147,73 @@ done:
   return ok;
 }
 
+/*
+ * Every capture segment becomes a source segment. Segments extend up to
+ * the start of the next one, the last one up to the end of the file.
+ */
+SU_METHOD(
+  sigmf_parser_context,
+  SUBOOL,
+  extract_segments,
+  struct suscan_sigmf_metadata *metadata)
+{
+  json_object *capture      = NULL;
+  json_object *sample_start = NULL;
+  json_object *frequency    = NULL;
+  struct suscan_source_segment *segment, *prev = NULL;
+  unsigned int i, count;
+
+  SUBOOL ok = SU_FALSE;
+
+  count = json_object_array_length(self->captures);
+  SU_ALLOCATE_MANY(metadata->segment_list, count, struct suscan_source_segment);
+
+  for (i = 0; i < count; ++i) {
+    capture = json_object_array_get_idx(self->captures, i);
+    if (!json_object_is_type(capture, json_type_object)) {
+      SU_ERROR("Type of capture entry %d is not object\n", i);
+      goto done;
+    }
+
+    segment = metadata->segment_list + i;
+    segment->freq = metadata->frequency;
+
+    if (json_object_object_get_ex(capture, "core:sample_start", &sample_start)) {
+      if (!json_object_is_type(sample_start, json_type_int)) {
+        SU_ERROR("SigMF capture %d: sample start is not an integer\n", i);
+        goto done;
+      }
+
+      segment->start = json_object_get_int64(sample_start);
+    } else if (i > 0) {
+      SU_ERROR("SigMF capture %d: undefined sample start\n", i);
+      goto done;
+    }
+
+    if (json_object_object_get_ex(capture, "core:frequency", &frequency)
+      && (json_object_is_type(frequency, json_type_int)
+        || json_object_is_type(frequency, json_type_double)))
+      segment->freq = json_object_get_double(frequency);
+
+    if (prev != NULL) {
+      if (segment->start < prev->start) {
+        SU_ERROR("SigMF captures are not sorted by sample start\n");
+        goto done;
+      }
+
+      prev->length = segment->start - prev->start;
+    }
+
+    prev = segment;
+    metadata->segment_count = i + 1;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 SU_INSTANCER(sigmf_parser_context, const char *path)
 {
   sigmf_parser_context_t *new = NULL;
@@ -194,6 +261,9 @@ suscan_sigmf_metadata_finalize(struct suscan_sigmf_metadata *self)
 
   if (self->path_meta != NULL)
     free(self->path_meta);
+
+  if (self->segment_list != NULL)
+    free(self->segment_list);
 }
 
 SUBOOL
@@ -226,6 +296,15 @@ suscan_sigmf_extract_metadata(
     goto done;
   }
 
+  /* Segments are only needed for offline sweeps, do not fail on them */
+  if (!sigmf_parser_context_extract_segments(ctx, self)) {
+    SU_WARNING("Failed to parse SigMF capture segments, ignoring\n");
+    if (self->segment_list != NULL)
+      free(self->segment_list);
+    self->segment_list  = NULL;
+    self->segment_count = 0;
+  }
+
   ok = SU_TRUE;
 
 done:
@@ -78,6 +78,31 @@ done:
   return ok;
 }
 
+/*
+ * With long refresh intervals, most of the samples fed to the PSD
+ * estimator are averaged into a spectrum that is mostly discarded. In that
+ * case, we feed it one FFT window per refresh interval (the last one) and
+ * ask it to refresh after every window.
+ */
+SUPRIVATE void
+suscan_spectsrc_update_schedule(
+    suscan_spectsrc_t *self,
+    struct sigutils_smoothpsd_params *params)
+{
+  SUFLOAT interval = params->samp_rate / self->refresh_rate;
+
+  if (interval >= SUSCAN_SPECTSRC_LAZY_MIN_RATIO * params->fft_size) {
+    self->lazy_interval  = interval;
+    params->refresh_rate = params->samp_rate / params->fft_size;
+  } else {
+    self->lazy_interval  = 0;
+    params->refresh_rate = self->refresh_rate;
+  }
+
+  self->lazy_countdown = self->lazy_interval;
+  self->lazy_left      = 0;
+}
+
 void
 suscan_spectsrc_set_throttle_factor(
   suscan_spectsrc_t *self,
@@ -87,6 +112,7 @@ suscan_spectsrc_set_throttle_factor(
     self->throttle_factor = throttle_factor;
     self->smooth_psd_params.samp_rate = 
       su_smoothpsd_get_nominal_samp_rate(self->smooth_psd) * self->throttle_factor;
+    suscan_spectsrc_update_schedule(self, &self->smooth_psd_params);
     (void) su_smoothpsd_set_params(self->smooth_psd, &self->smooth_psd_params);
   }
 }
@@ -121,9 +147,10 @@ suscan_spectsrc_new(
 
   params.fft_size = size;
   params.samp_rate = samp_rate;
-  params.refresh_rate = new->refresh_rate / new->throttle_factor;
   params.window = window_type;
 
+  suscan_spectsrc_update_schedule(new, &params);
+
   new->smooth_psd_params = params;
   
   SU_TRYCATCH(
@@ -153,6 +180,25 @@ suscan_spectsrc_feed(
     const SUCOMPLEX *data,
     SUSCOUNT size)
 {
+  SUSCOUNT skip;
+
+  if (self->lazy_interval > 0) {
+    if (self->lazy_left == 0) {
+      if (self->lazy_countdown > 0) {
+        skip = SU_MIN(self->lazy_countdown, size);
+        self->lazy_countdown -= skip;
+        return skip;
+      }
+
+      /* Time for the last window before the next refresh */
+      self->lazy_left      = self->smooth_psd_params.fft_size;
+      self->lazy_countdown = self->lazy_interval - self->lazy_left;
+    }
+
+    if (size > self->lazy_left)
+      size = self->lazy_left;
+  }
+
   if (self->classptr->preproc != NULL) {
     /* Spectrum source has a preprocessing routine. Apply data to it */
     if (size > self->buffer_size)
@@ -176,6 +222,9 @@ suscan_spectsrc_feed(
         return -1);
   }
 
+  if (self->lazy_interval > 0)
+    self->lazy_left -= size;
+
   return size;
 }
 
@@ -28,6 +28,12 @@
 extern "C" {
 #endif /* __cplusplus */
 
+/*
+ * When the refresh interval spans this many FFT windows or more, only the
+ * last window before each refresh is fed to the PSD estimator.
+ */
+#define SUSCAN_SPECTSRC_LAZY_MIN_RATIO 4
+
 struct suscan_spectsrc;
 
 struct suscan_spectsrc_class {
@@ -63,6 +69,11 @@ struct suscan_spectsrc {
   struct sigutils_smoothpsd_params smooth_psd_params;
   su_smoothpsd_t *smooth_psd;
 
+  /* Demand-driven feeding */
+  SUSCOUNT        lazy_interval;  /* Samples per refresh, 0 if disabled */
+  SUSCOUNT        lazy_countdown; /* Samples to skip before next window */
+  SUSCOUNT        lazy_left;      /* Samples left in the current window */
+
   SUBOOL (*on_spectrum) (void *userdata, const SUFLOAT *data, SUSCOUNT size);
   void *userdata;
 };
@@ -22,13 +22,14 @@
 #define SU_LOG_DOMAIN "cyclo-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
 
 #define SU_CYCLO_GAIN 1e6
 
 void *
 suscan_spectsrc_cyclo_ctor(suscan_spectsrc_t *src)
 {
-  return calloc(1, sizeof(SUCOMPLEX));
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -38,18 +39,12 @@ suscan_spectsrc_cyclo_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] * SU_C_CONJ(prev);
-    prev = buffer[i];
-    buffer[i] = SU_CYCLO_GAIN * diff;
-  }
-
-  *last = prev;
+  suscan_spectsrc_preproc_delay(ctx, buffer, size);
+  suscan_spectsrc_preproc_mul_conj(buffer, buffer, ctx->delayed, size);
+  suscan_spectsrc_preproc_scale(buffer, SU_CYCLO_GAIN, size);
 
   return SU_TRUE;
 }
@@ -57,7 +52,7 @@ suscan_spectsrc_cyclo_preproc(
 void
 suscan_spectsrc_cyclo_dtor(void *private)
 {
-  free(private);
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
@@ -22,11 +22,12 @@
 #define SU_LOG_DOMAIN "exp_8-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
 
 void *
 suscan_spectsrc_exp_8_ctor(suscan_spectsrc_t *src)
 {
-  return src;
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -36,10 +37,10 @@ suscan_spectsrc_exp_8_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUSCOUNT i;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  for (i = 0; i < size; ++i)
-    buffer[i] = cpow(buffer[i] / (SU_C_ABS(buffer[i]) + 1e-8), 8) / size;
+  suscan_spectsrc_preproc_exp(ctx, buffer, 3, 1. / size, size);
 
   return SU_TRUE;
 }
@@ -47,7 +48,7 @@ suscan_spectsrc_exp_8_preproc(
 void
 suscan_spectsrc_exp_8_dtor(void *private)
 {
-  /* No-op */
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
@@ -22,18 +22,14 @@
 #define SU_LOG_DOMAIN "fmcyclo-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
 
 #define FMCYCLO_GAIN 1e-5
 
-struct fmcyclo_ctx {
-  SUCOMPLEX fm_prev;
-  SUFLOAT   pd_prev;
-};
-
 void *
 suscan_spectsrc_fmcyclo_ctor(suscan_spectsrc_t *src)
 {
-  return calloc(1, sizeof(struct fmcyclo_ctx));
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -43,21 +39,24 @@ suscan_spectsrc_fmcyclo_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  struct fmcyclo_ctx *ctx = (struct fmcyclo_ctx *) private;
-  SUCOMPLEX fm_prev = ctx->fm_prev;
-  SUFLOAT   pd_prev = ctx->pd_prev;
-  SUFLOAT   phase_diff;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
+  const SUFLOAT *phase_diff = ctx->real;
   SUSCOUNT i;
 
-  for (i = 0; i < size; ++i) {
-    phase_diff = SU_C_ARG(buffer[i] * SU_C_CONJ(fm_prev));
-    fm_prev = buffer[i];
-    buffer[i] = FMCYCLO_GAIN * SU_ABS(phase_diff - pd_prev);
-    pd_prev = phase_diff;
-  }
+  if (size == 0)
+    return SU_TRUE;
+
+  suscan_spectsrc_preproc_delay(ctx, buffer, size);
+  suscan_spectsrc_preproc_mul_conj(buffer, buffer, ctx->delayed, size);
+  suscan_spectsrc_preproc_arg(ctx->real, buffer, size);
+
+  buffer[0] = FMCYCLO_GAIN * SU_ABS(phase_diff[0] - ctx->last_arg);
+
+  for (i = 1; i < size; ++i)
+    buffer[i] = FMCYCLO_GAIN * SU_ABS(phase_diff[i] - phase_diff[i - 1]);
 
-  ctx->fm_prev = fm_prev;
-  ctx->pd_prev = pd_prev;
+  ctx->last_arg = phase_diff[size - 1];
 
   return SU_TRUE;
 }
@@ -65,7 +64,7 @@ suscan_spectsrc_fmcyclo_preproc(
 void
 suscan_spectsrc_fmcyclo_dtor(void *private)
 {
-  free(private);
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
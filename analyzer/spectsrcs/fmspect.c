@@ -22,13 +22,14 @@
 #define SU_LOG_DOMAIN "fmspect-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
 
 #define FMSPECT_GAIN 1e-5
 
 void *
 suscan_spectsrc_fmspect_ctor(suscan_spectsrc_t *src)
 {
-  return calloc(1, sizeof(SUCOMPLEX));
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -38,18 +39,13 @@ suscan_spectsrc_fmspect_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  for (i = 0; i < size; ++i) {
-    diff = SU_C_ARG(buffer[i] * SU_C_CONJ(prev));
-    prev = buffer[i];
-    buffer[i] = FMSPECT_GAIN * diff;
-  }
-
-  *last = prev;
+  suscan_spectsrc_preproc_delay(ctx, buffer, size);
+  suscan_spectsrc_preproc_mul_conj(buffer, buffer, ctx->delayed, size);
+  suscan_spectsrc_preproc_arg(ctx->real, buffer, size);
+  suscan_spectsrc_preproc_real(buffer, ctx->real, FMSPECT_GAIN, size);
 
   return SU_TRUE;
 }
@@ -57,7 +53,7 @@ suscan_spectsrc_fmspect_preproc(
 void
 suscan_spectsrc_fmspect_dtor(void *private)
 {
-  free(private);
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
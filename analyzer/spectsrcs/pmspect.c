@@ -22,13 +22,14 @@
 #define SU_LOG_DOMAIN "pmspect-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
+
 #define PM_DEMOD_GAIN 1e-5
 
 void *
 suscan_spectsrc_pmspect_ctor(suscan_spectsrc_t *src)
 {
-  /* Unused! */
-  return calloc(1, sizeof(SUCOMPLEX));
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -38,10 +39,11 @@ suscan_spectsrc_pmspect_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUSCOUNT i;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  for (i = 0; i < size; ++i)
-    buffer[i] = PM_DEMOD_GAIN * SU_C_ARG(buffer[i]);
+  suscan_spectsrc_preproc_arg(ctx->real, buffer, size);
+  suscan_spectsrc_preproc_real(buffer, ctx->real, PM_DEMOD_GAIN, size);
 
   return SU_TRUE;
 }
@@ -49,7 +51,7 @@ suscan_spectsrc_pmspect_preproc(
 void
 suscan_spectsrc_pmspect_dtor(void *private)
 {
-  free(private);
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
@@ -0,0 +1,211 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <string.h>
+
+#define SU_LOG_DOMAIN "spectsrc-preproc"
+
+#include "preproc.h"
+
+#ifdef HAVE_VOLK
+#  include <volk/volk.h>
+#endif /* HAVE_VOLK */
+
+/* Keeps the phase of zero samples well-defined in exp_N */
+#define SUSCAN_SPECTSRC_PREPROC_EXP_EPSILON 1e-8
+
+struct suscan_spectsrc_preproc_ctx *
+suscan_spectsrc_preproc_ctx_new(SUSCOUNT size)
+{
+  struct suscan_spectsrc_preproc_ctx *new = NULL;
+
+  SU_ALLOCATE_FAIL(new, struct suscan_spectsrc_preproc_ctx);
+
+  new->size = size;
+
+  if (size > 0) {
+    SU_ALLOCATE_MANY_FAIL(new->delayed, size, SUCOMPLEX);
+    SU_ALLOCATE_MANY_FAIL(new->real, size, SUFLOAT);
+  }
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_spectsrc_preproc_ctx_destroy(new);
+
+  return NULL;
+}
+
+void
+suscan_spectsrc_preproc_ctx_destroy(struct suscan_spectsrc_preproc_ctx *self)
+{
+  if (self->delayed != NULL)
+    free(self->delayed);
+
+  if (self->real != NULL)
+    free(self->real);
+
+  free(self);
+}
+
+void
+suscan_spectsrc_preproc_delay(
+    struct suscan_spectsrc_preproc_ctx *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT size)
+{
+  if (size == 0)
+    return;
+
+  self->delayed[0] = self->last;
+  memcpy(self->delayed + 1, x, (size - 1) * sizeof(SUCOMPLEX));
+  self->last = x[size - 1];
+}
+
+#ifdef HAVE_VOLK
+void
+suscan_spectsrc_preproc_mul_conj(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *a,
+    const SUCOMPLEX *b,
+    SUSCOUNT size)
+{
+  volk_32fc_x2_multiply_conjugate_32fc(y, a, b, size);
+}
+
+void
+suscan_spectsrc_preproc_arg(SUFLOAT *y, const SUCOMPLEX *x, SUSCOUNT size)
+{
+  volk_32fc_s32f_atan2_32f(y, x, 1., size);
+}
+
+void
+suscan_spectsrc_preproc_scale(SUCOMPLEX *x, SUFLOAT gain, SUSCOUNT size)
+{
+  lv_32fc_t scalar = lv_cmake(gain, 0);
+
+  volk_32fc_s32fc_multiply_32fc(x, x, scalar, size);
+}
+#else
+void
+suscan_spectsrc_preproc_mul_conj(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *a,
+    const SUCOMPLEX *b,
+    SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    y[i] = a[i] * SU_C_CONJ(b[i]);
+}
+
+void
+suscan_spectsrc_preproc_arg(SUFLOAT *y, const SUCOMPLEX *x, SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    y[i] = SU_C_ARG(x[i]);
+}
+
+void
+suscan_spectsrc_preproc_scale(SUCOMPLEX *x, SUFLOAT gain, SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    x[i] *= gain;
+}
+#endif /* HAVE_VOLK */
+
+void
+suscan_spectsrc_preproc_sub(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *a,
+    const SUCOMPLEX *b,
+    SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    y[i] = a[i] - b[i];
+}
+
+void
+suscan_spectsrc_preproc_mag2(SUCOMPLEX *y, const SUCOMPLEX *x, SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    y[i] = SU_C_REAL(x[i]) * SU_C_REAL(x[i])
+      + SU_C_IMAG(x[i]) * SU_C_IMAG(x[i]);
+}
+
+void
+suscan_spectsrc_preproc_real(
+    SUCOMPLEX *y,
+    const SUFLOAT *x,
+    SUFLOAT gain,
+    SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    y[i] = gain * x[i];
+}
+
+/*
+ * Raising to a power of two is done by repeated squaring, instead of
+ * going through cpow (and therefore through complex logarithms).
+ */
+void
+suscan_spectsrc_preproc_exp(
+    struct suscan_spectsrc_preproc_ctx *self,
+    SUCOMPLEX *x,
+    unsigned int order,
+    SUFLOAT gain,
+    SUSCOUNT size)
+{
+  SUFLOAT *mag = self->real;
+  unsigned int j;
+  SUSCOUNT i;
+
+#ifdef HAVE_VOLK
+  volk_32fc_magnitude_32f(mag, x, size);
+#else
+  for (i = 0; i < size; ++i)
+    mag[i] = SU_C_ABS(x[i]);
+#endif /* HAVE_VOLK */
+
+  for (i = 0; i < size; ++i)
+    x[i] /= mag[i] + SUSCAN_SPECTSRC_PREPROC_EXP_EPSILON;
+
+  for (j = 0; j < order; ++j) {
+#ifdef HAVE_VOLK
+    volk_32fc_x2_multiply_32fc(x, x, x, size);
+#else
+    for (i = 0; i < size; ++i)
+      x[i] *= x[i];
+#endif /* HAVE_VOLK */
+  }
+
+  suscan_spectsrc_preproc_scale(x, gain, size);
+}
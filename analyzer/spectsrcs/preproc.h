@@ -0,0 +1,108 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SPECTSRCS_PREPROC_H
+#define _SPECTSRCS_PREPROC_H
+
+#include <sigutils/sigutils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*
+ * Vector kernels for spectrum source preprocessors. When suscan is built
+ * against VOLK, they map to VOLK kernels, which pick the best
+ * implementation for the running CPU. Otherwise, they are plain loops with
+ * no dependencies between iterations, which compilers vectorize.
+ *
+ * Kernels working on delayed samples never read what they write. Sources
+ * keep a copy of the input delayed by one sample in their own scratch
+ * buffer instead (see suscan_spectsrc_preproc_delay).
+ */
+
+struct suscan_spectsrc_preproc_ctx {
+  SUSCOUNT   size;
+  SUCOMPLEX  last;     /* Last sample of the previous buffer */
+  SUFLOAT    last_arg; /* Last phase computed by the source, if any */
+  SUCOMPLEX *delayed;  /* Input delayed by one sample */
+  SUFLOAT   *real;     /* Real-valued scratch */
+};
+
+struct suscan_spectsrc_preproc_ctx *suscan_spectsrc_preproc_ctx_new(
+    SUSCOUNT size);
+
+void suscan_spectsrc_preproc_ctx_destroy(
+    struct suscan_spectsrc_preproc_ctx *self);
+
+/* ctx->delayed[n] = x[n - 1], using the last sample of the previous call */
+void suscan_spectsrc_preproc_delay(
+    struct suscan_spectsrc_preproc_ctx *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT size);
+
+/* y[n] = a[n] * conj(b[n]) */
+void suscan_spectsrc_preproc_mul_conj(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *a,
+    const SUCOMPLEX *b,
+    SUSCOUNT size);
+
+/* y[n] = a[n] - b[n] */
+void suscan_spectsrc_preproc_sub(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *a,
+    const SUCOMPLEX *b,
+    SUSCOUNT size);
+
+/* y[n] = arg(x[n]) */
+void suscan_spectsrc_preproc_arg(
+    SUFLOAT *y,
+    const SUCOMPLEX *x,
+    SUSCOUNT size);
+
+/* y[n] = |x[n]|^2, as a complex number */
+void suscan_spectsrc_preproc_mag2(
+    SUCOMPLEX *y,
+    const SUCOMPLEX *x,
+    SUSCOUNT size);
+
+/* x[n] *= gain */
+void suscan_spectsrc_preproc_scale(SUCOMPLEX *x, SUFLOAT gain, SUSCOUNT size);
+
+/* y[n] = gain * x[n] */
+void suscan_spectsrc_preproc_real(
+    SUCOMPLEX *y,
+    const SUFLOAT *x,
+    SUFLOAT gain,
+    SUSCOUNT size);
+
+/* x[n] = gain * (x[n] / |x[n]|) ^ (2 ^ order) */
+void suscan_spectsrc_preproc_exp(
+    struct suscan_spectsrc_preproc_ctx *self,
+    SUCOMPLEX *x,
+    unsigned int order,
+    SUFLOAT gain,
+    SUSCOUNT size);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _SPECTSRCS_PREPROC_H */
@@ -22,11 +22,12 @@
 #define SU_LOG_DOMAIN "timediff-spectsrc"
 
 #include "spectsrc.h"
+#include "preproc.h"
 
 void *
 suscan_spectsrc_timediff_ctor(suscan_spectsrc_t *src)
 {
-  return calloc(1, sizeof(SUCOMPLEX));
+  return suscan_spectsrc_preproc_ctx_new(src->buffer_size);
 }
 
 SUBOOL
@@ -36,18 +37,11 @@ suscan_spectsrc_timediff_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff;
-  }
-
-  *last = prev;
+  suscan_spectsrc_preproc_delay(ctx, buffer, size);
+  suscan_spectsrc_preproc_sub(buffer, buffer, ctx->delayed, size);
 
   return SU_TRUE;
 }
@@ -59,18 +53,12 @@ suscan_spectsrc_abstimediff_preproc(
     SUCOMPLEX *buffer,
     SUSCOUNT size)
 {
-  SUCOMPLEX *last = (SUCOMPLEX *) private;
-  SUCOMPLEX prev = *last;
-  SUCOMPLEX diff;
-  SUSCOUNT i;
-
-  for (i = 0; i < size; ++i) {
-    diff = buffer[i] - prev;
-    prev = buffer[i];
-    buffer[i] = diff * SU_C_CONJ(diff);
-  }
+  struct suscan_spectsrc_preproc_ctx *ctx =
+    (struct suscan_spectsrc_preproc_ctx *) private;
 
-  *last = prev;
+  suscan_spectsrc_preproc_delay(ctx, buffer, size);
+  suscan_spectsrc_preproc_sub(buffer, buffer, ctx->delayed, size);
+  suscan_spectsrc_preproc_mag2(buffer, buffer, size);
 
   return SU_TRUE;
 }
@@ -78,7 +66,7 @@ suscan_spectsrc_abstimediff_preproc(
 void
 suscan_spectsrc_timediff_dtor(void *private)
 {
-  free(private);
+  suscan_spectsrc_preproc_ctx_destroy(private);
 }
 
 SUBOOL
@@ -0,0 +1,257 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define SU_LOG_DOMAIN "spectstats"
+
+#include <sigutils/sigutils.h>
+#include "spectstats.h"
+#include "msg.h"
+
+/*
+ * Markers work in dB, and empty bins (e.g. zero-padded or gated PSDs)
+ * would yield -inf, which the parabolic update turns into NaN. Powers
+ * are clamped to this floor (-200 dB) before conversion.
+ */
+#define SUSCAN_SPECTSTATS_MIN_POWER 1e-20
+
+suscan_spectstats_t *
+suscan_spectstats_new(
+    const struct suscan_spectstats_params *params,
+    SUFREQ fc,
+    SUFLOAT samp_rate,
+    SUSCOUNT size)
+{
+  suscan_spectstats_t *new = NULL;
+
+  SU_TRYCATCH(size > 0, goto fail);
+  SU_TRYCATCH(
+      params->percentile >= 0 && params->percentile <= 1,
+      goto fail);
+
+  SU_ALLOCATE_FAIL(new, suscan_spectstats_t);
+
+  new->params    = *params;
+  new->fc        = fc;
+  new->samp_rate = samp_rate;
+  new->size      = size;
+  new->threshold = SU_POWER_MAG_RAW(params->threshold);
+
+  SU_ALLOCATE_MANY_FAIL(new->max,  size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->min,  size, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->sum,  size, SUDOUBLE);
+  SU_ALLOCATE_MANY_FAIL(new->busy, size, uint32_t);
+  SU_ALLOCATE_MANY_FAIL(new->q,    size * SUSCAN_SPECTSTATS_MARKERS, SUFLOAT);
+  SU_ALLOCATE_MANY_FAIL(new->n,    size * SUSCAN_SPECTSTATS_MARKERS, uint32_t);
+
+  return new;
+
+fail:
+  if (new != NULL)
+    suscan_spectstats_destroy(new);
+
+  return NULL;
+}
+
+SUBOOL
+suscan_spectstats_matches(
+    const suscan_spectstats_t *self,
+    SUFREQ fc,
+    SUFLOAT samp_rate,
+    SUSCOUNT size)
+{
+  return self->fc == fc
+    && self->samp_rate == samp_rate
+    && self->size == size;
+}
+
+/*
+ * P-square update of the markers of a bin, with count observations so
+ * far. The first five observations are just kept sorted.
+ */
+SUPRIVATE void
+suscan_spectstats_p2_feed(
+    SUFLOAT *q,
+    uint32_t *n,
+    SUSCOUNT count,
+    SUFLOAT p,
+    SUFLOAT x)
+{
+  const SUFLOAT f[SUSCAN_SPECTSTATS_MARKERS] = {
+    0, .5 * p, p, .5 * (1 + p), 1
+  };
+  SUFLOAT d, qp;
+  int64_t dl, dr, s;
+  int i, k;
+
+  if (count < SUSCAN_SPECTSTATS_MARKERS) {
+    for (i = count; i > 0 && q[i - 1] > x; --i)
+      q[i] = q[i - 1];
+    q[i] = x;
+    n[count] = count;
+    return;
+  }
+
+  /* Find the cell of x, extending the extreme markers if needed */
+  if (x < q[0]) {
+    q[0] = x;
+    k = 0;
+  } else if (x >= q[4]) {
+    q[4] = x;
+    k = 3;
+  } else {
+    for (k = 0; x >= q[k + 1]; ++k);
+  }
+
+  for (i = k + 1; i < SUSCAN_SPECTSTATS_MARKERS; ++i)
+    ++n[i];
+
+  /* Move the central markers towards their desired positions */
+  for (i = 1; i < SUSCAN_SPECTSTATS_MARKERS - 1; ++i) {
+    d  = f[i] * count - n[i];
+    dl = (int64_t) n[i] - n[i - 1];
+    dr = (int64_t) n[i + 1] - n[i];
+
+    if ((d >= 1 && dr > 1) || (d <= -1 && dl > 1)) {
+      s = d > 0 ? 1 : -1;
+
+      qp = q[i] + (SUFLOAT) s / (dl + dr) * (
+        (dl + s) * (q[i + 1] - q[i]) / dr
+        + (dr - s) * (q[i] - q[i - 1]) / dl);
+
+      if (q[i - 1] < qp && qp < q[i + 1])
+        q[i] = qp;
+      else
+        q[i] += s * (q[i + s] - q[i]) / (SUFLOAT) (s > 0 ? dr : -dl);
+
+      n[i] += s;
+    }
+  }
+}
+
+SUPRIVATE SUFLOAT
+suscan_spectstats_p2_get(const SUFLOAT *q, SUSCOUNT count, SUFLOAT p)
+{
+  if (count >= SUSCAN_SPECTSTATS_MARKERS)
+    return q[2];
+
+  /* Still sorting the first observations */
+  return q[(SUSCOUNT) SU_FLOOR(p * (count - 1) + .5)];
+}
+
+void
+suscan_spectstats_feed(
+    suscan_spectstats_t *self,
+    const SUFLOAT *psd,
+    const struct timeval *timestamp)
+{
+  SUSCOUNT i;
+  SUFLOAT x;
+
+  if (self->frames == 0) {
+    self->start = *timestamp;
+    for (i = 0; i < self->size; ++i)
+      self->max[i] = self->min[i] = psd[i];
+  }
+
+  for (i = 0; i < self->size; ++i) {
+    x = psd[i];
+
+    if (x > self->max[i])
+      self->max[i] = x;
+    if (x < self->min[i])
+      self->min[i] = x;
+
+    self->sum[i] += x;
+
+    if (x > self->threshold)
+      ++self->busy[i];
+
+    suscan_spectstats_p2_feed(
+        self->q + i * SUSCAN_SPECTSTATS_MARKERS,
+        self->n + i * SUSCAN_SPECTSTATS_MARKERS,
+        self->frames,
+        self->params.percentile,
+        SU_POWER_DB(SU_MAX(x, SUSCAN_SPECTSTATS_MIN_POWER)));
+  }
+
+  self->last = *timestamp;
+  ++self->frames;
+}
+
+/* Reports are cumulative: the statistics are never reset by a report */
+SUBOOL
+suscan_spectstats_report(
+    const suscan_spectstats_t *self,
+    struct suscan_analyzer_spectral_stats_msg *msg)
+{
+  SUSCOUNT i;
+
+  SU_TRYCATCH(self->frames > 0, return SU_FALSE);
+  SU_TRYCATCH(msg->size == self->size, return SU_FALSE);
+
+  msg->fc         = self->fc;
+  msg->samp_rate  = self->samp_rate;
+  msg->start      = self->start;
+  msg->timestamp  = self->last;
+  msg->frames     = self->frames;
+  msg->threshold  = self->params.threshold;
+  msg->percentile = self->params.percentile;
+
+  memcpy(msg->max, self->max, self->size * sizeof(SUFLOAT));
+  memcpy(msg->min, self->min, self->size * sizeof(SUFLOAT));
+
+  for (i = 0; i < self->size; ++i) {
+    msg->mean[i] = self->sum[i] / self->frames;
+    msg->duty[i] = (SUFLOAT) self->busy[i] / self->frames;
+    msg->pct[i]  = SU_POWER_MAG_RAW(
+        suscan_spectstats_p2_get(
+          self->q + i * SUSCAN_SPECTSTATS_MARKERS,
+          self->frames,
+          self->params.percentile));
+  }
+
+  return SU_TRUE;
+}
+
+void
+suscan_spectstats_destroy(suscan_spectstats_t *self)
+{
+  if (self->n != NULL)
+    free(self->n);
+
+  if (self->q != NULL)
+    free(self->q);
+
+  if (self->busy != NULL)
+    free(self->busy);
+
+  if (self->sum != NULL)
+    free(self->sum);
+
+  if (self->min != NULL)
+    free(self->min);
+
+  if (self->max != NULL)
+    free(self->max);
+
+  free(self);
+}
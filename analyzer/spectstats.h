@@ -0,0 +1,100 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SPECTSTATS_H
+#define _SPECTSTATS_H
+
+#include <sigutils/sigutils.h>
+#include <sys/time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+#define SUSCAN_SPECTSTATS_MARKERS 5 /* P-square estimator */
+
+struct suscan_analyzer_spectral_stats_msg;
+
+struct suscan_spectstats_params {
+  SUFLOAT interval;   /* Seconds between reports. 0: disabled */
+  SUFLOAT threshold;  /* Occupancy threshold (dB) */
+  SUFLOAT percentile; /* Tracked quantile, between 0 and 1 */
+};
+
+/*
+ * Long-term statistics of the main spectrum, per bin. Percentiles are
+ * estimated with the P-square algorithm (Jain & Chlamtac, 1985), which
+ * needs five markers per bin instead of the whole history. Markers work
+ * in dB, as the parabolic interpolation behaves better there.
+ */
+struct suscan_spectstats {
+  struct suscan_spectstats_params params;
+  SUFREQ   fc;
+  SUFLOAT  samp_rate;
+  SUSCOUNT size;
+  SUFLOAT  threshold;   /* Linear */
+
+  SUSCOUNT frames;
+  struct timeval start; /* Of the first PSD */
+  struct timeval last;  /* Of the last PSD */
+
+  SUFLOAT  *max;
+  SUFLOAT  *min;
+  SUDOUBLE *sum;
+  uint32_t *busy;       /* Frames above threshold */
+  SUFLOAT  *q;          /* Marker heights (dB) */
+  uint32_t *n;          /* Marker positions */
+};
+
+typedef struct suscan_spectstats suscan_spectstats_t;
+
+SUINLINE SUSCOUNT
+suscan_spectstats_get_frames(const suscan_spectstats_t *self)
+{
+  return self->frames;
+}
+
+suscan_spectstats_t *suscan_spectstats_new(
+    const struct suscan_spectstats_params *params,
+    SUFREQ fc,
+    SUFLOAT samp_rate,
+    SUSCOUNT size);
+
+SUBOOL suscan_spectstats_matches(
+    const suscan_spectstats_t *self,
+    SUFREQ fc,
+    SUFLOAT samp_rate,
+    SUSCOUNT size);
+
+void suscan_spectstats_feed(
+    suscan_spectstats_t *self,
+    const SUFLOAT *psd,
+    const struct timeval *timestamp);
+
+SUBOOL suscan_spectstats_report(
+    const suscan_spectstats_t *self,
+    struct suscan_analyzer_spectral_stats_msg *msg);
+
+void suscan_spectstats_destroy(suscan_spectstats_t *self);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* _SPECTSTATS_H */
@@ -106,6 +106,127 @@ suscan_local_analyzer_feed_baseband_filters(
   return SU_TRUE;
 }
 
+/*
+ * Asynchronous filters share one copy of the samples, taken from a pool of
+ * their own. Every filter holds at most max_lag references, so a pool of
+ * the sum of their lags plus the buffer being filled never runs dry, and
+ * it is fully allocated upfront so that acquiring never allocates. The
+ * pool is replaced (and retired until filters return its buffers) when it
+ * becomes too small, either for a read or for the registered filters.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_assert_async_bbfilt_pool(
+    suscan_local_analyzer_t *self,
+    SUSCOUNT length)
+{
+  struct suscan_sample_buffer_pool_params params =
+    suscan_sample_buffer_pool_params_INITIALIZER;
+  suscan_sample_buffer_pool_t *pool = self->async_bbfilt_pool;
+  suscan_sample_buffer_t **bufs = NULL;
+  unsigned int i;
+  SUBOOL ok = SU_FALSE;
+
+  params.max_buffers = self->async_bbfilt_lag + 1;
+  params.alloc_size  = SU_MAX(length, self->bufpool->params.alloc_size);
+  params.name        = "async-bbfilt";
+
+  if (pool != NULL
+    && pool->params.alloc_size >= length
+    && pool->params.max_buffers >= params.max_buffers)
+    return SU_TRUE;
+
+  SU_MAKE(pool, suscan_sample_buffer_pool, &params);
+  SU_ALLOCATE_MANY(bufs, params.max_buffers, suscan_sample_buffer_t *);
+
+  for (i = 0; i < params.max_buffers; ++i)
+    SU_TRY(bufs[i] = suscan_sample_buffer_pool_try_acquire(pool));
+
+  for (i = 0; i < params.max_buffers; ++i) {
+    SU_TRY(suscan_sample_buffer_pool_give(pool, bufs[i]));
+    bufs[i] = NULL;
+  }
+
+  if (self->async_bbfilt_pool != NULL) {
+    suscan_local_analyzer_destroy_retired_pools(self, SU_FALSE);
+    SU_TRYC(PTR_LIST_APPEND_CHECK(self->retired_pool, self->async_bbfilt_pool));
+  }
+
+  self->async_bbfilt_pool = pool;
+  pool = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (bufs != NULL) {
+    for (i = 0; i < params.max_buffers; ++i)
+      if (bufs[i] != NULL)
+        (void) suscan_sample_buffer_pool_give(pool, bufs[i]);
+
+    free(bufs);
+  }
+
+  if (pool != NULL)
+    suscan_sample_buffer_pool_destroy(pool);
+
+  return ok;
+}
+
+/*
+ * Asynchronous filters never block the channelizer: they get a reference
+ * to the shared copy of the samples, if their queues have room for it.
+ * Otherwise, the buffer is dropped for them. Buffers of the channelizer
+ * pool are never held by a filter, so no matter how slow filters are,
+ * acquisition cannot run out of them.
+ */
+SUPRIVATE void
+suscan_local_analyzer_feed_async_baseband_filters(
+    suscan_local_analyzer_t *self,
+    suscan_sample_buffer_t *buffer,
+    SUSCOUNT length)
+{
+  struct suscan_local_analyzer_async_bbfilt *bbfilt;
+  suscan_sample_buffer_t *copy = NULL;
+  SUSCOUNT consumed;
+  unsigned int i;
+
+  if (self->async_bbfilt_count == 0)
+    return;
+
+  consumed = suscan_source_get_consumed_samples(self->source) - length;
+
+  if (suscan_local_analyzer_assert_async_bbfilt_pool(self, length))
+    copy = suscan_sample_buffer_pool_try_acquire(self->async_bbfilt_pool);
+
+  if (copy != NULL)
+    memcpy(
+      suscan_sample_buffer_data(copy),
+      suscan_sample_buffer_data(buffer),
+      length * sizeof(SUCOMPLEX));
+
+  for (i = 0; i < self->async_bbfilt_count; ++i) {
+    bbfilt = self->async_bbfilt_list[i];
+    if (bbfilt == NULL)
+      continue;
+
+    if (copy == NULL) {
+      suscan_local_analyzer_async_bbfilt_drop(bbfilt, length);
+      continue;
+    }
+
+    suscan_sample_buffer_inc_ref(copy);
+    if (!suscan_local_analyzer_async_bbfilt_push(
+      bbfilt,
+      copy,
+      length,
+      consumed))
+      (void) suscan_sample_buffer_pool_give(self->async_bbfilt_pool, copy);
+  }
+
+  if (copy != NULL)
+    if (!suscan_sample_buffer_pool_give(self->async_bbfilt_pool, copy))
+      SU_ERROR("Failed to give buffer!\n");
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_feed_inspectors(
     suscan_local_analyzer_t *self,
@@ -218,6 +339,336 @@ suscan_local_analyzer_on_new_freq(
     new_f0 * channel->decimation);
 }
 
+/************************* Adaptive tuner window *****************************/
+SUPRIVATE SUSCOUNT
+suscan_local_analyzer_default_tuner_window(SUFLOAT samp_rate)
+{
+  if (samp_rate >= 10000000)
+    return 131072;
+  else if (samp_rate >= 5000000)
+    return 65536;
+  else if (samp_rate >= 1600000)
+    return 16384;
+  else if (samp_rate >= 250000)
+    return 4096;
+  
+  return 2048;
+}
+
+/*
+ * The SUSCAN_TUNER_WINDOW environment variable fixes the window size,
+ * disabling auto-tuning. This is intended for deterministic setups.
+ */
+SUSCOUNT
+suscan_local_analyzer_initial_tuner_window(suscan_local_analyzer_t *self)
+{
+  const char *env;
+  unsigned long window;
+  char *end = NULL;
+
+  self->stuner_auto = SU_TRUE;
+
+  if ((env = getenv(SUSCAN_LOCAL_ANALYZER_TUNER_WINDOW_ENV)) != NULL
+    && strcmp(env, "auto") != 0) {
+    window = strtoul(env, &end, 0);
+
+    if (*end != '\0'
+      || window < SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW
+      || window > SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW
+      || (window & (window - 1)) != 0) {
+      SU_WARNING(
+        "Invalid %s value `%s' (must be a power of 2 between %d and %d)\n",
+        SUSCAN_LOCAL_ANALYZER_TUNER_WINDOW_ENV,
+        env,
+        SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW,
+        SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW);
+    } else {
+      self->stuner_auto = SU_FALSE;
+      return window;
+    }
+  }
+
+  return suscan_local_analyzer_default_tuner_window(
+    self->source_info.effective_samp_rate);
+}
+
+/*
+ * Window size for a set of channels, given the normalized bandwidth of the
+ * narrowest one. We start from the sample rate default, and make sure the
+ * narrowest channel (and therefore every channel) spans enough bins.
+ * If the CPU is idle, we shrink windows that resolve wide channels with
+ * more bins than needed (lower latency). If the CPU is busy, we prefer
+ * fewer, bigger FFTs, as they amortize the per-window synchronization
+ * of the inspector scheduler.
+ */
+SUPRIVATE SUSCOUNT
+suscan_local_analyzer_plan_tuner_window(
+  const suscan_local_analyzer_t *self,
+  SUFLOAT bw)
+{
+  SUSCOUNT base, floor, target;
+
+  base   = suscan_local_analyzer_default_tuner_window(
+    self->source_info.effective_samp_rate);
+  target = base;
+  floor  = SU_MAX(base >> 2, SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW);
+
+  if (bw > 0) {
+    while (target < SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW
+      && target * bw < SUSCAN_LOCAL_ANALYZER_TUNER_MIN_CHAN_BINS)
+      target <<= 1;
+
+    if (self->cpu_usage <= SUSCAN_LOCAL_ANALYZER_TUNER_CPU_LOW)
+      while (target > floor
+        && (target >> 1) * bw >= SUSCAN_LOCAL_ANALYZER_TUNER_MAX_CHAN_BINS)
+        target >>= 1;
+  }
+
+  if (self->cpu_usage >= SUSCAN_LOCAL_ANALYZER_TUNER_CPU_HIGH)
+    target <<= 1;
+
+  if (target > SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW)
+    target = SUSCAN_LOCAL_ANALYZER_TUNER_MAX_WINDOW;
+  else if (target < SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW)
+    target = SUSCAN_LOCAL_ANALYZER_TUNER_MIN_WINDOW;
+
+  return target;
+}
+
+void
+suscan_local_analyzer_destroy_retired_pools(
+  suscan_local_analyzer_t *self,
+  SUBOOL force)
+{
+  unsigned int i;
+  suscan_sample_buffer_pool_t *pool;
+
+  for (i = 0; i < self->retired_pool_count; ++i) {
+    pool = self->retired_pool_list[i];
+    if (pool != NULL 
+      && (force || suscan_sample_buffer_pool_released(pool))) {
+      suscan_sample_buffer_pool_destroy(pool);
+      self->retired_pool_list[i] = NULL;
+    }
+  }
+
+  if (force) {
+    if (self->retired_pool_list != NULL)
+      free(self->retired_pool_list);
+
+    self->retired_pool_list  = NULL;
+    self->retired_pool_count = 0;
+  }
+}
+
+/*
+ * Replaces the spectral tuner by one with a different window. Must be
+ * called from the analyzer thread (which opens and binds inspectors) with
+ * both the loop and the tuner mutexes held, and the pipeline drained.
+ *
+ * Open channels are reopened in the new tuner with their current
+ * parameters, and their inspectors are pointed to them. This is only
+ * possible if the decimation of every channel (and hence the sample rate
+ * seen by its inspector) is preserved.
+ *
+ * In circular mode, the buffer size must match the window, so the buffer
+ * pool is replaced too. The old pool is kept until the PSD worker and
+ * baseband filters return their buffers.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_replan_tuner_unsafe(
+  suscan_local_analyzer_t *self,
+  SUSCOUNT window)
+{
+  struct sigutils_specttuner_params st_params =
+      sigutils_specttuner_params_INITIALIZER;
+  struct suscan_sample_buffer_pool_params bp_params;
+  suscan_sample_buffer_pool_t *new_pool = NULL;
+  struct sigutils_specttuner_channel_params ch_params;
+  su_specttuner_t *new_tuner = NULL, *old_tuner;
+  su_specttuner_channel_t **new_chans = NULL;
+  su_specttuner_channel_t *chan;
+  su_specttuner_plan_t *plan;
+  suscan_inspector_t *insp;
+  unsigned int i, chan_count = self->stuner->channel_count;
+  SUBOOL ok = SU_FALSE;
+
+  suscan_local_analyzer_destroy_retired_pools(self, SU_FALSE);
+
+  st_params.window_size     = window;
+  st_params.early_windowing = !self->circularity;
+
+  /* FFTW plans for this size are taken from the wisdom file, if any */
+  SU_MAKE(new_tuner, su_specttuner, &st_params);
+
+  /* Reopen all channels. Nothing is touched until all of them succeed. */
+  if (chan_count > 0)
+    SU_ALLOCATE_MANY(new_chans, chan_count, su_specttuner_channel_t *);
+
+  for (i = 0; i < chan_count; ++i) {
+    if ((chan = self->stuner->channel_list[i]) == NULL)
+      continue;
+
+    ch_params = chan->params;
+    SU_TRY(new_chans[i] = su_specttuner_open_channel(new_tuner, &ch_params));
+
+    if (new_chans[i]->decimation != chan->decimation)
+      goto done;
+  }
+
+  if (self->circularity) {
+    SU_TRY(suscan_vm_circbuf_allowed(window));
+
+    bp_params            = self->bufpool->params;
+    bp_params.alloc_size = window;
+
+    SU_MAKE(new_pool, suscan_sample_buffer_pool, &bp_params);
+    SU_TRYC(PTR_LIST_APPEND_CHECK(self->retired_pool, self->bufpool));
+
+    /* Pipeline buffers hold plans of the old tuner too */
+    for (i = 0; i < SUSCAN_LOCAL_ANALYZER_PIPELINE_BUFFERS; ++i) {
+      if (self->pipe_buf[i] != NULL) {
+        plan = suscan_sample_buffer_userdata(self->pipe_buf[i]);
+        if (plan != NULL)
+          su_specttuner_destroy_plan(self->stuner, plan);
+        suscan_sample_buffer_set_userdata(self->pipe_buf[i], NULL);
+
+        if (!suscan_sample_buffer_pool_give(self->bufpool, self->pipe_buf[i]))
+          SU_ERROR("Failed to give buffer!\n");
+        self->pipe_buf[i] = NULL;
+      }
+    }
+
+    self->pipe_last_size = 0;
+    self->pipe_ndx       = 0;
+    self->circ_state     = SU_FALSE;
+
+    if (self->circbuf != NULL) {
+      plan = suscan_sample_buffer_userdata(self->circbuf);
+      if (plan != NULL)
+        su_specttuner_destroy_plan(self->stuner, plan);
+      suscan_sample_buffer_set_userdata(self->circbuf, NULL);
+
+      if (!suscan_sample_buffer_pool_give(self->bufpool, self->circbuf))
+        SU_ERROR("Failed to give buffer!\n");
+      self->circbuf = NULL;
+    }
+
+    self->bufpool = new_pool;
+    new_pool = NULL;
+  }
+
+  /* Inspectors follow their channels to the new tuner */
+  for (i = 0; i < chan_count; ++i) {
+    if ((chan = self->stuner->channel_list[i]) == NULL)
+      continue;
+
+    insp = (suscan_inspector_t *) chan->params.privdata;
+    if (insp != NULL && insp->factory_userdata == chan) {
+      suscan_inspector_lock(insp);
+      insp->factory_userdata   = new_chans[i];
+      insp->samp_info.fft_size = new_chans[i]->size;
+      insp->samp_info.fft_bins = new_chans[i]->width;
+      insp->samp_info.early_windowing = st_params.early_windowing;
+      suscan_inspector_unlock(insp);
+    }
+  }
+
+  old_tuner    = self->stuner;
+  self->stuner = new_tuner;
+  new_tuner    = old_tuner;
+
+  ok = SU_TRUE;
+
+done:
+  /* Destroying the tuner closes its channels */
+  if (new_tuner != NULL)
+    su_specttuner_destroy(new_tuner);
+
+  if (new_chans != NULL)
+    free(new_chans);
+
+  if (new_pool != NULL)
+    suscan_sample_buffer_pool_destroy(new_pool);
+
+  return ok;
+}
+
+/*
+ * Re-plans the tuner window for all open channels, plus the one about to be
+ * opened (if any). Called from the analyzer thread before opening a
+ * channel, and after closing one.
+ */
+void
+suscan_local_analyzer_adapt_tuner_window(
+  suscan_local_analyzer_t *self,
+  const struct sigutils_channel *chan_info)
+{
+  SUBOOL loop_acquired = SU_FALSE;
+  SUBOOL stuner_acquired = SU_FALSE;
+  su_specttuner_channel_t *chan;
+  suscan_inspector_t *insp;
+  SUSCOUNT current, window;
+  SUFLOAT bw, min_bw = 0;
+  unsigned int i;
+
+  if (!self->stuner_auto)
+    goto done;
+
+  SU_TRY(suscan_local_analyzer_lock_loop(self));
+  loop_acquired = SU_TRUE;
+
+  /* No window may be in flight while the tuner is replaced */
+  SU_TRY(suscan_local_analyzer_drain_pipeline(self));
+
+  SU_TRYZ(pthread_mutex_lock(&self->stuner_mutex));
+  stuner_acquired = SU_TRUE;
+
+  if (chan_info != NULL)
+    min_bw = SU_ABS2NORM_FREQ(
+      suscan_analyzer_get_samp_rate(self->parent),
+      chan_info->f_hi - chan_info->f_lo);
+
+  for (i = 0; i < self->stuner->channel_count; ++i) {
+    if ((chan = self->stuner->channel_list[i]) == NULL)
+      continue;
+
+    /* These consume FFT bins directly: their window must not change */
+    insp = (suscan_inspector_t *) chan->params.privdata;
+    if (insp != NULL && suscan_inspector_is_freq_domain(insp))
+      goto done;
+
+    bw = SU_ANG2NORM_FREQ(su_specttuner_channel_get_bw(chan));
+    if (min_bw <= 0 || bw < min_bw)
+      min_bw = bw;
+  }
+
+  /* Idle tuner: the next channel to be opened will decide */
+  if (min_bw <= 0)
+    goto done;
+
+  current = self->stuner->params.window_size;
+  window  = suscan_local_analyzer_plan_tuner_window(self, min_bw);
+
+  if (window != current) {
+    if (suscan_local_analyzer_replan_tuner_unsafe(self, window))
+      SU_INFO(
+        "Spectral tuner window adapted: %lld -> %lld (CPU: %g%%)\n",
+        current,
+        window,
+        self->cpu_usage * 100);
+    else
+      SU_WARNING("Cannot adapt spectral tuner window, keeping current\n");
+  }
+
+done:
+  if (stuner_acquired)
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  if (loop_acquired)
+    suscan_local_analyzer_unlock_loop(self);
+}
+
 /*********************** Channel opening and closing *************************/
 SUPRIVATE su_specttuner_channel_t *
 suscan_local_analyzer_open_channel_ex(
@@ -330,6 +781,8 @@ suscan_local_inspector_factory_open(
   channel   = va_arg(ap, const struct sigutils_channel *);
   precise   = va_arg(ap, SUBOOL);
 
+  suscan_local_analyzer_adapt_tuner_window(self, channel);
+
   schan = suscan_local_analyzer_open_channel_ex(
     self,
     channel,
@@ -393,6 +846,17 @@ suscan_local_inspector_factory_close(
 
   if (!suscan_local_analyzer_close_channel(self, chan))
     SU_WARNING("Failed to close channel!\n");
+
+  /*
+   * This may be called from the channelizer itself. Re-planning is
+   * deferred to the analyzer thread.
+   */
+  if (self->stuner_auto
+    && !suscan_mq_write(
+      &self->mq_in,
+      SUSCAN_LOCAL_ANALYZER_MESSAGE_TYPE_REPLAN,
+      NULL))
+    SU_WARNING("Failed to request a spectral tuner re-plan\n");
 }
 
 SUPRIVATE void
@@ -583,6 +1047,103 @@ suscan_local_analyzer_parse_overridable(suscan_local_analyzer_t *self)
   return SU_TRUE;
 }
 
+/*
+ * Accumulates the PSD into the spectral statistics. These are restarted
+ * whenever their parameters change or the PSD stops being comparable
+ * (retuning, new sample rate or FFT size). Reports are emitted every
+ * stats interval of source time.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_spectstats(
+    suscan_local_analyzer_t *self,
+    const SUFLOAT *psd,
+    unsigned int size)
+{
+  const struct suscan_source_info *info;
+  struct timeval now, elapsed;
+  SUBOOL restart = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_lock(&self->hotconf_mutex));
+  if (self->stats_params_pending) {
+    self->stats_params         = self->stats_params_req;
+    self->stats_params_pending = SU_FALSE;
+    restart = SU_TRUE;
+  }
+  pthread_mutex_unlock(&self->hotconf_mutex);
+
+  info = suscan_analyzer_get_source_info(self->parent);
+
+  if (self->spectstats != NULL) {
+    if (restart
+      || !suscan_spectstats_matches(
+        self->spectstats,
+        info->frequency,
+        info->source_samp_rate,
+        size)) {
+      suscan_spectstats_destroy(self->spectstats);
+      self->spectstats = NULL;
+    }
+  }
+
+  if (self->stats_params.interval <= 0)
+    return SU_TRUE;
+
+  suscan_analyzer_get_source_time(self->parent, &now);
+
+  if (self->spectstats == NULL) {
+    SU_TRY(
+      self->spectstats = suscan_spectstats_new(
+        &self->stats_params,
+        info->frequency,
+        info->source_samp_rate,
+        size));
+    self->stats_last = now;
+  }
+
+  suscan_spectstats_feed(self->spectstats, psd, &now);
+
+  timersub(&now, &self->stats_last, &elapsed);
+  if (elapsed.tv_sec + 1e-6 * elapsed.tv_usec >= self->stats_params.interval) {
+    SU_TRY(
+      suscan_analyzer_send_spectral_stats(self->parent, self->spectstats));
+    self->stats_last = now;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+/* Called by the source worker, once per rate measurement interval */
+SUPRIVATE void
+suscan_local_analyzer_publish_psd_stats(suscan_local_analyzer_t *self)
+{
+  (void) pthread_mutex_lock(&self->psd_stats_mutex);
+  self->psd_stats.processed = self->psd_sched.processed;
+  self->psd_stats.skipped   = self->psd_sched.skipped;
+  self->psd_stats.dropped   = self->psd_sched.dropped;
+  (void) pthread_mutex_unlock(&self->psd_stats_mutex);
+
+  suscan_psd_sched_reset_stats(&self->psd_sched);
+}
+
+/* Stage timings are updated by the source and channelizer workers */
+SUPRIVATE void
+suscan_local_analyzer_get_channelizer_timings(
+    suscan_local_analyzer_t *self,
+    struct suscan_analyzer_channelizer_timings *timings)
+{
+  memset(timings, 0, sizeof(struct suscan_analyzer_channelizer_timings));
+
+  if (self->pipelined && self->pipe_mutex_init) {
+    (void) pthread_mutex_lock(&self->pipe_mutex);
+    *timings = self->timings;
+    (void) pthread_mutex_unlock(&self->pipe_mutex);
+  }
+}
+
 SUPRIVATE SUBOOL
 suscan_local_analyzer_on_psd(
     void *userdata,
@@ -590,13 +1151,27 @@ suscan_local_analyzer_on_psd(
     unsigned int size)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) userdata;
+  struct suscan_analyzer_channelizer_timings timings;
+  struct suscan_analyzer_psd_sched_stats psd_stats;
+
+  suscan_local_analyzer_get_channelizer_timings(self, &timings);
+
+  (void) pthread_mutex_lock(&self->psd_stats_mutex);
+  psd_stats = self->psd_stats;
+  (void) pthread_mutex_unlock(&self->psd_stats_mutex);
 
   SU_TRYCATCH(
       suscan_analyzer_send_psd_from_smoothpsd(
         self->parent, 
         self->smooth_psd,
         suscan_source_has_looped(self->source),
-        suscan_source_get_current_history_size(self->source)),
+        suscan_source_get_current_history_size(self->source),
+        &timings,
+        &psd_stats),
+      return SU_FALSE);
+
+  SU_TRYCATCH(
+      suscan_local_analyzer_feed_spectstats(self, psd, size),
       return SU_FALSE);
 
   return SU_TRUE;
@@ -616,6 +1191,13 @@ suscan_local_analyzer_init_channel_worker(suscan_local_analyzer_t *self)
 
   self->sp_params = sp_params;
 
+  /* The smooth PSD only sees the samples scheduled for it */
+  suscan_psd_sched_set_params(
+    &self->psd_sched,
+    &self->sp_params,
+    self->psd_averaging,
+    &sp_params);
+
   SU_MAKE(
     self->smooth_psd,
     su_smoothpsd,
@@ -629,6 +1211,13 @@ done:
   return ok;
 }
 
+/* Part of a sample buffer scheduled for the PSD */
+struct suscan_psd_job {
+  suscan_sample_buffer_t *buffer;
+  SUSCOUNT offset;
+  SUSCOUNT length;
+};
+
 SUBOOL
 suscan_psd_worker_cb(
   struct suscan_mq *mq_out,
@@ -636,22 +1225,123 @@ suscan_psd_worker_cb(
     void *cb_private)
 {
   suscan_local_analyzer_t *self  = (suscan_local_analyzer_t *) wk_private;
-  suscan_sample_buffer_t *buffer = (suscan_sample_buffer_t *)  cb_private;
-  SUCOMPLEX *samples = suscan_sample_buffer_data(buffer);
-  SUSCOUNT size = suscan_sample_buffer_size(buffer);
+  struct suscan_psd_job *job     = (struct suscan_psd_job *) cb_private;
+  SUCOMPLEX *samples = suscan_sample_buffer_data(job->buffer);
 
-  if (self->circularity)
-    size >>= 1;
-  
-  SU_TRY(su_smoothpsd_feed(self->smooth_psd, samples, size));
+  SU_TRY(
+    su_smoothpsd_feed(
+      self->smooth_psd,
+      samples + job->offset,
+      job->length));
 
 done:
-  if (!suscan_sample_buffer_pool_give(self->bufpool, buffer))
+  /* The pool may have been replaced by a tuner re-plan */
+  if (!suscan_sample_buffer_pool_give(
+    suscan_sample_buffer_parent(job->buffer),
+    job->buffer))
     SU_ERROR("Failed to give buffer!\n");
 
+  free(job);
+
   return SU_FALSE;
 }
 
+/* Takes ownership of the buffer, even on failure */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_push_psd_job(
+  suscan_local_analyzer_t *self,
+  suscan_sample_buffer_t *buffer,
+  SUSCOUNT offset,
+  SUSCOUNT length)
+{
+  struct suscan_psd_job *job = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  SU_ALLOCATE(job, struct suscan_psd_job);
+
+  job->buffer = buffer;
+  job->offset = offset;
+  job->length = length;
+
+  SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, job));
+  job = NULL;
+
+  ok = SU_TRUE;
+
+done:
+  if (job != NULL) {
+    free(job);
+    ok = SU_FALSE;
+  }
+
+  if (!ok) {
+    suscan_psd_sched_drop(&self->psd_sched, length);
+    if (!suscan_sample_buffer_pool_give(
+      suscan_sample_buffer_parent(buffer),
+      buffer))
+      SU_ERROR("Failed to give buffer!\n");
+  }
+
+  return ok;
+}
+
+/*
+ * Delivers the parts of the last read needed by the PSD. Buffers are
+ * only duplicated (or referenced) if the schedule actually needs them.
+ * Every job holds its own reference; the one taken here just keeps the
+ * buffer alive until all jobs are pushed.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_schedule_psd(
+  suscan_local_analyzer_t *self,
+  suscan_sample_buffer_t *buffer,
+  SUSCOUNT got)
+{
+  suscan_sample_buffer_t *dup = NULL;
+  SUSCOUNT cursor = 0, offset, length;
+  SUBOOL ok = SU_FALSE;
+
+  while (suscan_psd_sched_plan(
+    &self->psd_sched,
+    got,
+    &cursor,
+    &offset,
+    &length)) {
+    if (dup == NULL) {
+      if (suscan_sample_buffer_is_circular(buffer)) {
+        /* CIRCULARITY: Buffer is being reused and must be duplicated */
+        dup = suscan_sample_buffer_pool_try_dup(self->bufpool, buffer);
+      } else if (suscan_sample_buffer_pool_free_num(self->bufpool) > 0) {
+        /* 
+         * NO CIRCULARITY: Increment reference and deliver. We only do this
+         * if we are sure that the next allocation is not going to sleep.
+         */
+        suscan_sample_buffer_inc_ref(buffer);
+        dup = buffer;
+      }
+
+      if (dup == NULL) {
+        suscan_psd_sched_drop(&self->psd_sched, length);
+        continue;
+      }
+    }
+
+    suscan_sample_buffer_inc_ref(dup);
+    SU_TRY(suscan_local_analyzer_push_psd_job(self, dup, offset, length));
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (dup != NULL
+    && !suscan_sample_buffer_pool_give(
+      suscan_sample_buffer_parent(dup),
+      dup))
+    SU_ERROR("Failed to give buffer!\n");
+
+  return ok;
+}
+
 
 /* 
  * If we rely on circularity, we alternate between the EVEN and ODD states:
@@ -808,18 +1498,10 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
     suscan_analyzer_do_iq_rev(samples, got);
 
   SU_TRY(suscan_local_analyzer_feed_baseband_filters(self, samples, got));
+  suscan_local_analyzer_feed_async_baseband_filters(self, buffer, got);
 
-  /*
-    * NO CIRCULARITY: Increment reference and deliver to worker.
-    * 
-    * We deliver the calculation of the PSD FFT to a different worker.
-    * Additionally. We only feed the PSD worker if we are sure that the
-    * next allocation of a buffer is not going to sleep.
-    */
-  if (suscan_sample_buffer_pool_free_num(self->bufpool) > 0) {
-    suscan_sample_buffer_inc_ref(buffer);
-    SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, buffer));
-  }
+  /* We deliver the calculation of the PSD FFT to a different worker */
+  SU_TRY(suscan_local_analyzer_schedule_psd(self, buffer, got));
 
   if (SUSCAN_ANALYZER_FS_MEASURE_INTERVAL > 0) {
     seconds = (self->read_start - self->last_measure) * 1e-9;
@@ -831,7 +1513,13 @@ suscan_local_analyzer_buffer_channelizer_wk_cb(
       self->last_measure = self->read_start;
 #ifdef SUSCAN_DEBUG_THROTTLE
       printf("Read rate: %g\n", self->measured_samp_rate);
+      printf(
+        "PSD samples: %lu processed, %lu skipped, %lu dropped\n",
+        (unsigned long) self->psd_sched.processed,
+        (unsigned long) self->psd_sched.skipped,
+        (unsigned long) self->psd_sched.dropped);
 #endif /* SUSCAN_DEBUG_THROTTLE */
+      suscan_local_analyzer_publish_psd_stats(self);
     }
 
     self->measured_samp_count += got;
@@ -864,7 +1552,7 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
     void *cb_private)
 {
   suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
-  suscan_sample_buffer_t *buffer = NULL, *dup;
+  suscan_sample_buffer_t *buffer = NULL;
   SUCOMPLEX *samples;
   SUSDIFF got;
   SUBOOL mutex_acquired = SU_FALSE;
@@ -896,16 +1584,10 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
           self,
           samples,
           got));
+  suscan_local_analyzer_feed_async_baseband_filters(self, buffer, got);
 
-  /*
-   * CIRCULARITY: Buffer is being reused and must be duplicated
-   *
-   * This duplicate is contingent and we don't want it to block.
-   */
-  
-  dup = suscan_sample_buffer_pool_try_dup(self->bufpool, buffer);
-  if (dup != NULL)
-    SU_TRY(suscan_worker_push(self->psd_worker, suscan_psd_worker_cb, dup));
+  /* Duplicates are contingent and we don't want them to block */
+  SU_TRY(suscan_local_analyzer_schedule_psd(self, buffer, got));
 
   if (SUSCAN_ANALYZER_FS_MEASURE_INTERVAL > 0) {
     seconds = (self->read_start - self->last_measure) * 1e-9;
@@ -917,7 +1599,13 @@ suscan_local_analyzer_circbuf_channelizer_wk_cb(
       self->last_measure = self->read_start;
 #ifdef SUSCAN_DEBUG_THROTTLE
       printf("Read rate: %g\n", self->measured_samp_rate);
+      printf(
+        "PSD samples: %lu processed, %lu skipped, %lu dropped\n",
+        (unsigned long) self->psd_sched.processed,
+        (unsigned long) self->psd_sched.skipped,
+        (unsigned long) self->psd_sched.dropped);
 #endif /* SUSCAN_DEBUG_THROTTLE */
+      suscan_local_analyzer_publish_psd_stats(self);
     }
 
     self->measured_samp_count += got;
@@ -937,6 +1625,347 @@ done:
   return restart;
 }
 
+/*
+ * PIPELINED CIRCULARITY: as above, but the channelizer stage (forward FFT,
+ * channel outputs and inspector barrier) runs in its own worker while the
+ * source worker reads the next half. Since the half being read would
+ * overwrite the window being transformed, we alternate between two
+ * circular buffers, copying the last half read into the other half of
+ * the next buffer. Buffer contents and tuner states are exactly those of
+ * the non-pipelined path, and windows are triggered in the same order.
+ */
+SUINLINE void
+suscan_local_analyzer_update_timing(
+    SUFLOAT *timing,
+    uint64_t start,
+    uint64_t end)
+{
+  *timing +=
+    SUSCAN_LOCAL_ANALYZER_TIMING_ALPHA * ((SUFLOAT) (end - start) - *timing);
+}
+
+SUPRIVATE suscan_sample_buffer_t *
+suscan_local_analyzer_read_pipe(suscan_local_analyzer_t *self, SUSDIFF *got)
+{
+  suscan_sample_buffer_t *buffer = NULL;
+  su_specttuner_plan_t *plan = NULL;
+  SUSCOUNT offset = 0, read_size;
+  SUBOOL ok = SU_FALSE;
+
+  buffer = self->pipe_buf[self->pipe_ndx];
+
+  if (buffer == NULL) {
+    SU_TRY(buffer = suscan_sample_buffer_pool_acquire(self->bufpool));
+
+    plan = suscan_sample_buffer_userdata(buffer);
+    if (plan == NULL) {
+      SU_TRY(
+        plan = su_specttuner_make_plan(
+          self->stuner,
+          suscan_sample_buffer_data(buffer)));
+      suscan_sample_buffer_set_userdata(buffer, plan);
+    }
+
+    self->pipe_buf[self->pipe_ndx] = buffer;
+  }
+
+  read_size = suscan_sample_buffer_size(buffer) >> 1;
+
+  /* Bring the previous half, in the same place it had in the last buffer */
+  if (self->pipe_last_size > 0) {
+    suscan_sample_buffer_set_offset(buffer, self->pipe_last_offset);
+    memcpy(
+      suscan_sample_buffer_data(buffer),
+      self->pipe_last_data,
+      self->pipe_last_size * sizeof(SUCOMPLEX));
+  }
+
+  offset = self->circ_state ? read_size : 0;
+  self->circ_state = !self->circ_state;
+
+  suscan_sample_buffer_set_offset(buffer, offset);
+
+  SU_TRY(suscan_source_fill_buffer(self->source, buffer, read_size, got));
+
+  self->pipe_last_data   = suscan_sample_buffer_data(buffer);
+  self->pipe_last_offset = offset;
+  self->pipe_last_size   = read_size;
+
+  ok = SU_TRUE;
+
+done:
+  if (!ok) {
+    if (buffer != NULL && self->pipe_buf[self->pipe_ndx] != buffer) {
+      if (!suscan_sample_buffer_pool_give(self->bufpool, buffer))
+        SU_ERROR("Failed to give buffer!\n");
+    }
+    buffer = NULL;
+  }
+
+  return buffer;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_pipe_wk_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_local_analyzer_t *self  = (suscan_local_analyzer_t *) wk_private;
+  suscan_sample_buffer_t *buffer = (suscan_sample_buffer_t *)  cb_private;
+  uint64_t t0, t1, t2;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL ok = SU_FALSE;
+
+  t0 = suscan_gettime();
+
+  SU_TRYZ(pthread_mutex_lock(&self->stuner_mutex));
+  mutex_acquired = SU_TRUE;
+
+  su_specttuner_force_state(self->stuner, self->pipe_job_state);
+  ok = su_specttuner_trigger(
+    self->stuner,
+    suscan_sample_buffer_userdata(buffer));
+
+  t1 = suscan_gettime();
+
+  suscan_inspector_factory_force_sync(self->insp_factory);
+  su_specttuner_ack_data(self->stuner);
+
+  t2 = suscan_gettime();
+
+  (void) pthread_mutex_unlock(&self->stuner_mutex);
+  mutex_acquired = SU_FALSE;
+
+  (void) pthread_mutex_lock(&self->pipe_mutex);
+  suscan_local_analyzer_update_timing(&self->timings.channelize, t0, t1);
+  suscan_local_analyzer_update_timing(&self->timings.inspectors, t1, t2);
+  (void) pthread_mutex_unlock(&self->pipe_mutex);
+
+done:
+  if (mutex_acquired)
+    (void) pthread_mutex_unlock(&self->stuner_mutex);
+
+  (void) pthread_mutex_lock(&self->pipe_mutex);
+  self->pipe_busy = SU_FALSE;
+  if (!ok)
+    self->pipe_failed = SU_TRUE;
+  pthread_cond_broadcast(&self->pipe_cond);
+  (void) pthread_mutex_unlock(&self->pipe_mutex);
+
+  return SU_FALSE;
+}
+
+SUBOOL
+suscan_local_analyzer_drain_pipeline(suscan_local_analyzer_t *self)
+{
+  SUBOOL ok;
+
+  if (!self->pipelined)
+    return SU_TRUE;
+
+  if (pthread_mutex_lock(&self->pipe_mutex) != 0)
+    return SU_FALSE;
+
+  while (self->pipe_busy)
+    pthread_cond_wait(&self->pipe_cond, &self->pipe_mutex);
+
+  ok = !self->pipe_failed;
+
+  (void) pthread_mutex_unlock(&self->pipe_mutex);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_pipelined_channelizer_wk_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
+  suscan_sample_buffer_t *buffer = NULL;
+  SUCOMPLEX *samples;
+  SUSDIFF got;
+  uint64_t t_read, t_prepare, t_wait, t_end;
+  SUBOOL mutex_acquired = SU_FALSE;
+  SUBOOL restart = SU_FALSE;
+  SUFLOAT seconds;
+
+  SU_TRY(suscan_local_analyzer_lock_loop(self));
+  mutex_acquired = SU_TRUE;
+
+  SU_TRY(suscan_local_analyzer_parse_overridable(self));
+
+  /* Ready to read */
+  suscan_local_analyzer_read_start(self);
+  t_read = suscan_gettime();
+
+  buffer = suscan_local_analyzer_read_pipe(self, &got);
+  if (buffer == NULL) {
+    suscan_local_analyzer_send_eos(self, got);
+    goto done;
+  }
+
+  t_prepare = suscan_gettime();
+  suscan_local_analyzer_process_start(self);
+  samples = suscan_sample_buffer_data(buffer);
+
+  if (self->iq_rev)
+    suscan_analyzer_do_iq_rev(samples, got);
+
+  SU_TRY(
+      suscan_local_analyzer_feed_baseband_filters(
+          self,
+          samples,
+          got));
+  suscan_local_analyzer_feed_async_baseband_filters(self, buffer, got);
+
+  SU_TRY(suscan_local_analyzer_schedule_psd(self, buffer, got));
+
+  if (SUSCAN_ANALYZER_FS_MEASURE_INTERVAL > 0) {
+    seconds = (self->read_start - self->last_measure) * 1e-9;
+
+    if (seconds >= SUSCAN_ANALYZER_FS_MEASURE_INTERVAL) {
+      self->measured_samp_rate =
+          self->measured_samp_count / seconds;
+      self->measured_samp_count = 0;
+      self->last_measure = self->read_start;
+#ifdef SUSCAN_DEBUG_THROTTLE
+      printf("Read rate: %g\n", self->measured_samp_rate);
+      printf(
+        "PSD samples: %lu processed, %lu skipped, %lu dropped\n",
+        (unsigned long) self->psd_sched.processed,
+        (unsigned long) self->psd_sched.skipped,
+        (unsigned long) self->psd_sched.dropped);
+#endif /* SUSCAN_DEBUG_THROTTLE */
+      suscan_local_analyzer_publish_psd_stats(self);
+    }
+
+    self->measured_samp_count += got;
+  }
+
+  /* Wait for the previous window before triggering this one */
+  t_wait = suscan_gettime();
+  SU_TRY(suscan_local_analyzer_drain_pipeline(self));
+  t_end = suscan_gettime();
+
+  if (su_specttuner_get_channel_count(self->stuner) > 0) {
+    self->pipe_job_state = self->circ_state;
+
+    SU_TRYZ(pthread_mutex_lock(&self->pipe_mutex));
+    self->pipe_busy = SU_TRUE;
+    (void) pthread_mutex_unlock(&self->pipe_mutex);
+
+    if (!suscan_worker_push(
+      self->pipe_wk,
+      suscan_local_analyzer_pipe_wk_cb,
+      buffer)) {
+      SU_ERROR("Failed to push window to channelizer worker\n");
+      (void) pthread_mutex_lock(&self->pipe_mutex);
+      self->pipe_busy = SU_FALSE;
+      pthread_cond_broadcast(&self->pipe_cond);
+      (void) pthread_mutex_unlock(&self->pipe_mutex);
+      goto done;
+    }
+  }
+
+  self->pipe_ndx = (self->pipe_ndx + 1) % SUSCAN_LOCAL_ANALYZER_PIPELINE_BUFFERS;
+
+  (void) pthread_mutex_lock(&self->pipe_mutex);
+  suscan_local_analyzer_update_timing(&self->timings.read, t_read, t_prepare);
+  suscan_local_analyzer_update_timing(&self->timings.prepare, t_prepare, t_wait);
+  suscan_local_analyzer_update_timing(&self->timings.wait, t_wait, t_end);
+  (void) pthread_mutex_unlock(&self->pipe_mutex);
+
+  /* Finish processing */
+  suscan_local_analyzer_process_end(self);
+  restart = !self->parent->halt_requested;
+
+done:
+  if (mutex_acquired)
+    (void) suscan_local_analyzer_unlock_loop(self);
+
+  return restart;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_init_pipeline(suscan_local_analyzer_t *self)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRYZ(pthread_mutex_init(&self->pipe_mutex, NULL));
+  self->pipe_mutex_init = SU_TRUE;
+
+  SU_TRYZ(pthread_cond_init(&self->pipe_cond, NULL));
+  self->pipe_cond_init = SU_TRUE;
+
+  SU_TRY(suscan_mq_init(&self->pipe_mq));
+  self->pipe_mq_init = SU_TRUE;
+
+  SU_TRY(
+    self->pipe_wk = suscan_worker_new_ex(
+      "channelizer-worker",
+      &self->pipe_mq,
+      self));
+
+  self->pipelined = SU_TRUE;
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+void
+suscan_local_analyzer_destroy_pipeline(suscan_local_analyzer_t *self)
+{
+  unsigned int i;
+  su_specttuner_plan_t *plan;
+
+  if (self->pipe_wk != NULL) {
+    if (!suscan_analyzer_halt_worker(self->pipe_wk)) {
+      SU_ERROR("Channelizer worker destruction failed, memory leak ahead\n");
+      return;
+    }
+
+    self->pipe_wk = NULL;
+  }
+
+  for (i = 0; i < SUSCAN_LOCAL_ANALYZER_PIPELINE_BUFFERS; ++i) {
+    if (self->pipe_buf[i] != NULL) {
+      plan = suscan_sample_buffer_userdata(self->pipe_buf[i]);
+      if (plan != NULL)
+        su_specttuner_destroy_plan(self->stuner, plan);
+      suscan_sample_buffer_set_userdata(self->pipe_buf[i], NULL);
+
+      if (!suscan_sample_buffer_pool_give(self->bufpool, self->pipe_buf[i]))
+        SU_ERROR("Failed to give buffer!\n");
+      self->pipe_buf[i] = NULL;
+    }
+  }
+
+  self->pipe_last_size = 0;
+  self->pipe_ndx       = 0;
+
+  if (self->pipe_mq_init) {
+    suscan_mq_finalize(&self->pipe_mq);
+    self->pipe_mq_init = SU_FALSE;
+  }
+
+  if (self->pipe_cond_init) {
+    pthread_cond_destroy(&self->pipe_cond);
+    self->pipe_cond_init = SU_FALSE;
+  }
+
+  if (self->pipe_mutex_init) {
+    pthread_mutex_destroy(&self->pipe_mutex);
+    self->pipe_mutex_init = SU_FALSE;
+  }
+
+  self->pipelined = SU_FALSE;
+}
+
 SUBOOL
 suscan_local_analyzer_start_channel_worker(suscan_local_analyzer_t *self)
 {
@@ -952,10 +1981,19 @@ suscan_local_analyzer_start_channel_worker(suscan_local_analyzer_t *self)
       &self->mq_in,
       self));
 
+  /* Fast sources get the channelizer stage in a separate worker */
+  if (self->circularity 
+    && self->source_info.effective_samp_rate 
+    >= SUSCAN_LOCAL_ANALYZER_PIPELINE_MIN_RATE)
+    SU_TRY(suscan_local_analyzer_init_pipeline(self));
+
   /* Start source worker */
-  callback = self->circularity
-    ? suscan_local_analyzer_circbuf_channelizer_wk_cb
-    : suscan_local_analyzer_buffer_channelizer_wk_cb;
+  if (self->pipelined)
+    callback = suscan_local_analyzer_pipelined_channelizer_wk_cb;
+  else if (self->circularity)
+    callback = suscan_local_analyzer_circbuf_channelizer_wk_cb;
+  else
+    callback = suscan_local_analyzer_buffer_channelizer_wk_cb;
 
   if (!suscan_worker_push(self->source_wk, callback, self->source)) {
     suscan_analyzer_send_status(
@@ -19,7 +19,8 @@
 
 /*
  * This is the wide spectrum analyzer: walks the whole spectrum randomly,
- * given two limits, and returns PSD messages.
+ * given two limits, and returns PSD messages. Recordings are swept offline,
+ * segment by segment.
  */
 
 #include <stdlib.h>
@@ -35,8 +36,12 @@
 #include <sigutils/detect.h>
 #include <analyzer/impl/local.h>
 
+#include "realtime.h"
+
+#include "hopplan.h"
 #include "mq.h"
 #include "msg.h"
+#include "panorama.h"
 
 static uint64_t micros() {
   struct timeval tv;
@@ -45,92 +50,75 @@ static uint64_t micros() {
 }
 
 /*
- * TODO: Add methods to define partition bandwidth
+ * (Re)computes the hop plan if the sweep configuration changed. Plans
+ * are seeded per analyzer, so the same configuration always yields the
+ * same sequence of hops.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_update_hopplan(suscan_local_analyzer_t *self)
+{
+  SUFREQ fs = suscan_analyzer_get_samp_rate(self->parent);
+  suscan_hopplan_t *plan = NULL;
+
+  if (self->hopplan != NULL
+      && suscan_hopplan_matches(
+          self->hopplan,
+          &self->current_sweep_params,
+          fs))
+    return SU_TRUE;
+
+  SU_TRYCATCH(
+      plan = suscan_hopplan_new(
+          &self->current_sweep_params,
+          fs,
+          self->hop_seed),
+      return SU_FALSE);
+
+  if (self->hopplan != NULL)
+    suscan_hopplan_destroy(self->hopplan);
+
+  self->hopplan = plan;
+
+  return SU_TRUE;
+}
+
+/*
+ * Moves to the next hop of the plan. During the first pass, retune
+ * times are measured and stored in the plan as settle sample counts.
  */
 SUINLINE SUBOOL
 suscan_local_analyzer_hop(suscan_local_analyzer_t *self)
 {
-  SUFLOAT rnd = (SUFLOAT) rand() / (SUFLOAT) RAND_MAX;
   SUFREQ fs = suscan_analyzer_get_samp_rate(self->parent);
-  SUFREQ part_bw = self->current_sweep_params.partitioning
-      == SUSCAN_ANALYZER_SPECTRUM_PARTITIONING_DISCRETE
-      ? fs * self->current_sweep_params.rel_bw
-      : 1;
-  SUFREQ bw =
-        self->current_sweep_params.max_freq
-        - self->current_sweep_params.min_freq;
-  SUFREQ next = .5 * (
-      self->current_sweep_params.max_freq
-      + self->current_sweep_params.min_freq);
-  uint64_t t0, hop_time;
+  struct suscan_hop *hop;
+  SUBOOL calibrating;
+  uint64_t t0 = 0;
+
+  SU_TRYCATCH(suscan_local_analyzer_update_hopplan(self), return SU_FALSE);
+
+  hop = suscan_hopplan_next(self->hopplan);
 
   /*
-   * For frequencies below the sample rate, we don't hop.
-   * We simply stay in the same frequency until the user changes
-   * the frequency range. Note that when maximum and minimum frequencies
-   * are exactly the same, the hop bandwidth is actually the sample rate.
+   * For frequency ranges below the sample rate, we don't hop. We simply
+   * stay in the same frequency until the user changes the range.
    */
+  if (suscan_hopplan_get_hop_count(self->hopplan) == 1
+      && sufeq(self->curr_freq, hop->freq, 1))
+    return SU_TRUE;
 
-  if (bw < 1) {
-    if (sufeq(self->curr_freq, next, 1))
-      return SU_TRUE;
-  } else {
-    switch (self->current_sweep_params.strategy) {
-      /*
-       * Stochastic strategy: traverse the spectrum stochastically.
-       * This is the original Monte Carlo approach.
-       */
-      case SUSCAN_ANALYZER_SWEEP_STRATEGY_STOCHASTIC:
-        next = part_bw * SU_FLOOR(rnd * bw / part_bw)
-            + self->current_sweep_params.min_freq;
-        break;
+  calibrating = !suscan_hopplan_is_calibrated(self->hopplan);
+  if (calibrating)
+    t0 = micros();
 
-      case SUSCAN_ANALYZER_SWEEP_STRATEGY_PROGRESSIVE:
-        /* Progressive strategy: traverse the spectrum monotonically */
-        if (self->current_sweep_params.partitioning ==
-            SUSCAN_ANALYZER_SPECTRUM_PARTITIONING_DISCRETE) {
-          /* Discrete: advance in fixed steps of fs * rel_bw */
-          next = part_bw * self->part_ndx++
-            + self->current_sweep_params.min_freq;
-          if (next > self->current_sweep_params.max_freq) {
-            if (self->curr_freq < self->current_sweep_params.max_freq - part_bw * 0.5) {
-              next = self->current_sweep_params.max_freq;
-              self->part_ndx = 0;
-            } else {
-              next = self->current_sweep_params.min_freq;
-              self->part_ndx = 1;
-            }
-          }
-        } else {
-          /* Continuous: advance monotonically in randomized steps */
-          SUFLOAT step_size = fs * self->current_sweep_params.rel_bw;
-          SUFLOAT freq_jiggle = SU_FLOOR(step_size * rnd * 0.2);
-          next = self->curr_freq + step_size - freq_jiggle;
-          if (next > self->current_sweep_params.max_freq) {
-            if (self->curr_freq < self->current_sweep_params.max_freq - step_size * 0.5) {
-              next = self->current_sweep_params.max_freq - freq_jiggle;
-            } else {
-              next = self->current_sweep_params.min_freq + step_size * 0.5
-                  - freq_jiggle;
-            }
-          } else if (next < self->current_sweep_params.min_freq) {
-            /* can happen on first run when self->curr_freq may be invalid */
-            next = self->current_sweep_params.min_freq;
-          }
-        }
-        break;
-    }
-  }
-
-  /* All set. Go ahed and hop */
-  t0 = micros();
   if (suscan_source_set_freq2(
       self->source,
-      next,
+      hop->freq,
       suscan_source_config_get_lnb_freq(
           suscan_source_get_config(self->source)))) {
-    hop_time = micros() - t0;
-    self->hop_samples = fs * hop_time / 1000000;
+    if (calibrating)
+      hop->settle = fs * (micros() - t0) / 1000000;
+
+    self->hop_samples = hop->settle;
     self->curr_freq = suscan_source_get_freq(self->source);
     self->source_info.frequency = self->curr_freq;
 
@@ -140,6 +128,419 @@ suscan_local_analyzer_hop(suscan_local_analyzer_t *self)
   return SU_FALSE;
 }
 
+/*
+ * Offline sweeps: instead of retuning, seek to the next segment of the
+ * recording that falls in the sweep range. Returns SU_FALSE once all of
+ * them have been swept.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_next_segment(suscan_local_analyzer_t *self)
+{
+  const struct suscan_source_segment *segment;
+  SUFREQ min = self->current_sweep_params.min_freq;
+  SUFREQ max = self->current_sweep_params.max_freq;
+  SUSCOUNT decim = suscan_source_get_decimation(self->source);
+  SUSCOUNT capture;
+  unsigned int i;
+
+  if (self->segment_left > 0)
+    return SU_TRUE;
+
+  for (i = 0; i < self->segment_count; ++i) {
+    if (self->segment_ndx == self->segment_count) {
+      if (!suscan_source_config_get_loop(
+          suscan_source_get_config(self->source)))
+        return SU_FALSE;
+
+      suscan_source_mark_looped(self->source);
+      self->segment_ndx = 0;
+    }
+
+    segment = self->segment_list + self->segment_ndx++;
+
+    if (segment->length < decim)
+      continue;
+
+    if (max > min && (segment->freq < min || segment->freq > max))
+      continue;
+
+    /* Streams (e.g. stdin) have a single segment and cannot be rewound */
+    if (suscan_source_is_seekable(self->source))
+      SU_TRYCATCH(
+          suscan_source_seek(self->source, segment->start / decim),
+          return SU_FALSE);
+
+    self->segment_left = segment->length / decim;
+    self->curr_freq = segment->freq;
+    self->source_info.frequency = self->curr_freq;
+
+    /* Samples of the previous segment are useless now */
+    self->sweep_job[self->sweep_ndx].fill = 0;
+    self->fft_samples = 0;
+
+    /* Skip the beginning of the segment, as long as one capture fits */
+    capture = self->detector->params.window_size;
+    if (self->detector->params.decimation > 1)
+      capture *= self->detector->params.decimation;
+
+    self->segment_settle = self->segment_left > capture
+      ? SU_MIN(
+          self->current_sweep_params.fft_min_samples,
+          self->segment_left - capture)
+      : 0;
+
+    return SU_TRUE;
+  }
+
+  return SU_FALSE;
+}
+
+/*
+ * Recordings are swept offline: every segment of the recording is a hop,
+ * and samples are read as fast as the disk and the FFT allow. Recordings
+ * that do not describe their segments are swept as a single one.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_init_offline_sweep(suscan_local_analyzer_t *self)
+{
+  SUSDIFF size;
+
+  if (!suscan_source_get_segments(
+      self->source,
+      &self->segment_list,
+      &self->segment_count)) {
+    /* Unknown size: read until the end of the stream */
+    if ((size = suscan_source_get_max_size(self->source)) <= 0)
+      size = INT64_MAX;
+
+    self->whole_recording.start  = 0;
+    self->whole_recording.length = size;
+    self->whole_recording.freq   = suscan_source_get_freq(self->source);
+
+    self->segment_list  = &self->whole_recording;
+    self->segment_count = 1;
+  }
+
+  suscan_source_set_throttle_disabled(self->source, SU_TRUE);
+
+  self->sweep_offline = SU_TRUE;
+  self->segment_ndx   = 0;
+  self->segment_left  = 0;
+
+  return SU_TRUE;
+}
+
+/* The sweep rate is measured by the source worker, and sent by both */
+SUPRIVATE SUFLOAT
+suscan_local_analyzer_get_sweep_rate(suscan_local_analyzer_t *self)
+{
+  SUFLOAT rate;
+
+  (void) pthread_mutex_lock(&self->sweep_mutex);
+  rate = self->sweep_rate;
+  (void) pthread_mutex_unlock(&self->sweep_mutex);
+
+  return rate;
+}
+
+/*
+ * Waits for the pending captures and sends what is left of the panorama.
+ * Used at the end of offline sweeps, so that nothing arrives after EOS.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_flush_sweep(suscan_local_analyzer_t *self)
+{
+  struct timeval timestamp;
+
+  SU_TRYCATCH(suscan_local_analyzer_drain_sweep(self), return SU_FALSE);
+
+  if (self->panorama != NULL && suscan_panorama_is_dirty(self->panorama)) {
+    suscan_analyzer_get_source_time(self->parent, &timestamp);
+    SU_TRYCATCH(
+        suscan_analyzer_send_panorama(
+            self->parent,
+            self->panorama,
+            &timestamp,
+            suscan_local_analyzer_get_sweep_rate(self)),
+        return SU_FALSE);
+  }
+
+  return SU_TRUE;
+}
+
+/*
+ * Stitches the PSD of a capture into the panorama. The bins that changed
+ * since the last update are sent at the PSD update rate.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_feed_panorama(
+    suscan_local_analyzer_t *self,
+    const struct suscan_local_analyzer_sweep_job *job)
+{
+  suscan_panorama_t *panorama = NULL;
+  uint64_t now;
+
+  if (self->panorama == NULL
+      || !suscan_panorama_matches(
+          self->panorama,
+          job->min_freq,
+          job->max_freq,
+          job->panorama_bins)) {
+    SU_TRYCATCH(
+        panorama = suscan_panorama_new(
+            job->min_freq,
+            job->max_freq,
+            job->panorama_bins),
+        return SU_FALSE);
+
+    if (self->panorama != NULL)
+      suscan_panorama_destroy(self->panorama);
+
+    self->panorama = panorama;
+  }
+
+  suscan_panorama_feed(self->panorama, self->detector, job->fc, job->rel_bw);
+
+  now = suscan_gettime();
+  if ((now - self->panorama_last) * 1e-9 >= self->interval_psd
+      && suscan_panorama_is_dirty(self->panorama)) {
+    SU_TRYCATCH(
+        suscan_analyzer_send_panorama(
+            self->parent,
+            self->panorama,
+            &job->timestamp,
+            suscan_local_analyzer_get_sweep_rate(self)),
+        return SU_FALSE);
+
+    self->panorama_last = now;
+  }
+
+  return SU_TRUE;
+}
+
+/*
+ * Sweep worker: computes the PSD of a capture while the source worker
+ * is already capturing the next hop.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_sweep_wk_cb(
+    struct suscan_mq *mq_out,
+    void *wk_private,
+    void *cb_private)
+{
+  suscan_local_analyzer_t *self = (suscan_local_analyzer_t *) wk_private;
+  struct suscan_local_analyzer_sweep_job *job =
+    (struct suscan_local_analyzer_sweep_job *) cb_private;
+  SUBOOL notify;
+  SUBOOL ok = SU_FALSE;
+
+  su_channel_detector_rewind(self->detector);
+
+  SU_TRYCATCH(
+      su_channel_detector_feed_bulk(
+          self->detector,
+          job->samples,
+          job->length) == job->length,
+      goto done);
+
+  if (su_channel_detector_get_iters(self->detector) > 0) {
+    if (job->panorama_bins > 0) {
+      SU_TRYCATCH(suscan_local_analyzer_feed_panorama(self, job), goto done);
+    } else {
+      SU_TRYCATCH(
+          suscan_analyzer_send_sweep_psd(
+              self->parent,
+              self->detector,
+              job->fc,
+              &job->timestamp,
+              suscan_local_analyzer_get_sweep_rate(self)),
+          goto done);
+    }
+  }
+
+  ok = SU_TRUE;
+
+done:
+  (void) pthread_mutex_lock(&self->sweep_mutex);
+  job->busy = SU_FALSE;
+  notify = !ok && !self->sweep_failed;
+  if (!ok)
+    self->sweep_failed = SU_TRUE;
+  pthread_cond_broadcast(&self->sweep_cond);
+  (void) pthread_mutex_unlock(&self->sweep_mutex);
+
+  /* The source worker stops at the next hop. Tell clients why. */
+  if (notify)
+    (void) suscan_analyzer_send_status(
+        self->parent,
+        SUSCAN_ANALYZER_MESSAGE_TYPE_INTERNAL,
+        SUSCAN_ANALYZER_INIT_FAILURE,
+        "Wide sweep failed while processing capture at %.0f Hz",
+        (double) job->fc);
+
+  return SU_FALSE;
+}
+
+SUPRIVATE SUBOOL
+suscan_local_analyzer_wait_sweep_job(
+    suscan_local_analyzer_t *self,
+    const struct suscan_local_analyzer_sweep_job *job)
+{
+  SUBOOL ok;
+
+  if (pthread_mutex_lock(&self->sweep_mutex) != 0)
+    return SU_FALSE;
+
+  while (job->busy)
+    pthread_cond_wait(&self->sweep_cond, &self->sweep_mutex);
+
+  ok = !self->sweep_failed;
+
+  (void) pthread_mutex_unlock(&self->sweep_mutex);
+
+  return ok;
+}
+
+SUBOOL
+suscan_local_analyzer_drain_sweep(suscan_local_analyzer_t *self)
+{
+  unsigned int i;
+
+  if (self->sweep_wk == NULL)
+    return SU_TRUE;
+
+  for (i = 0; i < SUSCAN_LOCAL_ANALYZER_SWEEP_BUFFERS; ++i)
+    if (!suscan_local_analyzer_wait_sweep_job(self, self->sweep_job + i))
+      return SU_FALSE;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+suscan_local_analyzer_update_sweep_rate(suscan_local_analyzer_t *self)
+{
+  SUFREQ fs = suscan_analyzer_get_samp_rate(self->parent);
+  uint64_t now = suscan_gettime();
+  SUFLOAT seconds, rate;
+
+  /* Offline, every capture is a full look at its segment */
+  self->sweep_span += self->sweep_offline
+    ? fs
+    : fs * self->current_sweep_params.rel_bw;
+  seconds = (now - self->sweep_last_measure) * 1e-9;
+
+  if (seconds >= SUSCAN_ANALYZER_FS_MEASURE_INTERVAL) {
+    rate = self->sweep_span / seconds;
+
+    (void) pthread_mutex_lock(&self->sweep_mutex);
+    if (self->sweep_rate > 0)
+      self->sweep_rate +=
+        SUSCAN_LOCAL_ANALYZER_SWEEP_RATE_ALPHA * (rate - self->sweep_rate);
+    else
+      self->sweep_rate = rate;
+    (void) pthread_mutex_unlock(&self->sweep_mutex);
+
+    self->sweep_span = 0;
+    self->sweep_last_measure = now;
+  }
+}
+
+/*
+ * Skips the samples read while the tuner settles, and captures enough
+ * samples for one FFT. As soon as the capture is complete, it is handed
+ * to the sweep worker and we hop, so that retuning and FFT overlap.
+ */
+SUPRIVATE SUBOOL
+suscan_local_analyzer_sweep_capture(
+    suscan_local_analyzer_t *self,
+    const SUCOMPLEX *data,
+    SUSCOUNT size)
+{
+  struct suscan_local_analyzer_sweep_job *job;
+  SUSCOUNT settle, length, chunk;
+  SUCOMPLEX *samples;
+  SUBOOL ok = SU_FALSE;
+
+  settle = self->sweep_offline
+    ? self->segment_settle
+    : self->current_sweep_params.fft_min_samples + self->hop_samples;
+
+  if (self->fft_samples < settle) {
+    chunk = SU_MIN(size, settle - self->fft_samples);
+    self->fft_samples += chunk;
+    data += chunk;
+    size -= chunk;
+  }
+
+  if (size == 0)
+    return SU_TRUE;
+
+  job = self->sweep_job + self->sweep_ndx;
+
+  if (job->fill == 0) {
+    /* Previous capture in this slot may still be in the sweep worker */
+    SU_TRY(suscan_local_analyzer_wait_sweep_job(self, job));
+
+    length = self->detector->params.window_size;
+    if (self->detector->params.decimation > 1)
+      length *= self->detector->params.decimation;
+
+    if (length > job->alloc) {
+      SU_TRY(samples = realloc(job->samples, length * sizeof(SUCOMPLEX)));
+      job->samples = samples;
+      job->alloc   = length;
+    }
+
+    job->length   = length;
+    job->fc       = self->curr_freq;
+    job->min_freq = self->current_sweep_params.min_freq;
+    job->max_freq = self->current_sweep_params.max_freq;
+    job->rel_bw   = self->current_sweep_params.rel_bw;
+
+    /* A single frequency has nothing to stitch */
+    job->panorama_bins = job->max_freq > job->min_freq
+      ? SU_MIN(self->parent->params.panorama_bins, SUSCAN_PANORAMA_MAX_BINS)
+      : 0;
+    suscan_analyzer_get_source_time(self->parent, &job->timestamp);
+  }
+
+  chunk = SU_MIN(size, job->length - job->fill);
+  memcpy(job->samples + job->fill, data, chunk * sizeof(SUCOMPLEX));
+  job->fill         += chunk;
+  self->fft_samples += chunk;
+
+  if (job->fill == job->length) {
+    job->busy = SU_TRUE;
+    job->fill = 0;
+
+    if (!suscan_worker_push(
+      self->sweep_wk,
+      suscan_local_analyzer_sweep_wk_cb,
+      job)) {
+      SU_ERROR("Failed to push capture to sweep worker\n");
+      job->busy = SU_FALSE;
+      goto done;
+    }
+
+    self->sweep_ndx = (self->sweep_ndx + 1) % SUSCAN_LOCAL_ANALYZER_SWEEP_BUFFERS;
+    self->fft_samples = 0;
+
+    suscan_local_analyzer_update_sweep_rate(self);
+
+    if (self->sweep_offline) {
+      /* Keep reading the segment, no need to settle in between */
+      self->segment_settle = 0;
+    } else if (!suscan_local_analyzer_hop(self)) {
+      SU_ERROR("Hop failed!\n");
+    }
+  }
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
 SUBOOL
 suscan_source_wide_wk_cb(
     struct suscan_mq *mq_out,
@@ -154,54 +555,38 @@ suscan_source_wide_wk_cb(
   SU_TRYCATCH(suscan_local_analyzer_lock_loop(self), goto done);
   mutex_acquired = SU_TRUE;
 
-  /* Non real time sources are not allowed. */
-  SU_TRYCATCH(suscan_analyzer_is_real_time(self->parent), goto done);
-
   if (self->sweep_params_requested) {
     self->current_sweep_params = self->pending_sweep_params;
     self->sweep_params_requested = SU_FALSE;
   }
 
-  if ((got = suscan_source_read(
-      self->source,
-      self->read_buf,
-      self->read_size)) > 0) {
+  if (self->sweep_offline && !suscan_local_analyzer_next_segment(self))
+    got = SU_BLOCK_PORT_READ_END_OF_STREAM; /* Every segment swept */
+  else
+    got = suscan_source_read(
+        self->source,
+        self->read_buf,
+        self->sweep_offline
+          ? SU_MIN(self->read_size, self->segment_left)
+          : self->read_size);
+
+  if (got > 0) {
+    if (self->sweep_offline)
+      self->segment_left -= got;
 
     if (self->iq_rev)
       suscan_analyzer_do_iq_rev(self->read_buf, got);
-    self->fft_samples += got;
 
-    if (self->fft_samples > self->current_sweep_params.fft_min_samples +
-        self->hop_samples) {
-      /* Feed detector (works in spectrum mode only) */
-      SU_TRYCATCH(
-          su_channel_detector_feed_bulk(
-              self->detector,
-              self->read_buf,
-              got) == got,
-          goto done);
-
-      /*
-       * Reached threshold. Send message and hop. Note we do this right here,
-       * in the source worker. This way we ensure synchronous arrival
-       * of samples at the selected frequency.
-       */
-
-      if (su_channel_detector_get_iters(self->detector) > 0) {
-        SU_TRYCATCH(
-            suscan_analyzer_send_psd(self->parent, self->detector),
-            goto done);
-
-        self->fft_samples = 0;
-        su_channel_detector_rewind(self->detector);
-        if (!suscan_local_analyzer_hop(self))
-          SU_ERROR("Hop failed!\n");
-      }
-    }
+    SU_TRYCATCH(
+        suscan_local_analyzer_sweep_capture(self, self->read_buf, got),
+        goto done);
   } else {
     self->parent->eos = SU_TRUE; /* TODO: use force_eos? */
     self->cpu_usage = 0;
 
+    if (self->sweep_offline && !suscan_local_analyzer_flush_sweep(self))
+      SU_ERROR("Failed to flush the last captures of the sweep\n");
+
     switch (got) {
       case SU_BLOCK_PORT_READ_END_OF_STREAM:
         suscan_analyzer_send_status(
@@ -312,6 +697,28 @@ suscan_local_analyzer_init_wide_worker(suscan_local_analyzer_t *self)
   self->sweep_params_requested = SU_FALSE;
 
   self->hop_samples = 0;
+  self->hop_seed    = suscan_hopplan_default_seed();
+
+  if (!suscan_source_is_real_time(self->source))
+    SU_TRY(suscan_local_analyzer_init_offline_sweep(self));
+
+  /* FFTs of the sweep are computed in a separate worker */
+  SU_TRYZ(pthread_mutex_init(&self->sweep_mutex, NULL));
+  self->sweep_mutex_init = SU_TRUE;
+
+  SU_TRYZ(pthread_cond_init(&self->sweep_cond, NULL));
+  self->sweep_cond_init = SU_TRUE;
+
+  SU_TRY(suscan_mq_init(&self->sweep_mq));
+  self->sweep_mq_init = SU_TRUE;
+
+  SU_TRY(
+    self->sweep_wk = suscan_worker_new_ex(
+      "sweep-worker",
+      &self->sweep_mq,
+      self));
+
+  self->sweep_last_measure = suscan_gettime();
 
   ok = SU_TRUE;
 
@@ -341,3 +748,49 @@ suscan_local_analyzer_start_wide_worker(suscan_local_analyzer_t *self)
 done:
   return ok;
 }
+
+void
+suscan_local_analyzer_destroy_sweep(suscan_local_analyzer_t *self)
+{
+  unsigned int i;
+
+  if (self->sweep_wk != NULL) {
+    if (!suscan_analyzer_halt_worker(self->sweep_wk)) {
+      SU_ERROR("Sweep worker destruction failed, memory leak ahead\n");
+      return;
+    }
+
+    self->sweep_wk = NULL;
+  }
+
+  if (self->hopplan != NULL) {
+    suscan_hopplan_destroy(self->hopplan);
+    self->hopplan = NULL;
+  }
+
+  if (self->panorama != NULL) {
+    suscan_panorama_destroy(self->panorama);
+    self->panorama = NULL;
+  }
+
+  for (i = 0; i < SUSCAN_LOCAL_ANALYZER_SWEEP_BUFFERS; ++i) {
+    if (self->sweep_job[i].samples != NULL)
+      free(self->sweep_job[i].samples);
+    memset(self->sweep_job + i, 0, sizeof(self->sweep_job[i]));
+  }
+
+  if (self->sweep_mq_init) {
+    suscan_mq_finalize(&self->sweep_mq);
+    self->sweep_mq_init = SU_FALSE;
+  }
+
+  if (self->sweep_cond_init) {
+    pthread_cond_destroy(&self->sweep_cond);
+    self->sweep_cond_init = SU_FALSE;
+  }
+
+  if (self->sweep_mutex_init) {
+    pthread_mutex_destroy(&self->sweep_mutex);
+    self->sweep_mutex_init = SU_FALSE;
+  }
+}
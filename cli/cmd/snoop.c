@@ -52,6 +52,12 @@ suscli_snoop_msg_to_string(uint32_t type)
   if (type <= SUSCAN_ANALYZER_MESSAGE_TYPE_SEEK)
     return types[type];
 
+  if (type == SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA)
+    return "PANORAMA";
+
+  if (type == SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS)
+    return "SPECTRAL_STATS";
+
   if (type == SUSCAN_WORKER_MSG_TYPE_HALT)
     return "HALT";
 
@@ -137,11 +143,58 @@ suscli_snoop_msg_debug_psd_msg(
 
   if (msg->measured_samp_rate > 0)
     JSON_MSG_SUFLOAT(measured_samp_rate);
+
+  /* Pipelined channelizer only */
+  if (msg->timings.read > 0) {
+    JSON_MSG_SUFLOAT(timings.read);
+    JSON_MSG_SUFLOAT(timings.prepare);
+    JSON_MSG_SUFLOAT(timings.wait);
+    JSON_MSG_SUFLOAT(timings.channelize);
+    JSON_MSG_SUFLOAT(timings.inspectors);
+  }
+
+  JSON_MSG_SUSCOUNT(psd_stats.processed);
+  JSON_MSG_SUSCOUNT(psd_stats.skipped);
+  JSON_MSG_SUSCOUNT(psd_stats.dropped);
+
   JSON_MSG_SUSCOUNT(psd_size);
 
   return SU_TRUE;
 }
 
+SUPRIVATE SUBOOL
+suscli_snoop_msg_debug_panorama_msg(
+  const struct suscan_analyzer_panorama_msg *msg)
+{
+  JSON_MSG_SUFREQ(min_freq);
+  JSON_MSG_SUFREQ(max_freq);
+  JSON_MSG_HANDLE(bins);
+  JSON_MSG_BOOL(reset);
+  JSON_MSG_TIMEVAL(timestamp);
+  JSON_MSG_TIMEVAL(rt_time);
+  JSON_MSG_SUFLOAT(sweep_rate);
+  JSON_MSG_HANDLE(range_count);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+suscli_snoop_msg_debug_spectral_stats_msg(
+  const struct suscan_analyzer_spectral_stats_msg *msg)
+{
+  JSON_MSG_INT64(fc);
+  JSON_MSG_SUFLOAT(samp_rate);
+  JSON_MSG_TIMEVAL(start);
+  JSON_MSG_TIMEVAL(timestamp);
+  JSON_MSG_TIMEVAL(rt_time);
+  JSON_MSG_SUSCOUNT(frames);
+  JSON_MSG_SUFLOAT(threshold);
+  JSON_MSG_SUFLOAT(percentile);
+  JSON_MSG_SUSCOUNT(size);
+
+  return SU_TRUE;
+}
+
 
 SUPRIVATE SUBOOL
 suscli_snoop_msg_debug_params(
@@ -316,6 +369,14 @@ suscli_snoop_msg_debug(uint32_t type, void *message)
       suscli_snoop_msg_debug_psd_msg(message);
       break;
 
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PANORAMA:
+      suscli_snoop_msg_debug_panorama_msg(message);
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_SPECTRAL_STATS:
+      suscli_snoop_msg_debug_spectral_stats_msg(message);
+      break;
+
     case SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES:
       break;
 
@@ -580,12 +580,25 @@ suscli_analyzer_client_intercept_message(
           self,
           SUSCAN_ANALYZER_PERM_SET_FFT_FPS))
           params->psd_update_int = self->analyzer_params.psd_update_int;
+
+        if (!suscli_analyzer_client_test_permission(
+          self,
+          SUSCAN_ANALYZER_PERM_SET_FFT_FPS))
+          params->psd_averaging = self->analyzer_params.psd_averaging;
+
+        /* Statistics are shared: reconfiguring them resets them for all */
+        if (!suscli_analyzer_client_test_permission(
+          self,
+          SUSCAN_ANALYZER_PERM_SET_FFT_FPS)) {
+          params->stats_interval   = self->analyzer_params.stats_interval;
+          params->stats_threshold  = self->analyzer_params.stats_threshold;
+          params->stats_percentile = self->analyzer_params.stats_percentile;
+        }
         
         if (!suscli_analyzer_client_test_permission(
           self,
           SUSCAN_ANALYZER_PERM_SET_FFT_SIZE))
-          params->detector_params.window_size 
-            = self->analyzer_params.detector_params.window_size;
+          params->panorama_bins = self->analyzer_params.panorama_bins;
         
         if (!suscli_analyzer_client_test_permission(
           self,
@@ -593,6 +606,15 @@ suscli_analyzer_client_intercept_message(
           params->detector_params.window 
             = self->analyzer_params.detector_params.window;
         
+        /*
+         * The FFT size and span only define the PSD view of this client,
+         * derived from the native PSD. Whether the native FFT size must
+         * grow to honor it is decided by the server.
+         */
+        if (params->detector_params.window_size == 0)
+          params->detector_params.window_size
+            = self->analyzer_params.detector_params.window_size;
+
         /* We only adjust these parameters */
         self->analyzer_params.detector_params.window 
           = params->detector_params.window;
@@ -600,6 +622,22 @@ suscli_analyzer_client_intercept_message(
           = params->detector_params.window_size;
         self->analyzer_params.psd_update_int
           = params->psd_update_int;
+        self->analyzer_params.psd_averaging
+          = params->psd_averaging;
+        self->analyzer_params.stats_interval
+          = params->stats_interval;
+        self->analyzer_params.stats_threshold
+          = params->stats_threshold;
+        self->analyzer_params.stats_percentile
+          = params->stats_percentile;
+        self->analyzer_params.panorama_bins
+          = params->panorama_bins;
+        self->analyzer_params.psd_span_min
+          = params->psd_span_min;
+        self->analyzer_params.psd_span_max
+          = params->psd_span_max;
+        self->analyzer_params.psd_aggregation
+          = params->psd_aggregation;
 
         /* Sanitize parameters */
         *params = self->analyzer_params;
@@ -1149,6 +1187,7 @@ suscli_analyzer_client_list_init(
   SU_MAKE(self->client_tree, rbtree);
   SU_MAKE(self->itl_tree,    rbtree);
   SU_MAKE(self->req_tree,    rbtree);
+  SU_MAKE(self->psd_pyramid, suscan_psd_pyramid);
 
   rbtree_set_dtor(self->itl_tree, rbtree_node_free_dtor, NULL);
 
@@ -1323,6 +1362,98 @@ done:
   return ok;
 }
 
+/*
+ * Some broadcast messages depend on the recipient: PSDs are delivered
+ * according to the view of each client, and so are the FFT parameters
+ * echoed back by the analyzer. Clients that need their own copy of the
+ * message get it in pdu, and *custom is set to SU_TRUE.
+ */
+SUPRIVATE SUBOOL
+suscli_analyzer_client_list_make_custom_pdu_unsafe(
+    struct suscli_analyzer_client_list *self,
+    const suscli_analyzer_client_t *client,
+    const struct suscan_analyzer_remote_call *call,
+    SUBOOL *psd_fed,
+    grow_buf_t *pdu,
+    SUBOOL *custom)
+{
+  struct suscan_analyzer_remote_call custom_call =
+      suscan_analyzer_remote_call_INITIALIZER;
+  const struct suscan_analyzer_psd_msg *psd;
+  const struct suscan_analyzer_params *params;
+  struct suscan_analyzer_params client_params;
+  struct suscan_psd_view view;
+  SUBOOL ok = SU_FALSE;
+
+  *custom = SU_FALSE;
+
+  if (call->type != SUSCAN_ANALYZER_REMOTE_MESSAGE)
+    return SU_TRUE;
+
+  suscan_psd_view_from_params(&view, &client->analyzer_params);
+
+  custom_call.type     = SUSCAN_ANALYZER_REMOTE_MESSAGE;
+  custom_call.msg.type = call->msg.type;
+
+  switch (call->msg.type) {
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PSD:
+      psd = call->msg.ptr;
+
+      if (suscan_psd_view_is_native(&view, psd->psd_size))
+        return SU_TRUE;
+
+      /* Feed the pyramid only once per PSD */
+      if (!*psd_fed) {
+        SU_TRY(
+          suscan_psd_pyramid_feed(
+            self->psd_pyramid,
+            psd->psd_data,
+            psd->psd_size));
+        *psd_fed = SU_TRUE;
+      }
+
+      SU_TRY(
+        custom_call.msg.ptr = suscan_psd_pyramid_render(
+          self->psd_pyramid,
+          &view,
+          psd));
+      break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PARAMS:
+      params = call->msg.ptr;
+
+      client_params = *params;
+      client_params.detector_params.window_size = view.size;
+      client_params.psd_span_min                = view.span_min;
+      client_params.psd_span_max                = view.span_max;
+      client_params.psd_aggregation             = view.aggregation;
+
+      if (client_params.detector_params.window_size == 0)
+        client_params.detector_params.window_size
+          = params->detector_params.window_size;
+
+      custom_call.msg.ptr = &client_params;
+      break;
+
+    default:
+      return SU_TRUE;
+  }
+
+  SU_TRY(suscan_analyzer_remote_call_serialize(&custom_call, pdu));
+  *custom = SU_TRUE;
+
+  ok = SU_TRUE;
+
+done:
+  /* Parameters live in the stack */
+  if (custom_call.msg.ptr == &client_params)
+    custom_call.msg.ptr = NULL;
+
+  suscan_analyzer_remote_call_finalize(&custom_call);
+
+  return ok;
+}
+
 SUBOOL
 suscli_analyzer_client_list_broadcast_unsafe(
     struct suscli_analyzer_client_list *self,
@@ -1335,8 +1466,10 @@ suscli_analyzer_client_list_broadcast_unsafe(
 {
   suscli_analyzer_client_t *this;
   grow_buf_t pdu = grow_buf_INITIALIZER;
+  grow_buf_t custom_pdu = grow_buf_INITIALIZER;
   SUBOOL mc_enabled = self->mc_manager != NULL;
-  SUBOOL unicast;
+  SUBOOL unicast, custom, written;
+  SUBOOL psd_fed = SU_FALSE;
   int error;
   SUBOOL ok = SU_FALSE;
 
@@ -1357,7 +1490,25 @@ suscli_analyzer_client_list_broadcast_unsafe(
     if (suscli_analyzer_client_can_write(this)
         && suscli_analyzer_client_has_source_info(this)
         && unicast) {
-      if (!suscli_analyzer_client_write_buffer(this, &pdu)) {
+      SU_TRY(
+        suscli_analyzer_client_list_make_custom_pdu_unsafe(
+          self,
+          this,
+          call,
+          &psd_fed,
+          &custom_pdu,
+          &custom));
+
+      if (custom)
+        written = suscli_analyzer_client_write_buffer_zerocopy(
+          this,
+          &custom_pdu);
+      else
+        written = suscli_analyzer_client_write_buffer(this, &pdu);
+
+      grow_buf_shrink(&custom_pdu);
+
+      if (!written) {
         error = errno;
         SU_WARNING(
             "%s: write failed (%s)\n",
@@ -1373,6 +1524,7 @@ suscli_analyzer_client_list_broadcast_unsafe(
   ok = SU_TRUE;
 
 done:
+  grow_buf_finalize(&custom_pdu);
   grow_buf_finalize(&pdu);
 
   return ok;
@@ -1529,6 +1681,9 @@ suscli_analyzer_client_list_finalize(struct suscli_analyzer_client_list *self)
 
   if (self->req_tree != NULL)
     rbtree_destroy(self->req_tree);
+
+  if (self->psd_pyramid != NULL)
+    suscan_psd_pyramid_destroy(self->psd_pyramid);
   
   memset(self, 0, sizeof(struct suscli_analyzer_client_list));
 }
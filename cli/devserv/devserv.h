@@ -22,6 +22,7 @@
 
 #include <sigutils/util/compat-unistd.h>
 #include <analyzer/impl/remote.h>
+#include <analyzer/psdpyramid.h>
 #include <util/rbtree.h>
 #include <util/hashlist.h>
 #include <sigutils/util/compat-inet.h>
@@ -185,6 +186,7 @@ struct suscli_analyzer_client {
   const struct suscli_user_entry *user_entry;
   
   struct suscan_analyzer_params analyzer_params;
+  SUSCOUNT fft_size_request; /* Native FFT size requested, 0 if none */
   struct suscan_remote_partial_pdu_state pdu_state;
 
   char *name;
@@ -465,6 +467,9 @@ struct suscli_analyzer_client_list {
 
   /* Global request table */
   rbtree_t       *req_tree;
+
+  /* Coarser PSDs and spans, for clients not using the native FFT size */
+  suscan_psd_pyramid_t *psd_pyramid;
 };
 
 uint32_t suscli_analyzer_client_list_alloc_global_id_unsafe(
@@ -606,6 +611,11 @@ struct suscli_analyzer_server {
   struct suscli_analyzer_server_params params;
   struct suscli_analyzer_client_list client_list;
   struct suscan_analyzer_params analyzer_params;
+  SUSCOUNT default_fft_size;
+
+  /* Latest parameters echoed by the analyzer. Under client_mutex */
+  struct suscan_analyzer_params last_params;
+  SUBOOL have_last_params;
 
   uint16_t listen_port;
 
@@ -33,6 +33,8 @@ SUPRIVATE void suscli_analyzer_server_kick_client(
 SUPRIVATE void suscli_analyzer_server_kick_client_unsafe(
     suscli_analyzer_server_t *self,
     suscli_analyzer_client_t *client);
+SUPRIVATE void suscli_analyzer_server_update_fft_size_unsafe(
+    suscli_analyzer_server_t *self);
 
 
 struct suscli_user_entry *
@@ -278,6 +280,12 @@ suscli_analyzer_server_intercept_message_unsafe(
       }
 
       break;
+
+    case SUSCAN_ANALYZER_MESSAGE_TYPE_PARAMS:
+      /* Kept to reconfigure the native FFT size when clients leave */
+      self->last_params      = *(struct suscan_analyzer_params *) message;
+      self->have_last_params = SU_TRUE;
+      break;
   }
 
   *oclient = client;
@@ -729,6 +737,7 @@ suscli_analyzer_server_kick_client_unsafe(
   if (!suscli_analyzer_client_is_failed(client)) {
     suscli_analyzer_server_cleanup_client_resources(self, client);
     suscli_analyzer_client_mark_failed(client);
+    suscli_analyzer_server_update_fft_size_unsafe(self);
   }
 }
 
@@ -800,6 +809,88 @@ done:
   return ok;
 }
 
+/*
+ * Clients only ask for PSD views. The analyzer computes the finest FFT
+ * currently requested by connected clients allowed to do so (or the
+ * default size, if larger), and the rest of the views are derived from it.
+ */
+SUPRIVATE SUSCOUNT
+suscli_analyzer_server_get_native_fft_size_unsafe(
+  const suscli_analyzer_server_t *self)
+{
+  const suscli_analyzer_client_t *this;
+  SUSCOUNT native = self->default_fft_size;
+
+  for (this = self->client_list.client_head; this != NULL; this = this->next)
+    if (!suscli_analyzer_client_is_failed(this)
+      && this->fft_size_request > native)
+      native = this->fft_size_request;
+
+  return native;
+}
+
+/*
+ * Called when clients leave. If the native FFT size was kept large for
+ * them, the analyzer is reconfigured with the size that is still needed.
+ * This requires the latest parameters echoed by the analyzer: otherwise,
+ * the size is fixed by the next parameter change.
+ */
+SUPRIVATE void
+suscli_analyzer_server_update_fft_size_unsafe(suscli_analyzer_server_t *self)
+{
+  SUSCOUNT native = suscli_analyzer_server_get_native_fft_size_unsafe(self);
+  struct suscan_analyzer_params params;
+
+  if (native == self->analyzer_params.detector_params.window_size)
+    return;
+
+  self->analyzer_params.detector_params.window_size = native;
+
+  if (self->analyzer == NULL || !self->have_last_params)
+    return;
+
+  params = self->last_params;
+  params.detector_params.window_size = native;
+  params.psd_span_min    = 0;
+  params.psd_span_max    = 0;
+  params.psd_aggregation = SUSCAN_ANALYZER_PSD_AGGREGATION_MEAN;
+
+  if (!suscan_analyzer_set_params_async(self->analyzer, &params, 0))
+    SU_WARNING("Failed to shrink the native FFT size\n");
+}
+
+SUPRIVATE SUBOOL
+suscli_analyzer_server_fix_params(
+  suscli_analyzer_server_t *self,
+  suscli_analyzer_client_t *caller,
+  struct suscan_analyzer_params *params)
+{
+  SUSCOUNT native;
+
+  SU_TRYZ(pthread_mutex_lock(&self->client_list.client_mutex));
+
+  /* A new request replaces the previous one, be it larger or smaller */
+  if (suscli_analyzer_client_test_permission(
+      caller,
+      SUSCAN_ANALYZER_PERM_SET_FFT_SIZE))
+    caller->fft_size_request = params->detector_params.window_size;
+
+  native = suscli_analyzer_server_get_native_fft_size_unsafe(self);
+  self->analyzer_params.detector_params.window_size = native;
+
+  (void) pthread_mutex_unlock(&self->client_list.client_mutex);
+
+  params->detector_params.window_size = native;
+  params->psd_span_min    = 0;
+  params->psd_span_max    = 0;
+  params->psd_aggregation = SUSCAN_ANALYZER_PSD_AGGREGATION_MEAN;
+
+  return SU_TRUE;
+
+done:
+  return SU_FALSE;
+}
+
 SUPRIVATE SUBOOL
 suscli_analyzer_server_deliver_call(
     suscli_analyzer_server_t *self,
@@ -949,6 +1040,13 @@ suscli_analyzer_server_deliver_call(
           call->msg.type,
           call->msg.ptr,
           &interceptors)) {
+        if (call->msg.type == SUSCAN_ANALYZER_MESSAGE_TYPE_PARAMS)
+          SU_TRY(
+            suscli_analyzer_server_fix_params(
+              self,
+              caller,
+              call->msg.ptr));
+
         SU_TRYCATCH(
           suscan_analyzer_write(
               self->analyzer,
@@ -1324,6 +1422,7 @@ suscli_analyzer_server_new_with_params(
 
   new->params = *params;
   new->analyzer_params = analyzer_params;
+  new->default_fft_size = analyzer_params.detector_params.window_size;
 
   new->client_list.listen_fd = -1;
   new->client_list.cancel_fd = -1;
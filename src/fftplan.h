@@ -0,0 +1,44 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+#ifndef _SUSCAN_FFTPLAN_H
+#define _SUSCAN_FFTPLAN_H
+
+#include <sigutils/defs.h>
+#include <sigutils/types.h>
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * FFTW planning is not thread-safe, and suscan creates and destroys plans
+ * from several workers (inspectors, estimators). Every FFTW plan created
+ * or destroyed by suscan must be so while holding this lock. Note that
+ * plans made inside sigutils (spectral tuner, smooth PSD, channel
+ * detector) do not take it.
+ */
+SUBOOL suscan_fft_planner_lock(void);
+void   suscan_fft_planner_unlock(void);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif /* _SUSCAN_FFTPLAN_H */
@@ -25,6 +25,7 @@
 #include <sigutils/util/util.h>
 #include <util/compat.h>
 #include "suscan.h"
+#include "fftplan.h"
 #include "plugin.h"
 
 #define SUSCAN_MAX_MESSAGES 1024
@@ -38,6 +39,7 @@ struct suscan_message {
 };
 
 SUPRIVATE pthread_mutex_t log_mutex = PTHREAD_MUTEX_INITIALIZER;
+SUPRIVATE pthread_mutex_t g_fft_planner_mutex = PTHREAD_MUTEX_INITIALIZER;
 SUPRIVATE struct suscan_message *message_ring[SUSCAN_MAX_MESSAGES];
 SUPRIVATE unsigned int message_ptr;
 SUPRIVATE unsigned int message_count;
@@ -250,6 +252,18 @@ fail:
   return NULL;
 }
 
+SUBOOL
+suscan_fft_planner_lock(void)
+{
+  return pthread_mutex_lock(&g_fft_planner_mutex) == 0;
+}
+
+void
+suscan_fft_planner_unlock(void)
+{
+  (void) pthread_mutex_unlock(&g_fft_planner_mutex);
+}
+
 SUPRIVATE void
 suscan_atexit_handler(void)
 {
@@ -0,0 +1,241 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * Drift inspector tracking test: both the full-rate and the decimated
+ * loops track a tone following a synthetic Doppler ramp. Their frequency
+ * errors and CPU times are compared.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <suscan.h>
+#include <analyzer/mq.h>
+#include <analyzer/inspector/inspector.h>
+
+#define TEST_SAMP_RATE    250000.   /* Channel rate (Hz) */
+#define TEST_BANDWIDTH    .2        /* Normalized channel bandwidth */
+#define TEST_DURATION     20.       /* Seconds */
+#define TEST_F0           500.      /* Initial carrier frequency (Hz) */
+#define TEST_RATE         -150.     /* Doppler rate (Hz/s) */
+#define TEST_NOISE_STDDEV .1        /* Per component, 17 dB SNR */
+#define TEST_SETTLE_TIME  2.        /* Errors are ignored before this */
+#define TEST_MAX_RMS_ERR  5.        /* Hz */
+#define TEST_MAX_EXCESS   2.        /* Decimated vs. full-rate error (Hz) */
+#define TEST_BLOCK_SIZE   4096
+
+struct drift_test_result {
+  SUSCOUNT period;
+  SUSCOUNT updates;
+  SUFLOAT  rms_error;
+  SUFLOAT  max_error;
+  SUDOUBLE cpu_time;
+};
+
+SUPRIVATE SUFLOAT
+drift_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+/* Doppler ramp, with its phase integrated in double precision */
+SUPRIVATE SUCOMPLEX *
+drift_test_make_signal(SUSCOUNT count)
+{
+  SUCOMPLEX *x = NULL;
+  SUDOUBLE phase = 0, t;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i) {
+    t = i / TEST_SAMP_RATE;
+    x[i] = SU_C_EXP(I * (SUFLOAT) phase)
+      + TEST_NOISE_STDDEV * (drift_test_randn() + I * drift_test_randn());
+    phase += 2 * M_PI * (TEST_F0 + TEST_RATE * t) / TEST_SAMP_RATE;
+    phase = fmod(phase, 2 * M_PI);
+  }
+
+  return x;
+}
+
+SUPRIVATE SUDOUBLE
+drift_test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+SUPRIVATE SUBOOL
+drift_test_run(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    SUBOOL decimate,
+    struct drift_test_result *result)
+{
+  struct suscan_inspector_sampling_info sinfo;
+  struct suscan_mq mq;
+  SUBOOL mq_init = SU_FALSE;
+  suscan_inspector_t *insp = NULL;
+  suscan_config_t *config = NULL;
+  struct suscan_field_value *value;
+  const SUCOMPLEX *out;
+  SUSCOUNT i = 0, j, len, period;
+  SUSDIFF got;
+  SUDOUBLE t, err, sqerr = 0, start;
+  SUSCOUNT n = 0, updates = 0;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&sinfo, 0, sizeof(struct suscan_inspector_sampling_info));
+  memset(result, 0, sizeof(struct drift_test_result));
+
+  sinfo.equiv_fs   = TEST_SAMP_RATE;
+  sinfo.bw         = TEST_BANDWIDTH;
+  sinfo.bw_bd      = TEST_BANDWIDTH;
+  sinfo.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  SU_TRY(insp = suscan_inspector_new(NULL, "drift", &sinfo, &mq, &mq, NULL));
+
+  SU_TRY(config = suscan_inspector_create_config(insp));
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(suscan_config_set_bool(config, "drift.decimate", decimate));
+  SU_TRY(suscan_inspector_set_config(insp, config));
+  suscan_inspector_assert_params(insp);
+
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(value = suscan_config_get_value(config, "drift.feedback-samples"));
+  period = value->as_int;
+  SU_TRY(period > 0);
+
+  start = drift_test_now();
+
+  while (i < count) {
+    len = SU_MIN(TEST_BLOCK_SIZE, count - i);
+    SU_TRY((got = suscan_inspector_feed_bulk(insp, x + i, len)) >= 0);
+
+    out = suscan_inspector_get_output_buffer(insp);
+
+    /* Update k is pushed after (k + 1) * period input samples */
+    for (j = 0; j < suscan_inspector_get_output_length(insp); ++j) {
+      t = (++updates * period - 1) / TEST_SAMP_RATE;
+      if (t < TEST_SETTLE_TIME)
+        continue;
+
+      err = SU_ABS(SU_C_REAL(out[j]) - (TEST_F0 + TEST_RATE * t));
+      sqerr += err * err;
+      if (err > result->max_error)
+        result->max_error = err;
+      ++n;
+    }
+
+    insp->sampler_ptr = 0;
+    i += got;
+  }
+
+  result->cpu_time      = drift_test_now() - start;
+  result->period = period;
+  result->updates       = n;
+  SU_TRY(n > 0);
+
+  result->rms_error = SU_SQRT(sqerr / n);
+
+  ok = SU_TRUE;
+
+done:
+  if (config != NULL)
+    suscan_config_destroy(config);
+
+  if (insp != NULL)
+    suscan_inspector_destroy(insp);
+
+  if (mq_init)
+    suscan_mq_finalize(&mq);
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct drift_test_result full, decim;
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUCOMPLEX *x = NULL;
+  int code = EXIT_FAILURE;
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_estimators());
+  SU_TRY(suscan_init_spectsrcs());
+  SU_TRY(suscan_init_inspectors());
+
+  SU_TRY(x = drift_test_make_signal(count));
+
+  SU_TRY(drift_test_run(x, count, SU_FALSE, &full));
+  SU_TRY(drift_test_run(x, count, SU_TRUE, &decim));
+
+  printf("Loop        Updates  Period  RMS error  Max error  CPU time\n");
+  printf(
+    "full-rate   %7lu  %6lu  %7.2f Hz %7.2f Hz %7.3f s\n",
+    (unsigned long) full.updates,
+    (unsigned long) full.period,
+    full.rms_error,
+    full.max_error,
+    full.cpu_time);
+  printf(
+    "decimated   %7lu  %6lu  %7.2f Hz %7.2f Hz %7.3f s\n",
+    (unsigned long) decim.updates,
+    (unsigned long) decim.period,
+    decim.rms_error,
+    decim.max_error,
+    decim.cpu_time);
+  printf("Speedup: %.2fx\n", full.cpu_time / decim.cpu_time);
+
+  if (full.rms_error > TEST_MAX_RMS_ERR) {
+    fprintf(stderr, "Full-rate loop does not track the ramp\n");
+    goto done;
+  }
+
+  if (decim.rms_error > TEST_MAX_RMS_ERR
+      || decim.rms_error > full.rms_error + TEST_MAX_EXCESS) {
+    fprintf(stderr, "Decimated loop tracks worse than the full-rate loop\n");
+    goto done;
+  }
+
+  code = EXIT_SUCCESS;
+
+done:
+  if (x != NULL)
+    free(x);
+
+  return code;
+}
@@ -0,0 +1,355 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * Audio inspector FM benchmark: a noisy FM tone is demodulated both by
+ * the audio inspector, whose discriminator runs as a block kernel (VOLK,
+ * when available), and by a copy of its former per-sample loop built from
+ * the same sigutils blocks. CPU times are compared, and the audio of both
+ * paths must match up to the accuracy of the vector atan2.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <sigutils/sigutils.h>
+#include <sigutils/iir.h>
+#include <sigutils/sampling.h>
+
+#include <suscan.h>
+#include <analyzer/mq.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/inspector/params.h>
+
+#define TEST_SAMP_RATE    250000.   /* Channel rate (Hz) */
+#define TEST_BANDWIDTH    .8        /* Normalized channel bandwidth */
+#define TEST_DURATION     20.       /* Seconds */
+#define TEST_AUDIO_RATE   48000     /* Audio sample rate (Hz) */
+#define TEST_CUTOFF       15000.    /* Audio cutoff (Hz) */
+#define TEST_TONE         1000.     /* Modulating tone (Hz) */
+#define TEST_DEVIATION    25000.    /* Peak deviation (Hz) */
+#define TEST_NOISE_STDDEV .1        /* Per component */
+#define TEST_MAX_ERROR    1e-3      /* Max audio difference */
+#define TEST_BLOCK_SIZE   4096
+
+struct fm_test_result {
+  SUCOMPLEX *audio;
+  SUSCOUNT   count;
+  SUSCOUNT   alloc;
+  SUDOUBLE   cpu_time;
+};
+
+SUPRIVATE SUFLOAT
+fm_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+SUPRIVATE SUCOMPLEX *
+fm_test_make_signal(SUSCOUNT count)
+{
+  SUCOMPLEX *x = NULL;
+  SUDOUBLE phase = 0, t;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i) {
+    t = i / TEST_SAMP_RATE;
+    x[i] = SU_C_EXP(I * (SUFLOAT) phase)
+      + TEST_NOISE_STDDEV * (fm_test_randn() + I * fm_test_randn());
+    phase += 2 * M_PI * TEST_DEVIATION * sin(2 * M_PI * TEST_TONE * t)
+      / TEST_SAMP_RATE;
+    phase = fmod(phase, 2 * M_PI);
+  }
+
+  return x;
+}
+
+SUPRIVATE SUDOUBLE
+fm_test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+SUPRIVATE SUBOOL
+fm_test_result_init(struct fm_test_result *self, SUSCOUNT count)
+{
+  memset(self, 0, sizeof(struct fm_test_result));
+
+  /* Room for every audio sample, plus sampler rounding */
+  self->alloc = count * TEST_AUDIO_RATE / TEST_SAMP_RATE + 2;
+  SU_ALLOCATE_MANY_CATCH(self->audio, self->alloc, SUCOMPLEX, return SU_FALSE);
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+fm_test_result_push(
+    struct fm_test_result *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SU_TRYCATCH(self->count + count <= self->alloc, return SU_FALSE);
+
+  memcpy(self->audio + self->count, x, count * sizeof(SUCOMPLEX));
+  self->count += count;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+fm_test_result_finalize(struct fm_test_result *self)
+{
+  if (self->audio != NULL)
+    free(self->audio);
+
+  memset(self, 0, sizeof(struct fm_test_result));
+}
+
+/* The former per-sample FM path of the audio inspector */
+SUPRIVATE SUBOOL
+fm_test_run_ref(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    const suscan_config_t *config,
+    struct fm_test_result *result)
+{
+  su_iir_filt_t filt = su_iir_filt_INITIALIZER;
+  su_sampler_t sampler;
+  SUBOOL filt_init = SU_FALSE;
+  SUBOOL sampler_init = SU_FALSE;
+  struct suscan_field_value *value;
+  SUCOMPLEX last = 0, det_x, output;
+  SUFLOAT gain, volume;
+  SUDOUBLE start;
+  SUSCOUNT i;
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(value = suscan_config_get_value(config, "agc.gain"));
+  gain = SU_MAG_RAW(value->as_float);
+
+  SU_TRY(value = suscan_config_get_value(config, "audio.volume"));
+  volume = value->as_float;
+
+  SU_TRY(
+      su_iir_bwlpf_init(
+        &filt,
+        5,
+        SU_ABS2NORM_FREQ(TEST_SAMP_RATE, TEST_CUTOFF)));
+  filt_init = SU_TRUE;
+
+  SU_TRY(
+      su_sampler_init(
+        &sampler,
+        SU_ABS2NORM_BAUD(TEST_SAMP_RATE, TEST_AUDIO_RATE)));
+  sampler_init = SU_TRUE;
+
+  start = fm_test_now();
+
+  for (i = 0; i < count; ++i) {
+    det_x = SU_C_VALID(x[i]) ? x[i] : 0;
+    det_x = 2 * gain * det_x;
+
+    output = SU_C_ARG(det_x * SU_C_CONJ(last)) / M_PI;
+    last   = det_x;
+
+    output *= volume;
+    output = su_iir_filt_feed(&filt, output);
+
+    if (su_sampler_feed(&sampler, &output)) {
+      output *= .75;
+      SU_TRY(fm_test_result_push(result, &output, 1));
+    }
+  }
+
+  result->cpu_time = fm_test_now() - start;
+
+  ok = SU_TRUE;
+
+done:
+  if (filt_init)
+    su_iir_filt_finalize(&filt);
+
+  if (sampler_init)
+    su_sampler_finalize(&sampler);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+fm_test_run(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    struct fm_test_result *block,
+    struct fm_test_result *ref)
+{
+  struct suscan_inspector_sampling_info sinfo;
+  struct suscan_mq mq;
+  SUBOOL mq_init = SU_FALSE;
+  suscan_inspector_t *insp = NULL;
+  suscan_config_t *config = NULL;
+  SUSCOUNT i = 0, len;
+  SUSDIFF got;
+  SUDOUBLE start;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&sinfo, 0, sizeof(struct suscan_inspector_sampling_info));
+
+  sinfo.equiv_fs   = TEST_SAMP_RATE;
+  sinfo.bw         = TEST_BANDWIDTH;
+  sinfo.bw_bd      = TEST_BANDWIDTH;
+  sinfo.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  SU_TRY(insp = suscan_inspector_new(NULL, "audio", &sinfo, &mq, &mq, NULL));
+
+  SU_TRY(config = suscan_inspector_create_config(insp));
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(suscan_config_set_bool(config, "agc.enabled", SU_FALSE));
+  SU_TRY(suscan_config_set_float(config, "agc.gain", 0));
+  SU_TRY(suscan_config_set_float(config, "audio.volume", 1));
+  SU_TRY(suscan_config_set_float(config, "audio.cutoff", TEST_CUTOFF));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "audio.sample-rate",
+        TEST_AUDIO_RATE));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "audio.demodulator",
+        SUSCAN_INSPECTOR_AUDIO_DEMOD_FM));
+  SU_TRY(suscan_config_set_bool(config, "audio.squelch", SU_FALSE));
+  SU_TRY(suscan_inspector_set_config(insp, config));
+  suscan_inspector_assert_params(insp);
+
+  start = fm_test_now();
+
+  while (i < count) {
+    len = SU_MIN(TEST_BLOCK_SIZE, count - i);
+    SU_TRY((got = suscan_inspector_feed_bulk(insp, x + i, len)) >= 0);
+
+    SU_TRY(
+        fm_test_result_push(
+          block,
+          suscan_inspector_get_output_buffer(insp),
+          suscan_inspector_get_output_length(insp)));
+
+    insp->sampler_ptr = 0;
+    i += got;
+  }
+
+  block->cpu_time = fm_test_now() - start;
+
+  SU_TRY(fm_test_run_ref(x, count, config, ref));
+
+  ok = SU_TRUE;
+
+done:
+  if (config != NULL)
+    suscan_config_destroy(config);
+
+  if (insp != NULL)
+    suscan_inspector_destroy(insp);
+
+  if (mq_init)
+    suscan_mq_finalize(&mq);
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct fm_test_result block, ref;
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUCOMPLEX *x = NULL;
+  SUFLOAT err, max_err = 0;
+  SUSCOUNT i;
+  int code = EXIT_FAILURE;
+
+  memset(&block, 0, sizeof(struct fm_test_result));
+  memset(&ref, 0, sizeof(struct fm_test_result));
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_estimators());
+  SU_TRY(suscan_init_spectsrcs());
+  SU_TRY(suscan_init_inspectors());
+
+  SU_TRY(x = fm_test_make_signal(count));
+  SU_TRY(fm_test_result_init(&block, count));
+  SU_TRY(fm_test_result_init(&ref, count));
+
+  SU_TRY(fm_test_run(x, count, &block, &ref));
+
+  for (i = 0; i < SU_MIN(block.count, ref.count); ++i) {
+    err = SU_C_ABS(block.audio[i] - ref.audio[i]);
+    if (err > max_err)
+      max_err = err;
+  }
+
+  printf("Path        Samples  CPU time\n");
+  printf(
+    "per-sample  %7lu  %7.3f s\n",
+    (unsigned long) ref.count,
+    ref.cpu_time);
+  printf(
+    "block       %7lu  %7.3f s\n",
+    (unsigned long) block.count,
+    block.cpu_time);
+  printf("Speedup: %.2fx, max difference: %g\n",
+    ref.cpu_time / block.cpu_time,
+    max_err);
+
+  if (block.count == 0 || block.count != ref.count) {
+    fprintf(stderr, "Block and per-sample paths yield different lengths\n");
+    goto done;
+  }
+
+  if (max_err > TEST_MAX_ERROR) {
+    fprintf(stderr, "Block FM audio differs from the per-sample path\n");
+    goto done;
+  }
+
+  code = EXIT_SUCCESS;
+
+done:
+  fm_test_result_finalize(&block);
+  fm_test_result_finalize(&ref);
+
+  if (x != NULL)
+    free(x);
+
+  return code;
+}
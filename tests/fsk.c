@@ -0,0 +1,485 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * FSK inspector block pipeline test: a noisy 2-FSK signal is demodulated
+ * both by the inspector and by a copy of its former per-sample loop, built
+ * from the same sigutils blocks. Symbols must be bit-identical, with the
+ * fixed-rate sampler and with Gardner clock recovery. CPU times of both
+ * paths are reported.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <sigutils/sigutils.h>
+#include <sigutils/iir.h>
+#include <sigutils/clock.h>
+#include <sigutils/sampling.h>
+#include <sigutils/ncqo.h>
+
+#include <suscan.h>
+#include <analyzer/mq.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/inspector/params.h>
+
+#define TEST_SAMP_RATE    250000.   /* Channel rate (Hz) */
+#define TEST_BANDWIDTH    .2        /* Normalized channel bandwidth */
+#define TEST_DURATION     10.       /* Seconds */
+#define TEST_BAUD         10000.    /* Symbol rate (baud) */
+#define TEST_DEVIATION    5000.     /* Tone offset (Hz) */
+#define TEST_NOISE_STDDEV .1        /* Per component */
+#define TEST_BLOCK_SIZE   4096
+#define TEST_MF_MAX_SPAN  1024      /* As in the FSK inspector */
+
+struct fsk_test_case {
+  const char *name;
+  SUBOOL gardner;
+  SUBOOL quad_demod;
+  SUBOOL mf;
+};
+
+struct fsk_test_result {
+  SUCOMPLEX *symbols;
+  SUSCOUNT   count;
+  SUSCOUNT   alloc;
+  SUDOUBLE   cpu_time;
+};
+
+/* Per-sample FSK demodulator, as the inspector used to run it */
+struct fsk_test_ref {
+  SUBOOL              gardner;
+  SUBOOL              quad_demod;
+  SUBOOL              mf_enabled;
+  SUFLOAT             gain;
+  su_iir_filt_t       mf;
+  su_clock_detector_t cd;
+  su_sampler_t        sampler;
+  su_ncqo_t           lo;
+  SUCOMPLEX           phase;
+  SUCOMPLEX           last;
+};
+
+SUPRIVATE SUFLOAT
+fsk_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+SUPRIVATE SUCOMPLEX *
+fsk_test_make_signal(SUSCOUNT count)
+{
+  SUCOMPLEX *x = NULL;
+  SUDOUBLE phase = 0, tone = TEST_DEVIATION;
+  SUDOUBLE sym_time = 0;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i) {
+    sym_time += TEST_BAUD / TEST_SAMP_RATE;
+    if (sym_time >= 1) {
+      sym_time -= 1;
+      tone = (rand() & 1) ? TEST_DEVIATION : -TEST_DEVIATION;
+    }
+
+    x[i] = SU_C_EXP(I * (SUFLOAT) phase)
+      + TEST_NOISE_STDDEV * (fsk_test_randn() + I * fsk_test_randn());
+    phase += 2 * M_PI * tone / TEST_SAMP_RATE;
+    phase = fmod(phase, 2 * M_PI);
+  }
+
+  return x;
+}
+
+SUPRIVATE SUDOUBLE
+fsk_test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+SUPRIVATE SUBOOL
+fsk_test_result_push(
+    struct fsk_test_result *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT count)
+{
+  SUCOMPLEX *tmp;
+  SUSCOUNT alloc = self->alloc;
+
+  if (self->count + count > alloc) {
+    if (alloc == 0)
+      alloc = TEST_BLOCK_SIZE;
+
+    while (self->count + count > alloc)
+      alloc <<= 1;
+
+    SU_TRYCATCH(
+        tmp = realloc(self->symbols, alloc * sizeof(SUCOMPLEX)),
+        return SU_FALSE);
+
+    self->symbols = tmp;
+    self->alloc   = alloc;
+  }
+
+  memcpy(self->symbols + self->count, x, count * sizeof(SUCOMPLEX));
+  self->count += count;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE void
+fsk_test_result_finalize(struct fsk_test_result *self)
+{
+  if (self->symbols != NULL)
+    free(self->symbols);
+
+  memset(self, 0, sizeof(struct fsk_test_result));
+}
+
+SUPRIVATE SUBOOL
+fsk_test_configure(
+    suscan_inspector_t *insp,
+    suscan_config_t *config,
+    const struct fsk_test_case *test)
+{
+  SUBOOL ok = SU_FALSE;
+
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(suscan_config_set_bool(config, "agc.enabled", SU_FALSE));
+  SU_TRY(suscan_config_set_float(config, "agc.gain", 0));
+  SU_TRY(suscan_config_set_integer(
+      config,
+      "clock.type",
+      test->gardner
+        ? SUSCAN_INSPECTOR_BAUDRATE_CONTROL_GARDNER
+        : SUSCAN_INSPECTOR_BAUDRATE_CONTROL_MANUAL));
+  SU_TRY(suscan_config_set_float(config, "clock.baud", TEST_BAUD));
+  SU_TRY(suscan_config_set_bool(config, "clock.running", SU_TRUE));
+  SU_TRY(suscan_config_set_integer(
+      config,
+      "mf.type",
+      test->mf
+        ? SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL
+        : SUSCAN_INSPECTOR_MATCHED_FILTER_BYPASS));
+  SU_TRY(suscan_config_set_bool(config, "fsk.quad-demod", test->quad_demod));
+  SU_TRY(suscan_config_set_float(config, "fsk.phase", 0));
+  SU_TRY(suscan_inspector_set_config(insp, config));
+  suscan_inspector_assert_params(insp);
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+fsk_test_ref_init(
+    struct fsk_test_ref *self,
+    const suscan_config_t *config,
+    const struct fsk_test_case *test)
+{
+  struct suscan_field_value *value;
+  SUFLOAT sym_period;
+  SUFLOAT rolloff;
+  SUSCOUNT span;
+  SUBOOL ok = SU_FALSE;
+
+  memset(self, 0, sizeof(struct fsk_test_ref));
+
+  self->gardner    = test->gardner;
+  self->quad_demod = test->quad_demod;
+  self->mf_enabled = test->mf;
+
+  SU_TRY(value = suscan_config_get_value(config, "agc.gain"));
+  self->gain = SU_MAG_RAW(value->as_float);
+
+  /*
+   * Same construction and configuration order as the inspector, with the
+   * values parsed from the very configuration it was given.
+   */
+  SU_TRY(
+      su_clock_detector_init(
+          &self->cd,
+          1.,
+          .5 * TEST_BANDWIDTH,
+          32));
+  SU_TRY(su_sampler_init(&self->sampler, 0));
+  su_ncqo_init(&self->lo, 0);
+
+  su_clock_detector_set_baud(
+      &self->cd,
+      SU_ABS2NORM_BAUD(TEST_SAMP_RATE, TEST_BAUD));
+  su_sampler_set_rate(
+      &self->sampler,
+      SU_ABS2NORM_BAUD(TEST_SAMP_RATE, TEST_BAUD));
+
+  SU_TRY(value = suscan_config_get_value(config, "clock.phase"));
+  su_sampler_set_phase_addend(&self->sampler, value->as_float);
+  sym_period = su_sampler_get_period(&self->sampler);
+
+  SU_TRY(value = suscan_config_get_value(config, "clock.gain"));
+  self->cd.alpha = SU_MAG_RAW(value->as_float);
+  self->cd.beta  = SU_PREFERED_CLOCK_BETA;
+
+  SU_TRY(value = suscan_config_get_value(config, "fsk.phase"));
+  self->phase = SU_C_EXP(I * value->as_float);
+
+  SU_TRY(value = suscan_config_get_value(config, "mf.roll-off"));
+  rolloff = value->as_float;
+
+  span = 6 * sym_period;
+  if (span > TEST_MF_MAX_SPAN)
+    span = TEST_MF_MAX_SPAN;
+
+  SU_TRY(su_iir_rrc_init(&self->mf, SU_CEIL(span), SU_CEIL(sym_period), rolloff));
+
+  ok = SU_TRUE;
+
+done:
+  return ok;
+}
+
+SUPRIVATE void
+fsk_test_ref_finalize(struct fsk_test_ref *self)
+{
+  su_iir_filt_finalize(&self->mf);
+  su_clock_detector_finalize(&self->cd);
+  su_sampler_finalize(&self->sampler);
+}
+
+SUPRIVATE SUBOOL
+fsk_test_run_ref(
+    struct fsk_test_ref *self,
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    struct fsk_test_result *result)
+{
+  SUSCOUNT i;
+  SUCOMPLEX const_gain, det_x, output;
+  SUCOMPLEX last = self->last;
+  SUBOOL new_sample;
+  SUDOUBLE start;
+
+  start = fsk_test_now();
+
+  for (i = 0; i < count; ++i) {
+    det_x = x[i] * SU_C_CONJ(su_ncqo_read(&self->lo));
+    const_gain = 2 * self->gain * det_x;
+
+    if (self->quad_demod)
+      det_x = const_gain * SU_C_CONJ(last);
+    else
+      det_x = (const_gain * SU_C_CONJ(last)) /
+      (.5 * (const_gain * SU_C_CONJ(const_gain) + last * SU_C_CONJ(last)) + 1e-8);
+
+    last = const_gain;
+
+    if (self->mf_enabled)
+      det_x = su_iir_filt_feed(&self->mf, det_x);
+
+    if (!self->gardner) {
+      output = det_x;
+      new_sample = su_sampler_feed(&self->sampler, &output);
+    } else {
+      su_clock_detector_feed(&self->cd, det_x);
+      new_sample = su_clock_detector_read(&self->cd, &output, 1) == 1;
+    }
+
+    if (new_sample) {
+      output = output * .75 * self->phase;
+      SU_TRYCATCH(fsk_test_result_push(result, &output, 1), return SU_FALSE);
+    }
+  }
+
+  self->last = last;
+
+  result->cpu_time = fsk_test_now() - start;
+
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+fsk_test_run(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    const struct fsk_test_case *test,
+    struct fsk_test_result *block,
+    struct fsk_test_result *ref)
+{
+  struct suscan_inspector_sampling_info sinfo;
+  struct suscan_mq mq;
+  struct fsk_test_ref demod;
+  SUBOOL mq_init = SU_FALSE;
+  SUBOOL ref_init = SU_FALSE;
+  suscan_inspector_t *insp = NULL;
+  suscan_config_t *config = NULL;
+  SUSCOUNT i = 0, len;
+  SUSDIFF got;
+  SUDOUBLE start;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&sinfo, 0, sizeof(struct suscan_inspector_sampling_info));
+
+  sinfo.equiv_fs   = TEST_SAMP_RATE;
+  sinfo.bw         = TEST_BANDWIDTH;
+  sinfo.bw_bd      = TEST_BANDWIDTH;
+  sinfo.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  SU_TRY(insp = suscan_inspector_new(NULL, "fsk", &sinfo, &mq, &mq, NULL));
+  SU_TRY(config = suscan_inspector_create_config(insp));
+  SU_TRY(fsk_test_configure(insp, config, test));
+
+  SU_TRY(fsk_test_ref_init(&demod, config, test));
+  ref_init = SU_TRUE;
+
+  start = fsk_test_now();
+
+  while (i < count) {
+    len = SU_MIN(TEST_BLOCK_SIZE, count - i);
+    SU_TRY((got = suscan_inspector_feed_bulk(insp, x + i, len)) >= 0);
+
+    SU_TRY(
+        fsk_test_result_push(
+          block,
+          suscan_inspector_get_output_buffer(insp),
+          suscan_inspector_get_output_length(insp)));
+
+    insp->sampler_ptr = 0;
+    i += got;
+  }
+
+  block->cpu_time = fsk_test_now() - start;
+
+  SU_TRY(fsk_test_run_ref(&demod, x, count, ref));
+
+  ok = SU_TRUE;
+
+done:
+  if (ref_init)
+    fsk_test_ref_finalize(&demod);
+
+  if (config != NULL)
+    suscan_config_destroy(config);
+
+  if (insp != NULL)
+    suscan_inspector_destroy(insp);
+
+  if (mq_init)
+    suscan_mq_finalize(&mq);
+
+  return ok;
+}
+
+SUPRIVATE SUSCOUNT
+fsk_test_mismatches(
+    const struct fsk_test_result *a,
+    const struct fsk_test_result *b)
+{
+  SUSCOUNT i, n = 0;
+  SUSCOUNT count = SU_MIN(a->count, b->count);
+
+  for (i = 0; i < count; ++i)
+    if (SU_C_REAL(a->symbols[i]) != SU_C_REAL(b->symbols[i])
+        || SU_C_IMAG(a->symbols[i]) != SU_C_IMAG(b->symbols[i]))
+      ++n;
+
+  return n + (a->count > b->count ? a->count - b->count : b->count - a->count);
+}
+
+int
+main(int argc, char **argv)
+{
+  static const struct fsk_test_case tests[] = {
+    {"sampler",  SU_FALSE, SU_FALSE, SU_FALSE},
+    {"gardner",  SU_TRUE,  SU_TRUE,  SU_TRUE}
+  };
+  struct fsk_test_result block, ref;
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUSCOUNT mismatches;
+  SUCOMPLEX *x = NULL;
+  unsigned int i;
+  SUBOOL failed = SU_FALSE;
+  int code = EXIT_FAILURE;
+
+  memset(&block, 0, sizeof(struct fsk_test_result));
+  memset(&ref, 0, sizeof(struct fsk_test_result));
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_estimators());
+  SU_TRY(suscan_init_spectsrcs());
+  SU_TRY(suscan_init_inspectors());
+
+  SU_TRY(x = fsk_test_make_signal(count));
+
+  printf("Clock       Symbols  Mismatches  Per-sample  Block     Speedup\n");
+
+  for (i = 0; i < sizeof(tests) / sizeof(tests[0]); ++i) {
+    SU_TRY(fsk_test_run(x, count, tests + i, &block, &ref));
+
+    mismatches = fsk_test_mismatches(&block, &ref);
+
+    printf(
+      "%-10s  %7lu  %10lu  %8.3f s  %7.3f s  %5.2fx\n",
+      tests[i].name,
+      (unsigned long) block.count,
+      (unsigned long) mismatches,
+      ref.cpu_time,
+      block.cpu_time,
+      ref.cpu_time / block.cpu_time);
+
+    if (block.count == 0 || mismatches > 0) {
+      fprintf(
+        stderr,
+        "%s: block output differs from the per-sample loop\n",
+        tests[i].name);
+      failed = SU_TRUE;
+    }
+
+    fsk_test_result_finalize(&block);
+    fsk_test_result_finalize(&ref);
+  }
+
+  if (!failed)
+    code = EXIT_SUCCESS;
+
+done:
+  fsk_test_result_finalize(&block);
+  fsk_test_result_finalize(&ref);
+
+  if (x != NULL)
+    free(x);
+
+  return code;
+}
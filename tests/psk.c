@@ -0,0 +1,366 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * PSK inspector throughput benchmark: a noisy QPSK signal is received by
+ * the PSK inspector (Costas loop, matched filter and Gardner clock
+ * recovery) at several baud rates. Low baud rates mean long matched
+ * filters, which the inspector evaluates through FFTs. For every rate,
+ * the matched filter alone is also timed in direct form and, where the
+ * inspector would use it, through FFTs, and both outputs must match.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <sigutils/sigutils.h>
+#include <sigutils/iir.h>
+#include <sigutils/taps.h>
+
+#include <suscan.h>
+#include <analyzer/mq.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/inspector/params.h>
+#include <analyzer/inspector/fastconv.h>
+
+#define TEST_SAMP_RATE      250000.   /* Channel rate (Hz) */
+#define TEST_BANDWIDTH      .8        /* Normalized channel bandwidth */
+#define TEST_DURATION       10.       /* Seconds */
+#define TEST_NOISE_STDDEV   .1        /* Per component */
+#define TEST_ROLL_OFF       .35       /* Matched filter roll-off */
+#define TEST_MAX_ERROR      1e-3      /* Max MF difference, relative */
+#define TEST_MAX_RATE_ERROR .05       /* Max symbol count deviation */
+#define TEST_BLOCK_SIZE     4096
+#define TEST_MF_BLOCK_SIZE  1024      /* As SUSCAN_PSK_INSPECTOR_BLOCK_SIZE */
+#define TEST_FAST_MF_MIN_SPAN 128     /* As SUSCAN_PSK_INSPECTOR_FAST_MF_MIN_SPAN */
+#define TEST_MAX_MF_SPAN    1024      /* As SUSCAN_PSK_INSPECTOR_MAX_MF_SPAN */
+
+SUPRIVATE const SUFLOAT g_test_bauds[] = {1200, 4800, 9600, 19200, 62500};
+
+struct psk_test_result {
+  SUFLOAT  baud;
+  SUSCOUNT span;
+  SUSCOUNT symbols;
+  SUDOUBLE insp_time;
+  SUDOUBLE direct_time;
+  SUDOUBLE fast_time;   /* Negative if the inspector filters directly */
+  SUFLOAT  mf_error;
+};
+
+SUPRIVATE SUFLOAT
+psk_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+SUPRIVATE SUDOUBLE
+psk_test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* Rectangular QPSK symbols, plus noise */
+SUPRIVATE SUCOMPLEX *
+psk_test_make_signal(SUSCOUNT count, SUFLOAT baud)
+{
+  SUCOMPLEX *x = NULL;
+  SUCOMPLEX symbol = 0;
+  SUDOUBLE clock = 1;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i) {
+    clock += baud / TEST_SAMP_RATE;
+    if (clock >= 1) {
+      clock -= 1;
+      symbol = SU_C_EXP(I * (SUFLOAT) (M_PI / 4 + M_PI / 2 * (rand() & 3)));
+    }
+
+    x[i] = symbol
+      + TEST_NOISE_STDDEV * (psk_test_randn() + I * psk_test_randn());
+  }
+
+  return x;
+}
+
+SUPRIVATE SUBOOL
+psk_test_run_inspector(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    struct psk_test_result *result)
+{
+  struct suscan_inspector_sampling_info sinfo;
+  struct suscan_mq mq;
+  SUBOOL mq_init = SU_FALSE;
+  suscan_inspector_t *insp = NULL;
+  suscan_config_t *config = NULL;
+  SUSCOUNT i = 0, len;
+  SUSDIFF got;
+  SUDOUBLE start;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&sinfo, 0, sizeof(struct suscan_inspector_sampling_info));
+
+  sinfo.equiv_fs   = TEST_SAMP_RATE;
+  sinfo.bw         = TEST_BANDWIDTH;
+  sinfo.bw_bd      = TEST_BANDWIDTH;
+  sinfo.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  SU_TRY(insp = suscan_inspector_new(NULL, "psk", &sinfo, &mq, &mq, NULL));
+
+  SU_TRY(config = suscan_inspector_create_config(insp));
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "afc.costas-order",
+        SUSCAN_INSPECTOR_CARRIER_CONTROL_COSTAS_4));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "mf.type",
+        SUSCAN_INSPECTOR_MATCHED_FILTER_MANUAL));
+  SU_TRY(suscan_config_set_float(config, "mf.roll-off", TEST_ROLL_OFF));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "clock.type",
+        SUSCAN_INSPECTOR_BAUDRATE_CONTROL_GARDNER));
+  SU_TRY(suscan_config_set_float(config, "clock.baud", result->baud));
+  SU_TRY(suscan_config_set_bool(config, "clock.running", SU_TRUE));
+  SU_TRY(suscan_inspector_set_config(insp, config));
+  suscan_inspector_assert_params(insp);
+
+  start = psk_test_now();
+
+  while (i < count) {
+    len = SU_MIN(TEST_BLOCK_SIZE, count - i);
+    SU_TRY((got = suscan_inspector_feed_bulk(insp, x + i, len)) >= 0);
+
+    result->symbols += suscan_inspector_get_output_length(insp);
+
+    insp->sampler_ptr = 0;
+    i += got;
+  }
+
+  result->insp_time = psk_test_now() - start;
+
+  ok = SU_TRUE;
+
+done:
+  if (config != NULL)
+    suscan_config_destroy(config);
+
+  if (insp != NULL)
+    suscan_inspector_destroy(insp);
+
+  if (mq_init)
+    suscan_mq_finalize(&mq);
+
+  return ok;
+}
+
+/* The inspector's matched filter alone, in direct form and through FFTs */
+SUPRIVATE SUBOOL
+psk_test_run_mf(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    struct psk_test_result *result)
+{
+  su_iir_filt_t mf = su_iir_filt_INITIALIZER;
+  suscan_fastconv_t *fast_mf = NULL;
+  SUBOOL mf_init = SU_FALSE;
+  SUCOMPLEX *direct = NULL;
+  SUCOMPLEX *fast = NULL;
+  SUFLOAT *taps = NULL;
+  SUFLOAT period, peak = 0, err;
+  SUSCOUNT i, len;
+  SUDOUBLE start;
+  SUBOOL ok = SU_FALSE;
+
+  period = TEST_SAMP_RATE / result->baud;
+  result->span = SU_MIN(SU_CEIL(6 * period), TEST_MAX_MF_SPAN);
+  result->fast_time = -1;
+
+  SU_ALLOCATE_MANY(direct, count, SUCOMPLEX);
+
+  SU_TRY(su_iir_rrc_init(&mf, result->span, SU_CEIL(period), TEST_ROLL_OFF));
+  mf_init = SU_TRUE;
+
+  start = psk_test_now();
+  for (i = 0; i < count; i += len) {
+    len = SU_MIN(TEST_MF_BLOCK_SIZE, count - i);
+    su_iir_filt_feed_bulk(&mf, x + i, direct + i, len);
+  }
+  result->direct_time = psk_test_now() - start;
+
+  if (result->span >= TEST_FAST_MF_MIN_SPAN) {
+    SU_ALLOCATE_MANY(fast, count, SUCOMPLEX);
+    SU_ALLOCATE_MANY(taps, result->span, SUFLOAT);
+
+    su_taps_rrc_init(taps, SU_CEIL(period), TEST_ROLL_OFF, result->span);
+    SU_TRY(
+        fast_mf = suscan_fastconv_new(
+          taps,
+          result->span,
+          TEST_MF_BLOCK_SIZE));
+
+    start = psk_test_now();
+    for (i = 0; i < count; i += len) {
+      len = SU_MIN(TEST_MF_BLOCK_SIZE, count - i);
+      suscan_fastconv_feed(fast_mf, x + i, fast + i, len);
+    }
+    result->fast_time = psk_test_now() - start;
+
+    for (i = 0; i < count; ++i) {
+      if (SU_C_ABS(direct[i]) > peak)
+        peak = SU_C_ABS(direct[i]);
+
+      err = SU_C_ABS(direct[i] - fast[i]);
+      if (err > result->mf_error)
+        result->mf_error = err;
+    }
+
+    if (peak > 0)
+      result->mf_error /= peak;
+  }
+
+  ok = SU_TRUE;
+
+done:
+  if (mf_init)
+    su_iir_filt_finalize(&mf);
+
+  if (fast_mf != NULL)
+    suscan_fastconv_destroy(fast_mf);
+
+  if (taps != NULL)
+    free(taps);
+
+  if (fast != NULL)
+    free(fast);
+
+  if (direct != NULL)
+    free(direct);
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+psk_test_run(SUFLOAT baud, struct psk_test_result *result)
+{
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUCOMPLEX *x = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  memset(result, 0, sizeof(struct psk_test_result));
+  result->baud = baud;
+
+  SU_TRY(x = psk_test_make_signal(count, baud));
+  SU_TRY(psk_test_run_inspector(x, count, result));
+  SU_TRY(psk_test_run_mf(x, count, result));
+
+  ok = SU_TRUE;
+
+done:
+  if (x != NULL)
+    free(x);
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct psk_test_result result;
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUFLOAT expected;
+  unsigned int i;
+  SUBOOL failed = SU_FALSE;
+  int code = EXIT_FAILURE;
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_estimators());
+  SU_TRY(suscan_init_spectsrcs());
+  SU_TRY(suscan_init_inspectors());
+
+  printf(
+    "   Baud  Span  Symbols  Inspector    Direct MF    FFT MF   MF error\n");
+
+  for (i = 0; i < sizeof(g_test_bauds) / sizeof(g_test_bauds[0]); ++i) {
+    SU_TRY(psk_test_run(g_test_bauds[i], &result));
+
+    printf(
+      "%7.0f  %4lu  %7lu  %6.2f Msps  %6.2f Msps",
+      result.baud,
+      (unsigned long) result.span,
+      (unsigned long) result.symbols,
+      1e-6 * count / result.insp_time,
+      1e-6 * count / result.direct_time);
+
+    if (result.fast_time > 0)
+      printf(
+        "  %6.2f Msps  %g\n",
+        1e-6 * count / result.fast_time,
+        result.mf_error);
+    else
+      printf("           -          -\n");
+
+    expected = TEST_DURATION * result.baud;
+    if (SU_ABS(result.symbols - expected) > TEST_MAX_RATE_ERROR * expected) {
+      fprintf(
+        stderr,
+        "%g baud: got %lu symbols, expected around %g\n",
+        result.baud,
+        (unsigned long) result.symbols,
+        expected);
+      failed = SU_TRUE;
+    }
+
+    if (result.mf_error > TEST_MAX_ERROR) {
+      fprintf(
+        stderr,
+        "%g baud: FFT matched filter differs from the direct form\n",
+        result.baud);
+      failed = SU_TRUE;
+    }
+  }
+
+  if (!failed)
+    code = EXIT_SUCCESS;
+
+done:
+  return code;
+}
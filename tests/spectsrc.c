@@ -0,0 +1,355 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * Spectrum source preprocessor benchmark: every spectrum source class with
+ * a preprocessor is fed the same noisy signal, buffer by buffer, and timed
+ * against a copy of its former per-sample loop. Outputs must match up to
+ * the accuracy of the vector kernels, including across buffer boundaries.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#include <sigutils/sigutils.h>
+
+#include <suscan.h>
+#include <analyzer/spectsrc.h>
+
+#define TEST_BUFFER_SIZE  8192
+#define TEST_BUFFERS      512
+#define TEST_NOISE_STDDEV .1        /* Per component */
+#define TEST_PHASE_STEP   .3        /* Max phase increment per sample */
+#define TEST_MAX_ERROR    1e-3      /* Max difference, relative to peak */
+
+/* Gains of the per-sample loops, as in spectsrcs/ */
+#define TEST_CYCLO_GAIN   1e6
+#define TEST_FM_GAIN      1e-5
+#define TEST_PM_GAIN      1e-5
+
+struct spectsrc_test_ref_state {
+  SUCOMPLEX prev;
+  SUFLOAT   pd_prev;
+};
+
+typedef void (*spectsrc_test_ref_func_t) (
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size);
+
+struct spectsrc_test_case {
+  const char *name;
+  spectsrc_test_ref_func_t ref;
+};
+
+struct spectsrc_test_result {
+  SUDOUBLE ref_time;
+  SUDOUBLE block_time;
+  SUFLOAT  error;
+};
+
+/************************** Former per-sample loops ***************************/
+SUPRIVATE void
+spectsrc_test_ref_cyclo(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    diff = buffer[i] * SU_C_CONJ(state->prev);
+    state->prev = buffer[i];
+    buffer[i] = TEST_CYCLO_GAIN * diff;
+  }
+}
+
+SUPRIVATE void
+spectsrc_test_ref_fmcyclo(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUFLOAT phase_diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    phase_diff = SU_C_ARG(buffer[i] * SU_C_CONJ(state->prev));
+    state->prev = buffer[i];
+    buffer[i] = TEST_FM_GAIN * SU_ABS(phase_diff - state->pd_prev);
+    state->pd_prev = phase_diff;
+  }
+}
+
+SUPRIVATE void
+spectsrc_test_ref_fmspect(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    diff = SU_C_ARG(buffer[i] * SU_C_CONJ(state->prev));
+    state->prev = buffer[i];
+    buffer[i] = TEST_FM_GAIN * diff;
+  }
+}
+
+SUPRIVATE void
+spectsrc_test_ref_pmspect(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i)
+    buffer[i] = TEST_PM_GAIN * SU_C_ARG(buffer[i]);
+}
+
+SUPRIVATE void
+spectsrc_test_ref_timediff(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    diff = buffer[i] - state->prev;
+    state->prev = buffer[i];
+    buffer[i] = diff;
+  }
+}
+
+SUPRIVATE void
+spectsrc_test_ref_abstimediff(
+    struct spectsrc_test_ref_state *state,
+    SUCOMPLEX *buffer,
+    SUSCOUNT size)
+{
+  SUCOMPLEX diff;
+  SUSCOUNT i;
+
+  for (i = 0; i < size; ++i) {
+    diff = buffer[i] - state->prev;
+    state->prev = buffer[i];
+    buffer[i] = diff * SU_C_CONJ(diff);
+  }
+}
+
+#define SPECTSRC_TEST_REF_EXP(n)                                        \
+SUPRIVATE void                                                          \
+JOIN(spectsrc_test_ref_exp_, n)(                                        \
+    struct spectsrc_test_ref_state *state,                              \
+    SUCOMPLEX *buffer,                                                  \
+    SUSCOUNT size)                                                      \
+{                                                                       \
+  SUSCOUNT i;                                                           \
+                                                                        \
+  for (i = 0; i < size; ++i)                                            \
+    buffer[i] = cpow(buffer[i] / (SU_C_ABS(buffer[i]) + 1e-8), n) / size; \
+}
+
+SPECTSRC_TEST_REF_EXP(2)
+SPECTSRC_TEST_REF_EXP(4)
+SPECTSRC_TEST_REF_EXP(8)
+
+SUPRIVATE const struct spectsrc_test_case g_test_cases[] = {
+  {"cyclo",       spectsrc_test_ref_cyclo},
+  {"fmcyclo",     spectsrc_test_ref_fmcyclo},
+  {"fmspect",     spectsrc_test_ref_fmspect},
+  {"pmspect",     spectsrc_test_ref_pmspect},
+  {"timediff",    spectsrc_test_ref_timediff},
+  {"abstimediff", spectsrc_test_ref_abstimediff},
+  {"exp_2",       spectsrc_test_ref_exp_2},
+  {"exp_4",       spectsrc_test_ref_exp_4},
+  {"exp_8",       spectsrc_test_ref_exp_8},
+};
+
+/******************************** Test driver *********************************/
+SUPRIVATE SUFLOAT
+spectsrc_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+SUPRIVATE SUDOUBLE
+spectsrc_test_now(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/* Unit carrier with a random walk phase, plus noise */
+SUPRIVATE SUCOMPLEX *
+spectsrc_test_make_signal(SUSCOUNT count)
+{
+  SUCOMPLEX *x = NULL;
+  SUDOUBLE phase = 0;
+  SUSCOUNT i;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i) {
+    x[i] = SU_C_EXP(I * (SUFLOAT) phase)
+      + TEST_NOISE_STDDEV * (spectsrc_test_randn() + I * spectsrc_test_randn());
+    phase += TEST_PHASE_STEP * (2. * rand() / RAND_MAX - 1);
+    phase = fmod(phase, 2 * M_PI);
+  }
+
+  return x;
+}
+
+SUPRIVATE SUBOOL
+spectsrc_test_run(
+    const struct spectsrc_test_case *test,
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    struct spectsrc_test_result *result)
+{
+  const struct suscan_spectsrc_class *class = NULL;
+  struct spectsrc_test_ref_state state;
+  suscan_spectsrc_t src;
+  void *privdata = NULL;
+  SUCOMPLEX *block = NULL;
+  SUCOMPLEX *ref = NULL;
+  SUFLOAT peak = 0, err;
+  SUDOUBLE start;
+  SUSCOUNT i;
+  SUBOOL ok = SU_FALSE;
+
+  memset(result, 0, sizeof(struct spectsrc_test_result));
+  memset(&state, 0, sizeof(struct spectsrc_test_ref_state));
+  memset(&src, 0, sizeof(suscan_spectsrc_t));
+
+  SU_TRY(class = suscan_spectsrc_class_lookup(test->name));
+  SU_TRY(class->preproc != NULL);
+
+  /* Preprocessors only look at the buffer size of the source */
+  src.classptr    = class;
+  src.buffer_size = TEST_BUFFER_SIZE;
+
+  SU_TRY(privdata = (class->ctor) (&src));
+  src.privdata = privdata;
+
+  SU_ALLOCATE_MANY(block, count, SUCOMPLEX);
+  SU_ALLOCATE_MANY(ref, count, SUCOMPLEX);
+
+  memcpy(block, x, count * sizeof(SUCOMPLEX));
+  memcpy(ref, x, count * sizeof(SUCOMPLEX));
+
+  start = spectsrc_test_now();
+  for (i = 0; i < count; i += TEST_BUFFER_SIZE)
+    SU_TRY((class->preproc) (&src, privdata, block + i, TEST_BUFFER_SIZE));
+  result->block_time = spectsrc_test_now() - start;
+
+  start = spectsrc_test_now();
+  for (i = 0; i < count; i += TEST_BUFFER_SIZE)
+    (test->ref) (&state, ref + i, TEST_BUFFER_SIZE);
+  result->ref_time = spectsrc_test_now() - start;
+
+  for (i = 0; i < count; ++i) {
+    if (SU_C_ABS(ref[i]) > peak)
+      peak = SU_C_ABS(ref[i]);
+
+    err = SU_C_ABS(block[i] - ref[i]);
+    if (err > result->error)
+      result->error = err;
+  }
+
+  if (peak > 0)
+    result->error /= peak;
+
+  ok = SU_TRUE;
+
+done:
+  if (privdata != NULL)
+    (class->dtor) (privdata);
+
+  if (block != NULL)
+    free(block);
+
+  if (ref != NULL)
+    free(ref);
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct spectsrc_test_result result;
+  SUSCOUNT count = TEST_BUFFER_SIZE * TEST_BUFFERS;
+  SUCOMPLEX *x = NULL;
+  unsigned int i;
+  SUBOOL failed = SU_FALSE;
+  int code = EXIT_FAILURE;
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_spectsrcs());
+
+  SU_TRY(x = spectsrc_test_make_signal(count));
+
+  printf("Class         Per-sample       Vector      Speedup  Error\n");
+
+  for (i = 0; i < sizeof(g_test_cases) / sizeof(g_test_cases[0]); ++i) {
+    SU_TRY(spectsrc_test_run(g_test_cases + i, x, count, &result));
+
+    printf(
+      "%-12s  %6.1f Msps  %6.1f Msps  %6.2fx  %g\n",
+      g_test_cases[i].name,
+      1e-6 * count / result.ref_time,
+      1e-6 * count / result.block_time,
+      result.ref_time / result.block_time,
+      result.error);
+
+    if (result.error > TEST_MAX_ERROR) {
+      fprintf(
+        stderr,
+        "%s: vector preprocessor differs from the per-sample loop\n",
+        g_test_cases[i].name);
+      failed = SU_TRUE;
+    }
+  }
+
+  if (!failed)
+    code = EXIT_SUCCESS;
+
+done:
+  if (x != NULL)
+    free(x);
+
+  return code;
+}
@@ -0,0 +1,323 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * Spectral statistics test: synthetic PSDs with a different distribution
+ * per bin (noise of several levels, gated bursts, empty bins) are fed to
+ * the spectral statistics, whose report is checked against brute-force
+ * statistics over the whole history. Max, min and duty cycle must match
+ * exactly and the mean up to rounding. P-square is an estimator, so its
+ * percentile must fall within a small rank tolerance of the requested one.
+ * The first frames, which P-square keeps sorted, must be exact.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <sigutils/sigutils.h>
+
+#include <suscan.h>
+#include <analyzer/spectstats.h>
+#include <analyzer/msg.h>
+
+#define TEST_BINS           6
+#define TEST_FRAMES         20000
+#define TEST_FEW_FRAMES     3         /* Below the P-square marker count */
+#define TEST_THRESHOLD      -3.       /* Occupancy threshold (dB) */
+#define TEST_MAX_RANK_ERROR .02       /* Percentile tolerance */
+#define TEST_MAX_MEAN_ERROR 1e-4      /* Mean tolerance, relative */
+
+SUPRIVATE const SUFLOAT g_test_percentiles[] = {.1, .5, .9};
+
+/* Exponentially distributed, as the PSD of Gaussian noise */
+SUPRIVATE SUFLOAT
+spectstats_test_randexp(SUFLOAT mean)
+{
+  return -mean * log((rand() + 1.) / (RAND_MAX + 2.));
+}
+
+SUPRIVATE SUFLOAT
+spectstats_test_randu(void)
+{
+  return (SUFLOAT) rand() / RAND_MAX;
+}
+
+SUPRIVATE SUFLOAT
+spectstats_test_sample(unsigned int bin, SUSCOUNT frame)
+{
+  switch (bin) {
+    case 0:
+      return 0; /* Empty bin */
+
+    case 1:
+      return spectstats_test_randexp(1e-3);
+
+    case 2:
+      return spectstats_test_randexp(1);
+
+    case 3:
+      /*
+       * Gated carrier: 5% of the frames are empty. Kept below the tested
+       * percentiles, as any estimate between zero and the weakest nonzero
+       * sample would be as good as any other.
+       */
+      return spectstats_test_randu() < .05 ? 0 : spectstats_test_randexp(10);
+
+    case 4:
+      /* Periodic burst over a noise floor */
+      return frame % 10 < 3
+        ? 100 + spectstats_test_randexp(1)
+        : spectstats_test_randexp(1e-2);
+
+    default:
+      return 1e-6 + spectstats_test_randu();
+  }
+}
+
+SUPRIVATE SUFLOAT *
+spectstats_test_make_psds(SUSCOUNT frames)
+{
+  SUFLOAT *psds = NULL;
+  SUSCOUNT i;
+  unsigned int j;
+
+  SU_ALLOCATE_MANY_CATCH(psds, frames * TEST_BINS, SUFLOAT, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < frames; ++i)
+    for (j = 0; j < TEST_BINS; ++j)
+      psds[i * TEST_BINS + j] = spectstats_test_sample(j, i);
+
+  return psds;
+}
+
+SUPRIVATE int
+spectstats_test_cmp(const void *a, const void *b)
+{
+  SUFLOAT x = *(const SUFLOAT *) a;
+  SUFLOAT y = *(const SUFLOAT *) b;
+
+  return (x > y) - (x < y);
+}
+
+/* Checks one bin of a report against the history of that bin */
+SUPRIVATE SUBOOL
+spectstats_test_check_bin(
+    const struct suscan_analyzer_spectral_stats_msg *msg,
+    unsigned int bin,
+    const SUFLOAT *psds,
+    SUSCOUNT frames,
+    SUFLOAT p,
+    SUFLOAT *sorted)
+{
+  SUFLOAT max, min, x, pct;
+  SUDOUBLE sum = 0;
+  SUSCOUNT i, busy = 0, below = 0, below_eq = 0;
+  SUFLOAT threshold = SU_POWER_MAG_RAW(TEST_THRESHOLD);
+  SUBOOL ok = SU_TRUE;
+
+  max = min = psds[bin];
+
+  for (i = 0; i < frames; ++i) {
+    x = psds[i * TEST_BINS + bin];
+    sorted[i] = x;
+
+    if (x > max)
+      max = x;
+    if (x < min)
+      min = x;
+
+    sum += x;
+
+    if (x > threshold)
+      ++busy;
+  }
+
+  if (msg->max[bin] != max || msg->min[bin] != min) {
+    fprintf(
+      stderr,
+      "Bin %u: max/min %g/%g, expected %g/%g\n",
+      bin,
+      msg->max[bin],
+      msg->min[bin],
+      max,
+      min);
+    ok = SU_FALSE;
+  }
+
+  if (SU_ABS(msg->mean[bin] - sum / frames)
+    > TEST_MAX_MEAN_ERROR * sum / frames) {
+    fprintf(
+      stderr,
+      "Bin %u: mean %g, expected %g\n",
+      bin,
+      msg->mean[bin],
+      sum / frames);
+    ok = SU_FALSE;
+  }
+
+  if (msg->duty[bin] != (SUFLOAT) busy / frames) {
+    fprintf(
+      stderr,
+      "Bin %u: duty cycle %g, expected %g\n",
+      bin,
+      msg->duty[bin],
+      (SUFLOAT) busy / frames);
+    ok = SU_FALSE;
+  }
+
+  pct = msg->pct[bin];
+
+  if (!isfinite(pct)) {
+    fprintf(stderr, "Bin %u (p = %g): percentile is %g\n", bin, p, pct);
+    return SU_FALSE;
+  }
+
+  qsort(sorted, frames, sizeof(SUFLOAT), spectstats_test_cmp);
+
+  if (frames < SUSCAN_SPECTSTATS_MARKERS) {
+    /* Sorted history: the estimate is the nearest-rank sample */
+    x = sorted[(SUSCOUNT) SU_FLOOR(p * (frames - 1) + .5)];
+
+    if (SU_ABS(pct - x) > 1e-4 * SU_MAX(x, 1e-20)
+      && !(x == 0 && pct < 1e-10)) {
+      fprintf(
+        stderr,
+        "Bin %u (p = %g, %lu frames): percentile %g, expected %g\n",
+        bin,
+        p,
+        (unsigned long) frames,
+        pct,
+        x);
+      ok = SU_FALSE;
+    }
+
+    return ok;
+  }
+
+  /*
+   * Rank of the estimate in the history. Ties (empty bins) make it an
+   * interval, which must contain the requested percentile.
+   */
+  for (i = 0; i < frames; ++i) {
+    if (sorted[i] < pct)
+      ++below;
+    if (sorted[i] <= pct)
+      ++below_eq;
+  }
+
+  if ((SUFLOAT) below / frames > p + TEST_MAX_RANK_ERROR
+    || (SUFLOAT) below_eq / frames < p - TEST_MAX_RANK_ERROR) {
+    fprintf(
+      stderr,
+      "Bin %u (p = %g): percentile %g has rank %g-%g\n",
+      bin,
+      p,
+      pct,
+      (SUFLOAT) below / frames,
+      (SUFLOAT) below_eq / frames);
+    ok = SU_FALSE;
+  }
+
+  return ok;
+}
+
+SUPRIVATE SUBOOL
+spectstats_test_run(const SUFLOAT *psds, SUSCOUNT frames, SUFLOAT p)
+{
+  struct suscan_spectstats_params params;
+  struct suscan_analyzer_spectral_stats_msg *msg = NULL;
+  suscan_spectstats_t *stats = NULL;
+  struct timeval tv;
+  SUFLOAT *sorted = NULL;
+  SUSCOUNT i;
+  unsigned int j;
+  SUBOOL ok = SU_FALSE;
+
+  params.interval   = 1;
+  params.threshold  = TEST_THRESHOLD;
+  params.percentile = p;
+
+  SU_TRY(stats = suscan_spectstats_new(&params, 0, 1e6, TEST_BINS));
+  SU_TRY(msg = suscan_analyzer_spectral_stats_msg_new(TEST_BINS));
+  SU_ALLOCATE_MANY(sorted, frames, SUFLOAT);
+
+  for (i = 0; i < frames; ++i) {
+    tv.tv_sec  = i / 10;
+    tv.tv_usec = 100000 * (i % 10);
+    suscan_spectstats_feed(stats, psds + i * TEST_BINS, &tv);
+  }
+
+  SU_TRY(suscan_spectstats_get_frames(stats) == frames);
+  SU_TRY(suscan_spectstats_report(stats, msg));
+
+  ok = SU_TRUE;
+
+  for (j = 0; j < TEST_BINS; ++j)
+    if (!spectstats_test_check_bin(msg, j, psds, frames, p, sorted))
+      ok = SU_FALSE;
+
+done:
+  if (sorted != NULL)
+    free(sorted);
+
+  if (msg != NULL)
+    suscan_analyzer_spectral_stats_msg_destroy(msg);
+
+  if (stats != NULL)
+    suscan_spectstats_destroy(stats);
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  SUFLOAT *psds = NULL;
+  unsigned int i;
+  SUBOOL failed = SU_FALSE;
+  int code = EXIT_FAILURE;
+
+  SU_TRY(psds = spectstats_test_make_psds(TEST_FRAMES));
+
+  for (i = 0; i < sizeof(g_test_percentiles) / sizeof(SUFLOAT); ++i) {
+    if (!spectstats_test_run(psds, TEST_FEW_FRAMES, g_test_percentiles[i]))
+      failed = SU_TRUE;
+
+    if (!spectstats_test_run(psds, TEST_FRAMES, g_test_percentiles[i]))
+      failed = SU_TRUE;
+
+    printf(
+      "p = %g: %s\n",
+      g_test_percentiles[i],
+      failed ? "FAILED" : "ok");
+  }
+
+  if (!failed)
+    code = EXIT_SUCCESS;
+
+done:
+  if (psds != NULL)
+    free(psds);
+
+  return code;
+}
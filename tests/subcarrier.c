@@ -0,0 +1,410 @@
+/*
+
+  Copyright (C) 2024 Gonzalo José Carracedo Carballal
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU Lesser General Public License as
+  published by the Free Software Foundation, version 3.
+
+  This program is distributed in the hope that it will be useful, but
+  WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU Lesser General Public License for more details.
+
+  You should have received a copy of the GNU Lesser General Public
+  License along with this program.  If not, see
+  <http://www.gnu.org/licenses/>
+
+*/
+
+/*
+ * Subcarrier inspector benchmark: a multicarrier inspector feeds 64 FM
+ * audio subcarrier inspectors. They run once in batched mode, inline in
+ * the thread that feeds the parent, and once on a threaded scheduler that
+ * synchronizes with its workers after every tuner window. Both runs must
+ * produce the same audio, and their CPU and wall times are compared. The
+ * parent is opened from a minimal root factory, which only provides the
+ * message queues and the clock that subcarrier inspectors ask for.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/time.h>
+
+#include <suscan.h>
+#include <analyzer/analyzer.h>
+#include <analyzer/mq.h>
+#include <analyzer/msg.h>
+#include <analyzer/inspsched.h>
+#include <analyzer/inspector/inspector.h>
+#include <analyzer/inspector/factory.h>
+#include <analyzer/inspector/params.h>
+
+#define TEST_SAMP_RATE    2000000.  /* Parent channel rate (Hz) */
+#define TEST_BANDWIDTH    1.        /* Normalized parent bandwidth */
+#define TEST_DURATION     2.        /* Seconds */
+#define TEST_SUBCARRIERS  64
+#define TEST_SC_SPACING   (TEST_SAMP_RATE / TEST_SUBCARRIERS)
+#define TEST_SC_BANDWIDTH 20000.    /* Subcarrier bandwidth (Hz) */
+#define TEST_AUDIO_RATE   8000      /* Subcarrier audio rate (Hz) */
+#define TEST_CUTOFF       3000.     /* Subcarrier audio cutoff (Hz) */
+#define TEST_NOISE_STDDEV .1        /* Per component */
+#define TEST_BLOCK_SIZE   4096
+
+struct sc_test_result {
+  SUSCOUNT samples;
+  SUSCOUNT batches;
+  SUDOUBLE cpu_time;
+  SUDOUBLE wall_time;
+};
+
+SUPRIVATE SUFLOAT
+sc_test_randn(void)
+{
+  SUFLOAT u1 = (rand() + 1.) / (RAND_MAX + 2.);
+  SUFLOAT u2 = (rand() + 1.) / (RAND_MAX + 2.);
+
+  return SU_SQRT(-2 * log(u1)) * SU_COS(2 * M_PI * u2);
+}
+
+/* One unmodulated carrier at the center of every subcarrier, plus noise */
+SUPRIVATE SUCOMPLEX *
+sc_test_make_signal(SUSCOUNT count)
+{
+  SUCOMPLEX *x = NULL;
+  SUDOUBLE f, phase;
+  SUSCOUNT i;
+  unsigned int j;
+
+  SU_ALLOCATE_MANY_CATCH(x, count, SUCOMPLEX, return NULL);
+
+  srand(0);
+
+  for (i = 0; i < count; ++i)
+    x[i] = TEST_NOISE_STDDEV * (sc_test_randn() + I * sc_test_randn());
+
+  for (j = 0; j < TEST_SUBCARRIERS; ++j) {
+    f = -.5 * TEST_SAMP_RATE + (j + .5) * TEST_SC_SPACING;
+    for (i = 0; i < count; ++i) {
+      phase = fmod(2 * M_PI * f * i / TEST_SAMP_RATE, 2 * M_PI);
+      x[i] += SU_C_EXP(I * (SUFLOAT) phase) / TEST_SUBCARRIERS;
+    }
+  }
+
+  return x;
+}
+
+SUPRIVATE SUDOUBLE
+sc_test_clock(clockid_t clk)
+{
+  struct timespec ts;
+
+  clock_gettime(clk, &ts);
+
+  return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+/**************************** Root inspector factory *************************/
+SUPRIVATE void *
+sc_test_root_ctor(suscan_inspector_factory_t *parent, va_list ap)
+{
+  struct suscan_mq *mq = va_arg(ap, struct suscan_mq *);
+
+  suscan_inspector_factory_set_mq_out(parent, mq);
+  suscan_inspector_factory_set_mq_ctl(parent, mq);
+
+  return parent;
+}
+
+SUPRIVATE void
+sc_test_root_get_time(void *userdata, struct timeval *tv)
+{
+  gettimeofday(tv, NULL);
+}
+
+SUPRIVATE void *
+sc_test_root_open(
+  void *userdata,
+  const char **inspclass,
+  struct suscan_inspector_sampling_info *samp_info,
+  va_list ap)
+{
+  *inspclass = va_arg(ap, const char *);
+  *samp_info = *va_arg(ap, const struct suscan_inspector_sampling_info *);
+
+  return userdata;
+}
+
+SUPRIVATE void
+sc_test_root_bind(void *userdata, void *insp_userdata, suscan_inspector_t *insp)
+{
+}
+
+SUPRIVATE void
+sc_test_root_close(void *userdata, void *insp_userdata)
+{
+}
+
+SUPRIVATE void
+sc_test_root_free_buf(
+  void *userdata,
+  void *insp_userdata,
+  SUCOMPLEX *data,
+  SUSCOUNT size)
+{
+}
+
+SUPRIVATE SUBOOL
+sc_test_root_set_float(void *userdata, void *insp_userdata, SUFLOAT value)
+{
+  return SU_TRUE;
+}
+
+SUPRIVATE SUFLOAT
+sc_test_root_get_bandwidth(void *userdata, void *insp_userdata)
+{
+  return TEST_SAMP_RATE;
+}
+
+SUPRIVATE SUBOOL
+sc_test_root_set_frequency(void *userdata, void *insp_userdata, SUFREQ freq)
+{
+  return SU_TRUE;
+}
+
+SUPRIVATE SUBOOL
+sc_test_root_set_domain(void *userdata, void *insp_userdata, SUBOOL freq)
+{
+  return SU_TRUE;
+}
+
+SUPRIVATE SUFREQ
+sc_test_root_get_abs_freq(void *userdata, void *insp_userdata)
+{
+  return 0;
+}
+
+SUPRIVATE void
+sc_test_root_dtor(void *userdata)
+{
+}
+
+static struct suscan_inspector_factory_class g_sc_test_root = {
+  .name                = "sc-test-root",
+  .ctor                = sc_test_root_ctor,
+  .get_time            = sc_test_root_get_time,
+  .open                = sc_test_root_open,
+  .bind                = sc_test_root_bind,
+  .close               = sc_test_root_close,
+  .free_buf            = sc_test_root_free_buf,
+  .set_bandwidth       = sc_test_root_set_float,
+  .get_bandwidth       = sc_test_root_get_bandwidth,
+  .set_frequency       = sc_test_root_set_frequency,
+  .set_domain          = sc_test_root_set_domain,
+  .get_abs_freq        = sc_test_root_get_abs_freq,
+  .set_freq_correction = sc_test_root_set_float,
+  .dtor                = sc_test_root_dtor
+};
+
+/******************************** Benchmark **********************************/
+SUPRIVATE SUBOOL
+sc_test_open_subcarrier(suscan_inspector_t *parent, unsigned int index)
+{
+  struct sigutils_channel channel;
+  suscan_inspector_t *insp = NULL;
+  suscan_config_t *config = NULL;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&channel, 0, sizeof(struct sigutils_channel));
+
+  channel.fc   = -.5 * TEST_SAMP_RATE + (index + .5) * TEST_SC_SPACING;
+  channel.f_lo = channel.fc - .5 * TEST_SC_BANDWIDTH;
+  channel.f_hi = channel.fc + .5 * TEST_SC_BANDWIDTH;
+  channel.bw   = TEST_SC_BANDWIDTH;
+
+  SU_TRY(
+      insp = suscan_inspector_factory_open(
+        suscan_inspector_get_subcarrier_factory(parent),
+        "audio",
+        &channel,
+        SU_FALSE));
+
+  SU_TRY(config = suscan_inspector_create_config(insp));
+  SU_TRY(suscan_inspector_get_config(insp, config));
+  SU_TRY(suscan_config_set_bool(config, "agc.enabled", SU_FALSE));
+  SU_TRY(suscan_config_set_float(config, "audio.cutoff", TEST_CUTOFF));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "audio.sample-rate",
+        TEST_AUDIO_RATE));
+  SU_TRY(
+      suscan_config_set_integer(
+        config,
+        "audio.demodulator",
+        SUSCAN_INSPECTOR_AUDIO_DEMOD_FM));
+  SU_TRY(suscan_inspector_set_config(insp, config));
+
+  ok = SU_TRUE;
+
+done:
+  if (config != NULL)
+    suscan_config_destroy(config);
+
+  return ok;
+}
+
+SUPRIVATE void
+sc_test_drain(struct suscan_mq *mq, struct sc_test_result *result)
+{
+  struct suscan_analyzer_sample_batch_msg *batch;
+  uint32_t type;
+  void *ptr;
+
+  while (suscan_mq_poll(mq, &type, &ptr)) {
+    if (type == SUSCAN_ANALYZER_MESSAGE_TYPE_SAMPLES) {
+      batch = (struct suscan_analyzer_sample_batch_msg *) ptr;
+      result->samples += batch->sample_count;
+      ++result->batches;
+    }
+
+    suscan_analyzer_dispose_message(type, ptr);
+  }
+}
+
+SUPRIVATE SUBOOL
+sc_test_run(
+    const SUCOMPLEX *x,
+    SUSCOUNT count,
+    SUBOOL batched,
+    struct sc_test_result *result)
+{
+  struct suscan_inspector_sampling_info sinfo;
+  struct suscan_mq mq;
+  SUBOOL mq_init = SU_FALSE;
+  suscan_inspector_factory_t *root = NULL;
+  suscan_inspector_t *parent = NULL;
+  suscan_inspector_factory_t *factory;
+  SUSCOUNT i = 0, len;
+  SUSDIFF got;
+  SUDOUBLE cpu_start, wall_start;
+  unsigned int j;
+  SUBOOL ok = SU_FALSE;
+
+  memset(&sinfo, 0, sizeof(struct suscan_inspector_sampling_info));
+  memset(result, 0, sizeof(struct sc_test_result));
+
+  sinfo.equiv_fs   = TEST_SAMP_RATE;
+  sinfo.bw         = TEST_BANDWIDTH;
+  sinfo.bw_bd      = TEST_BANDWIDTH;
+  sinfo.decimation = 1;
+
+  SU_TRY(suscan_mq_init(&mq));
+  mq_init = SU_TRUE;
+
+  SU_TRY(root = suscan_inspector_factory_new("sc-test-root", &mq));
+  SU_TRY(
+      parent = suscan_inspector_factory_open(
+        root,
+        "multicarrier",
+        &sinfo));
+
+  SU_TRY(factory = suscan_inspector_get_subcarrier_factory(parent));
+
+  /*
+   * The subcarrier factory class is batched. For the reference run, its
+   * scheduler is replaced by a threaded one before any task is queued.
+   */
+  if (!batched) {
+    SU_TRY(suscan_inspsched_destroy(factory->sched));
+    factory->sched = NULL;
+    SU_TRY(factory->sched = suscan_inspsched_new(&mq));
+  }
+
+  for (j = 0; j < TEST_SUBCARRIERS; ++j)
+    SU_TRY(sc_test_open_subcarrier(parent, j));
+
+  cpu_start  = sc_test_clock(CLOCK_PROCESS_CPUTIME_ID);
+  wall_start = sc_test_clock(CLOCK_MONOTONIC);
+
+  while (i < count) {
+    len = SU_MIN(TEST_BLOCK_SIZE, count - i);
+    SU_TRY((got = suscan_inspector_feed_bulk(parent, x + i, len)) > 0);
+    sc_test_drain(&mq, result);
+    i += got;
+  }
+
+  result->cpu_time  = sc_test_clock(CLOCK_PROCESS_CPUTIME_ID) - cpu_start;
+  result->wall_time = sc_test_clock(CLOCK_MONOTONIC) - wall_start;
+
+  ok = SU_TRUE;
+
+done:
+  /* Owns the parent, which owns the subcarrier factory */
+  if (root != NULL)
+    suscan_inspector_factory_destroy(root);
+
+  if (mq_init) {
+    sc_test_drain(&mq, result);
+    suscan_mq_finalize(&mq);
+  }
+
+  return ok;
+}
+
+int
+main(int argc, char **argv)
+{
+  struct sc_test_result batched, threaded;
+  SUSCOUNT count = TEST_DURATION * TEST_SAMP_RATE;
+  SUCOMPLEX *x = NULL;
+  int code = EXIT_FAILURE;
+
+  SU_TRY(suscan_sigutils_init(SUSCAN_MODE_IMMEDIATE));
+  SU_TRY(suscan_init_estimators());
+  SU_TRY(suscan_init_spectsrcs());
+  SU_TRY(suscan_init_inspectors());
+  SU_TRY(suscan_inspector_factory_class_register(&g_sc_test_root));
+
+  SU_TRY(x = sc_test_make_signal(count));
+
+  SU_TRY(sc_test_run(x, count, SU_FALSE, &threaded));
+  SU_TRY(sc_test_run(x, count, SU_TRUE, &batched));
+
+  printf(
+    "Scheduler  Subcarriers  Batches  Samples   CPU time  Wall time\n");
+  printf(
+    "threaded   %11u  %7lu  %8lu  %7.3f s  %7.3f s\n",
+    TEST_SUBCARRIERS,
+    (unsigned long) threaded.batches,
+    (unsigned long) threaded.samples,
+    threaded.cpu_time,
+    threaded.wall_time);
+  printf(
+    "batched    %11u  %7lu  %8lu  %7.3f s  %7.3f s\n",
+    TEST_SUBCARRIERS,
+    (unsigned long) batched.batches,
+    (unsigned long) batched.samples,
+    batched.cpu_time,
+    batched.wall_time);
+  printf(
+    "Speedup: %.2fx (CPU), %.2fx (wall)\n",
+    threaded.cpu_time / batched.cpu_time,
+    threaded.wall_time / batched.wall_time);
+
+  if (batched.samples == 0 || batched.samples != threaded.samples) {
+    fprintf(stderr, "Batched and threaded runs yield different audio\n");
+    goto done;
+  }
+
+  code = EXIT_SUCCESS;
+
+done:
+  if (x != NULL)
+    free(x);
+
+  return code;
+}